@@ -10,6 +10,13 @@ $sources = @(
     "$SRC_DIR/itch_parser.cpp",
     "$SRC_DIR/order_book.cpp",
     "$SRC_DIR/enhanced_order_book.cpp",
+    "$SRC_DIR/itch_book_builder.cpp",
+    "$SRC_DIR/sharded_book_engine.cpp",
+    "$SRC_DIR/book_checkpoint.cpp",
+    "$SRC_DIR/book_snapshot.cpp",
+    "$SRC_DIR/nbbo_engine.cpp",
+    "$SRC_DIR/market_event.cpp",
+    "$SRC_DIR/memory_provider.cpp",
     "$SRC_DIR/websocket_server.cpp",
     "$SRC_DIR/tick_recorder.cpp",
     "$SRC_DIR/replay_engine.cpp",
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+import sys
+import re
+
+def load_symbols(path):
+    symbols = []
+    with open(path) as f:
+        for line in f:
+            symbol = line.strip().split(',')[0].strip().upper()
+            if symbol and not symbol.startswith('#'):
+                symbols.append(symbol)
+    return symbols
+
+def emit_header(name, symbols):
+    ident = re.sub(r'[^A-Za-z0-9_]', '_', name).upper()
+    lines = [
+        '#pragma once',
+        '',
+        '#include "static_symbol_table.hpp"',
+        '',
+        f'inline constexpr std::array<SymbolId, {len(symbols)}> {ident}_SYMBOLS = symbol_universe(',
+    ]
+    for i, symbol in enumerate(symbols):
+        sep = ',' if i + 1 < len(symbols) else ''
+        lines.append(f'    "{symbol}"{sep}')
+    lines.append(');')
+    lines.append('')
+    lines.append(f'inline constexpr StaticSymbolTable<{len(symbols)}> {ident}_TABLE({ident}_SYMBOLS);')
+    return '\n'.join(lines) + '\n'
+
+def main():
+    if len(sys.argv) != 4:
+        print("Usage: generate_symbol_universe.py <symbols.txt> <name> <output.hpp>")
+        sys.exit(1)
+    
+    symbols = load_symbols(sys.argv[1])
+    
+    if len(set(symbols)) != len(symbols):
+        print("Error: duplicate symbols in universe")
+        sys.exit(1)
+    
+    for symbol in symbols:
+        if len(symbol) > 8:
+            print(f"Error: symbol {symbol} longer than 8 characters")
+            sys.exit(1)
+    
+    with open(sys.argv[3], 'w') as f:
+        f.write(emit_header(sys.argv[2], symbols))
+    
+    print(f"Generated universe {sys.argv[2]} with {len(symbols)} symbols")
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct AllocCounts {
+    uint64_t allocations;
+    uint64_t deallocations;
+    uint64_t bytes;
+};
+
+// Per-thread heap accounting for the ENABLE_ALLOC_TRACKING build. When the
+// alloc_tracker object library is linked in, it replaces global operator
+// new/delete (and malloc/free on glibc) with counting wrappers; otherwise
+// active() is false and every count stays zero.
+class AllocTracker {
+public:
+    static constexpr size_t MAX_STACKS = 16;
+    static constexpr size_t MAX_FRAMES = 24;
+    
+    static bool active();
+    static AllocCounts counts();
+    
+    // Records the call stack of the next MAX_STACKS allocations on this thread.
+    static void capture_stacks(bool enabled);
+    static size_t captured_stacks();
+    static void dump_stacks(int fd);
+};
+
+// Marks a region on the calling thread and reports the allocations made
+// inside it, e.g. EXPECT_EQ(region.allocations(), 0u) around a steady-state
+// loop. With capture set, the offending stacks can be dumped on failure.
+class AllocRegion {
+    AllocCounts start_;
+    bool capture_;
+    
+public:
+    explicit AllocRegion(bool capture = false) : start_(AllocTracker::counts()), capture_(capture) {
+        if (capture_) {
+            AllocTracker::capture_stacks(true);
+        }
+    }
+    
+    ~AllocRegion() {
+        if (capture_) {
+            AllocTracker::capture_stacks(false);
+        }
+    }
+    
+    AllocRegion(const AllocRegion&) = delete;
+    AllocRegion& operator=(const AllocRegion&) = delete;
+    
+    uint64_t allocations() const { return AllocTracker::counts().allocations - start_.allocations; }
+    uint64_t deallocations() const { return AllocTracker::counts().deallocations - start_.deallocations; }
+    uint64_t bytes() const { return AllocTracker::counts().bytes - start_.bytes; }
+};
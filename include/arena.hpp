@@ -0,0 +1,171 @@
+#pragma once
+
+#include "memory_provider.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#define aligned_alloc_compat(align, size) _aligned_malloc(size, align)
+#define aligned_free_compat(ptr) _aligned_free(ptr)
+#else
+#define aligned_alloc_compat(align, size) aligned_alloc(align, size)
+#define aligned_free_compat(ptr) free(ptr)
+#endif
+
+// Bump-pointer arena for per-packet and per-batch scratch data. Nothing is
+// freed individually; rewinding to a mark releases everything allocated since
+// in one step. Blocks are kept across rewinds, so once the arena has seen its
+// largest batch it never touches the heap again. Not thread-safe.
+class Arena {
+    struct Block {
+        uint8_t* data;
+        size_t size;
+    };
+    
+    static constexpr size_t BLOCK_ALIGN = 64;
+    
+    MemoryProvider* provider_;
+    size_t block_size_;
+    std::vector<Block> blocks_;
+    size_t current_;
+    uint8_t* cursor_;
+    uint8_t* limit_;
+    
+    static uintptr_t align_up(uintptr_t value, size_t alignment) {
+        return (value + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    }
+    
+    void* allocate_slow(size_t bytes, size_t alignment) {
+        for (size_t i = blocks_.empty() ? 0 : current_ + 1; i < blocks_.size(); ++i) {
+            uintptr_t aligned = align_up(reinterpret_cast<uintptr_t>(blocks_[i].data), alignment);
+            if (aligned + bytes <= reinterpret_cast<uintptr_t>(blocks_[i].data + blocks_[i].size)) {
+                current_ = i;
+                limit_ = blocks_[i].data + blocks_[i].size;
+                cursor_ = reinterpret_cast<uint8_t*>(aligned + bytes);
+                return reinterpret_cast<void*>(aligned);
+            }
+        }
+        
+        size_t size = align_up(std::max(block_size_, bytes + alignment), BLOCK_ALIGN);
+        void* data = provider_ ? provider_->allocate(size, BLOCK_ALIGN) : aligned_alloc_compat(BLOCK_ALIGN, size);
+        if (!data) {
+            throw std::bad_alloc();
+        }
+        
+        blocks_.push_back(Block{static_cast<uint8_t*>(data), size});
+        current_ = blocks_.size() - 1;
+        limit_ = blocks_.back().data + size;
+        uintptr_t aligned = align_up(reinterpret_cast<uintptr_t>(data), alignment);
+        cursor_ = reinterpret_cast<uint8_t*>(aligned + bytes);
+        return reinterpret_cast<void*>(aligned);
+    }
+    
+public:
+    struct Marker {
+        size_t block;
+        uint8_t* cursor;
+    };
+    
+    // Blocks come from the provider when one is given; it must outlive the arena.
+    explicit Arena(size_t block_size = 64 * 1024, MemoryProvider* provider = nullptr)
+        : provider_(provider), block_size_(block_size), current_(0), cursor_(nullptr), limit_(nullptr) {}
+    
+    ~Arena() {
+        if (provider_) return;
+        for (const Block& block : blocks_) {
+            aligned_free_compat(block.data);
+        }
+    }
+    
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        uintptr_t aligned = align_up(reinterpret_cast<uintptr_t>(cursor_), alignment);
+        if (cursor_ && aligned + bytes <= reinterpret_cast<uintptr_t>(limit_)) {
+            cursor_ = reinterpret_cast<uint8_t*>(aligned + bytes);
+            return reinterpret_cast<void*>(aligned);
+        }
+        return allocate_slow(bytes, alignment);
+    }
+    
+    template<typename T>
+    T* allocate_array(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+    
+    Marker mark() const { return Marker{current_, cursor_}; }
+    
+    void rewind(Marker marker) {
+        if (blocks_.empty()) return;
+        
+        current_ = marker.block;
+        cursor_ = marker.cursor ? marker.cursor : blocks_[0].data;
+        limit_ = blocks_[current_].data + blocks_[current_].size;
+    }
+    
+    void reset() { rewind(Marker{0, nullptr}); }
+    
+    size_t block_count() const { return blocks_.size(); }
+    
+    size_t capacity() const {
+        size_t total = 0;
+        for (const Block& block : blocks_) {
+            total += block.size;
+        }
+        return total;
+    }
+};
+
+// Rewinds the arena to where it stood at construction.
+class ArenaScope {
+    Arena& arena_;
+    Arena::Marker marker_;
+    
+public:
+    explicit ArenaScope(Arena& arena) : arena_(arena), marker_(arena.mark()) {}
+    ~ArenaScope() { arena_.rewind(marker_); }
+    
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+};
+
+// Standard allocator over an Arena. deallocate() is a no-op; memory comes
+// back when the owning scope rewinds, so a container must not outlive it.
+template<typename T>
+class ArenaAllocator {
+    template<typename U>
+    friend class ArenaAllocator;
+    
+    Arena* arena_;
+    
+public:
+    using value_type = T;
+    
+    explicit ArenaAllocator(Arena& arena) : arena_(&arena) {}
+    
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) {}
+    
+    T* allocate(size_t n) { return arena_->allocate_array<T>(n); }
+    void deallocate(T*, size_t) {}
+    
+    Arena& arena() const { return *arena_; }
+    
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena_ == other.arena_; }
+    
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena_ != other.arena_; }
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
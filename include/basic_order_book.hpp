@@ -0,0 +1,671 @@
+#pragma once
+
+#include "order_book.hpp"
+#include "depth_levels.hpp"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+enum class Side : uint8_t { Bid = 0, Ask = 1 };
+
+template<Side S>
+struct SideTraits;
+
+template<>
+struct SideTraits<Side::Bid> {
+    using Compare = std::greater<int64_t>;
+    static constexpr char code = 'B';
+    static constexpr int64_t worst = std::numeric_limits<int64_t>::min();
+    static bool better(int64_t a, int64_t b) { return a > b; }
+};
+
+template<>
+struct SideTraits<Side::Ask> {
+    using Compare = std::less<int64_t>;
+    static constexpr char code = 'S';
+    static constexpr int64_t worst = std::numeric_limits<int64_t>::max();
+    static bool better(int64_t a, int64_t b) { return a < b; }
+};
+
+// Level store policies. Each provides Store<Side> with find, insert (find or
+// create; nullptr if the price cannot be held), erase of an emptied level,
+// best, size, clear, and a best-first for_each. Pointers are only valid
+// until the next insert or erase.
+
+// Pooled stores draw their nodes from a PoolResource they own.
+template<bool Pooled>
+struct BasicTreeLevels {
+    template<Side S>
+    class Store {
+        PoolResource pool_;
+        LevelMap<typename SideTraits<S>::Compare> levels_;
+    
+    public:
+        Store() : levels_(LevelAllocator(Pooled ? &pool_ : nullptr)) {}
+        
+        PriceLevel* find(int64_t price) {
+            auto it = levels_.find(price);
+            return it == levels_.end() ? nullptr : &it->second;
+        }
+        
+        PriceLevel* insert(int64_t price) {
+            PriceLevel& level = levels_[price];
+            level.price = price;
+            return &level;
+        }
+        
+        void erase(int64_t price) { levels_.erase(price); }
+        
+        const PriceLevel* best() const { return levels_.empty() ? nullptr : &levels_.begin()->second; }
+        size_t size() const { return levels_.size(); }
+        void clear() { levels_.clear(); }
+        
+        template<typename Visitor>
+        void for_each(Visitor&& visit, size_t max_levels = SIZE_MAX) const {
+            for (auto it = levels_.begin(); it != levels_.end() && max_levels > 0; ++it, --max_levels) {
+                visit(it->second);
+            }
+        }
+    };
+};
+
+using TreeLevels = BasicTreeLevels<false>;
+using PooledTreeLevels = BasicTreeLevels<true>;
+
+// Sorted worst to best so that churn at the touch shifts only the tail.
+struct SortedVectorLevels {
+    template<Side S>
+    class Store {
+        std::vector<PriceLevel> levels_;
+        
+        typename std::vector<PriceLevel>::iterator position(int64_t price) {
+            return std::lower_bound(levels_.begin(), levels_.end(), price,
+                                    [](const PriceLevel& level, int64_t p) { return SideTraits<S>::better(p, level.price); });
+        }
+    
+    public:
+        PriceLevel* find(int64_t price) {
+            auto it = position(price);
+            return (it != levels_.end() && it->price == price) ? &*it : nullptr;
+        }
+        
+        PriceLevel* insert(int64_t price) {
+            auto it = position(price);
+            if (it == levels_.end() || it->price != price) {
+                it = levels_.insert(it, PriceLevel());
+                it->price = price;
+            }
+            return &*it;
+        }
+        
+        void erase(int64_t price) {
+            auto it = position(price);
+            if (it != levels_.end() && it->price == price) {
+                levels_.erase(it);
+            }
+        }
+        
+        const PriceLevel* best() const { return levels_.empty() ? nullptr : &levels_.back(); }
+        size_t size() const { return levels_.size(); }
+        void clear() { levels_.clear(); }
+        
+        template<typename Visitor>
+        void for_each(Visitor&& visit, size_t max_levels = SIZE_MAX) const {
+            for (auto it = levels_.rbegin(); it != levels_.rend() && max_levels > 0; ++it, --max_levels) {
+                visit(*it);
+            }
+        }
+    };
+};
+
+// Dense price ladder indexed by tick offset from a base price. Lookups are a
+// subtraction and a divide by a constant; the ladder re-centres when a price lands
+// outside it and refuses prices off the tick grid or beyond MaxTicks.
+template<int64_t Tick = 100, size_t MaxTicks = (1u << 16)>
+struct DenseLadderLevels {
+    static_assert(Tick > 0, "tick must be positive");
+    
+    template<Side S>
+    class Store {
+        std::vector<PriceLevel> ladder_;
+        int64_t base_;
+        size_t best_;
+        size_t count_;
+        
+        static constexpr size_t NONE = SIZE_MAX;
+        
+        bool slot(int64_t price, size_t& index) const {
+            if (ladder_.empty() || price < base_ || (price - base_) % Tick != 0) return false;
+            index = static_cast<size_t>((price - base_) / Tick);
+            return index < ladder_.size();
+        }
+        
+        bool regrow(int64_t price) {
+            if (price % Tick != 0) return false;
+            
+            int64_t low = price;
+            int64_t high = price;
+            for (const PriceLevel& level : ladder_) {
+                if (level.size > 0) {
+                    low = std::min(low, level.price);
+                    high = std::max(high, level.price);
+                }
+            }
+            
+            size_t span = static_cast<size_t>((high - low) / Tick) + 1;
+            if (span > MaxTicks) return false;
+            
+            // Leave headroom on both sides so a drifting market rarely re-centres.
+            size_t size = std::min(MaxTicks, std::max(span * 2, size_t(64)));
+            int64_t slack = static_cast<int64_t>(size - span) / 2;
+            int64_t new_base = std::max(int64_t(0), low - slack * Tick);
+            
+            std::vector<PriceLevel> ladder(size);
+            for (size_t i = 0; i < ladder_.size(); ++i) {
+                if (ladder_[i].size > 0) {
+                    ladder[static_cast<size_t>((ladder_[i].price - new_base) / Tick)] = ladder_[i];
+                }
+            }
+            if (best_ != NONE) {
+                best_ = static_cast<size_t>((ladder_[best_].price - new_base) / Tick);
+            }
+            ladder_.swap(ladder);
+            base_ = new_base;
+            return true;
+        }
+        
+        void step_best() {
+            if (count_ == 0) {
+                best_ = NONE;
+                return;
+            }
+            if (S == Side::Bid) {
+                while (ladder_[best_].size == 0) --best_;
+            } else {
+                while (ladder_[best_].size == 0) ++best_;
+            }
+        }
+    
+    public:
+        Store() : base_(0), best_(NONE), count_(0) {}
+        
+        PriceLevel* find(int64_t price) {
+            size_t index;
+            if (!slot(price, index) || ladder_[index].size == 0) return nullptr;
+            return &ladder_[index];
+        }
+        
+        PriceLevel* insert(int64_t price) {
+            size_t index;
+            if (!slot(price, index)) {
+                if (!regrow(price) || !slot(price, index)) return nullptr;
+            }
+            
+            PriceLevel& level = ladder_[index];
+            if (level.size == 0) {
+                level.price = price;
+                count_++;
+                if (best_ == NONE || SideTraits<S>::better(price, ladder_[best_].price)) {
+                    best_ = index;
+                }
+            }
+            return &level;
+        }
+        
+        // The book only erases a level once its size reaches zero.
+        void erase(int64_t price) {
+            size_t index;
+            if (!slot(price, index)) return;
+            ladder_[index] = PriceLevel();
+            count_--;
+            if (index == best_) {
+                step_best();
+            }
+        }
+        
+        const PriceLevel* best() const { return best_ == NONE ? nullptr : &ladder_[best_]; }
+        size_t size() const { return count_; }
+        
+        void clear() {
+            ladder_.clear();
+            base_ = 0;
+            best_ = NONE;
+            count_ = 0;
+        }
+        
+        template<typename Visitor>
+        void for_each(Visitor&& visit, size_t max_levels = SIZE_MAX) const {
+            size_t remaining = std::min(count_, max_levels);
+            for (size_t i = best_; remaining > 0; i = (S == Side::Bid) ? i - 1 : i + 1) {
+                if (ladder_[i].size > 0) {
+                    visit(ladder_[i]);
+                    remaining--;
+                }
+            }
+        }
+    };
+};
+
+// Small inline array sorted best-first, so the touch is always index 0. A
+// separate price array padded with the side's worst price lets the search
+// count better levels four (AVX2) or two (SSE4.2) at a time without a
+// bounds check. Inserts and erases memmove the tail. Past N levels the side
+// is promoted into Overflow, and demoted again once it falls to N / 2.
+template<size_t N = 16, typename Overflow = TreeLevels>
+struct InlineLevels {
+    static_assert(N >= 4 && N % 4 == 0, "inline capacity must be a multiple of four");
+    
+    template<Side S>
+    class Store {
+        using OverflowStore = typename Overflow::template Store<S>;
+        
+        alignas(64) int64_t prices_[N];
+        PriceLevel levels_[N];
+        size_t count_;
+        std::unique_ptr<OverflowStore> overflow_;
+        
+        size_t position(int64_t price) const {
+#if defined(__AVX2__)
+            static const uint8_t bits[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+            __m256i target = _mm256_set1_epi64x(price);
+            size_t better = 0;
+            for (size_t i = 0; i < count_; i += 4) {
+                __m256i lane = _mm256_load_si256(reinterpret_cast<const __m256i*>(prices_ + i));
+                __m256i mask = S == Side::Bid ? _mm256_cmpgt_epi64(lane, target) : _mm256_cmpgt_epi64(target, lane);
+                better += bits[_mm256_movemask_pd(_mm256_castsi256_pd(mask))];
+            }
+            return better;
+#elif defined(__SSE4_2__)
+            static const uint8_t bits[4] = {0, 1, 1, 2};
+            __m128i target = _mm_set1_epi64x(price);
+            size_t better = 0;
+            for (size_t i = 0; i < count_; i += 2) {
+                __m128i lane = _mm_load_si128(reinterpret_cast<const __m128i*>(prices_ + i));
+                __m128i mask = S == Side::Bid ? _mm_cmpgt_epi64(lane, target) : _mm_cmpgt_epi64(target, lane);
+                better += bits[_mm_movemask_pd(_mm_castsi128_pd(mask))];
+            }
+            return better;
+#else
+            size_t i = 0;
+            while (i < count_ && SideTraits<S>::better(prices_[i], price)) ++i;
+            return i;
+#endif
+        }
+        
+        // Fails, leaving the inline levels untouched, if the overflow store
+        // refuses any of them (e.g. a ladder rejecting an off-grid price).
+        bool promote() {
+            std::unique_ptr<OverflowStore> overflow(new OverflowStore());
+            for (size_t i = 0; i < count_; ++i) {
+                PriceLevel* level = overflow->insert(levels_[i].price);
+                if (!level) return false;
+                *level = levels_[i];
+            }
+            overflow_ = std::move(overflow);
+            count_ = 0;
+            std::fill(prices_, prices_ + N, SideTraits<S>::worst);
+            return true;
+        }
+        
+        void demote() {
+            count_ = 0;
+            overflow_->for_each([this](const PriceLevel& level) {
+                prices_[count_] = level.price;
+                levels_[count_++] = level;
+            });
+            overflow_.reset();
+        }
+    
+    public:
+        Store() : count_(0) {
+            std::fill(prices_, prices_ + N, SideTraits<S>::worst);
+        }
+        
+        PriceLevel* find(int64_t price) {
+            if (overflow_) return overflow_->find(price);
+            
+            size_t i = position(price);
+            return (i < count_ && prices_[i] == price) ? &levels_[i] : nullptr;
+        }
+        
+        PriceLevel* insert(int64_t price) {
+            if (overflow_) return overflow_->insert(price);
+            
+            size_t i = position(price);
+            if (i < count_ && prices_[i] == price) return &levels_[i];
+            
+            if (count_ == N) {
+                if (!promote()) return nullptr;
+                return overflow_->insert(price);
+            }
+            
+            std::memmove(prices_ + i + 1, prices_ + i, (count_ - i) * sizeof(int64_t));
+            std::memmove(levels_ + i + 1, levels_ + i, (count_ - i) * sizeof(PriceLevel));
+            prices_[i] = price;
+            levels_[i] = PriceLevel();
+            levels_[i].price = price;
+            count_++;
+            return &levels_[i];
+        }
+        
+        void erase(int64_t price) {
+            if (overflow_) {
+                overflow_->erase(price);
+                if (overflow_->size() <= N / 2) demote();
+                return;
+            }
+            
+            size_t i = position(price);
+            if (i == count_ || prices_[i] != price) return;
+            
+            std::memmove(prices_ + i, prices_ + i + 1, (count_ - i - 1) * sizeof(int64_t));
+            std::memmove(levels_ + i, levels_ + i + 1, (count_ - i - 1) * sizeof(PriceLevel));
+            prices_[--count_] = SideTraits<S>::worst;
+        }
+        
+        const PriceLevel* best() const {
+            if (overflow_) return overflow_->best();
+            return count_ == 0 ? nullptr : &levels_[0];
+        }
+        
+        size_t size() const { return overflow_ ? overflow_->size() : count_; }
+        bool promoted() const { return overflow_ != nullptr; }
+        
+        void clear() {
+            overflow_.reset();
+            count_ = 0;
+            std::fill(prices_, prices_ + N, SideTraits<S>::worst);
+        }
+        
+        template<typename Visitor>
+        void for_each(Visitor&& visit, size_t max_levels = SIZE_MAX) const {
+            if (overflow_) {
+                overflow_->for_each(visit, max_levels);
+                return;
+            }
+            for (size_t i = 0; i < count_ && i < max_levels; ++i) {
+                visit(levels_[i]);
+            }
+        }
+    };
+};
+
+struct RestingOrder {
+    int64_t price;
+    uint64_t quantity;
+    Side side;
+};
+
+// Order store policies: find, insert (false on duplicate), erase, size, clear.
+
+template<bool Pooled>
+class BasicHashOrderStore {
+    using Allocator = PoolAllocator<std::pair<const uint64_t, RestingOrder>>;
+    
+    PoolResource pool_;
+    std::unordered_map<uint64_t, RestingOrder, std::hash<uint64_t>, std::equal_to<uint64_t>, Allocator> orders_;
+
+public:
+    BasicHashOrderStore() : orders_(Allocator(Pooled ? &pool_ : nullptr)) {}
+    
+    RestingOrder* find(uint64_t order_id) {
+        auto it = orders_.find(order_id);
+        return it == orders_.end() ? nullptr : &it->second;
+    }
+    
+    bool insert(uint64_t order_id, const RestingOrder& order) { return orders_.emplace(order_id, order).second; }
+    void erase(uint64_t order_id) { orders_.erase(order_id); }
+    size_t size() const { return orders_.size(); }
+    void clear() { orders_.clear(); }
+};
+
+using HashOrderStore = BasicHashOrderStore<false>;
+using PooledHashOrderStore = BasicHashOrderStore<true>;
+
+// Direct-indexed by order id, for feeds whose references are small and dense
+// such as ITCH, which numbers orders sequentially from the start of day.
+class DenseOrderStore {
+    std::vector<RestingOrder> orders_;
+    size_t count_;
+
+public:
+    DenseOrderStore() : count_(0) {}
+    
+    RestingOrder* find(uint64_t order_id) {
+        if (order_id >= orders_.size() || orders_[order_id].quantity == 0) return nullptr;
+        return &orders_[order_id];
+    }
+    
+    bool insert(uint64_t order_id, const RestingOrder& order) {
+        if (order_id >= orders_.size()) {
+            size_t size = std::max(orders_.size() * 2, size_t(1024));
+            while (size <= order_id) size *= 2;
+            orders_.resize(size, RestingOrder{0, 0, Side::Bid});
+        } else if (orders_[order_id].quantity != 0) {
+            return false;
+        }
+        orders_[order_id] = order;
+        count_++;
+        return true;
+    }
+    
+    void erase(uint64_t order_id) {
+        if (order_id < orders_.size() && orders_[order_id].quantity != 0) {
+            orders_[order_id].quantity = 0;
+            count_--;
+        }
+    }
+    
+    size_t size() const { return count_; }
+    
+    void clear() {
+        orders_.clear();
+        count_ = 0;
+    }
+};
+
+// Side tracking policies: whether resting quantity per side is accumulated.
+
+struct TrackSideTotals {
+    static constexpr bool enabled = true;
+    uint64_t totals[2] = {0, 0};
+    
+    void add(Side side, uint64_t quantity) { totals[static_cast<size_t>(side)] += quantity; }
+    void remove(Side side, uint64_t quantity) { totals[static_cast<size_t>(side)] -= quantity; }
+    uint64_t total(Side side) const { return totals[static_cast<size_t>(side)]; }
+    void clear() { totals[0] = totals[1] = 0; }
+};
+
+struct NoSideTotals {
+    static constexpr bool enabled = false;
+    
+    void add(Side, uint64_t) {}
+    void remove(Side, uint64_t) {}
+    uint64_t total(Side) const { return 0; }
+    void clear() {}
+};
+
+// Order-by-order book assembled from policies. The side is resolved once
+// when an order enters; everything after works on Store<Side> directly, with
+// no virtual dispatch. Any level change outside the touch reports
+// DEPTH_CHANGED; depth() copies the best MaxDepth levels per side.
+template<typename LevelPolicy, typename OrderStore = HashOrderStore,
+         typename Tracking = NoSideTotals, size_t MaxDepth = 10>
+class BasicOrderBook {
+public:
+    static constexpr size_t MAX_DEPTH = MaxDepth;
+    static_assert(MaxDepth > 0, "depth must be at least one level");
+    
+    template<Side S>
+    using LevelStore = typename LevelPolicy::template Store<S>;
+
+private:
+    SymbolId symbol_;
+    LevelStore<Side::Bid> bids_;
+    LevelStore<Side::Ask> asks_;
+    OrderStore orders_;
+    Tracking tracking_;
+    TopOfBook top_;
+    uint64_t message_count_;
+    
+    template<Side S>
+    LevelStore<S>& side_levels() {
+        if constexpr (S == Side::Bid) return bids_;
+        else return asks_;
+    }
+    
+    template<Side S>
+    uint8_t refresh_top(uint64_t timestamp) {
+        const PriceLevel* best = side_levels<S>().best();
+        int64_t best_price = best ? best->price : 0;
+        uint64_t best_size = best ? best->size : 0;
+        int64_t& top_price = S == Side::Bid ? top_.bid_price : top_.ask_price;
+        uint64_t& top_size = S == Side::Bid ? top_.bid_size : top_.ask_size;
+        
+        top_.timestamp = timestamp;
+        uint8_t changes = BOOK_UNCHANGED;
+        if (best_price != top_price) changes |= BBO_PRICE_CHANGED;
+        if (best_size != top_size) changes |= BBO_SIZE_CHANGED;
+        top_price = best_price;
+        top_size = best_size;
+        return changes ? changes : static_cast<uint8_t>(DEPTH_CHANGED);
+    }
+    
+    template<Side S>
+    BookUpdate add(uint64_t order_id, int64_t price, uint64_t quantity, uint64_t timestamp) {
+        PriceLevel* level = side_levels<S>().insert(price);
+        if (!level) return BookUpdate();
+        
+        if (!orders_.insert(order_id, RestingOrder{price, quantity, S})) {
+            if (level->size == 0) side_levels<S>().erase(price);
+            return BookUpdate();
+        }
+        
+        level->size += quantity;
+        level->order_count++;
+        tracking_.add(S, quantity);
+        return BookUpdate(true, refresh_top<S>(timestamp));
+    }
+    
+    template<Side S>
+    BookUpdate reduce(uint64_t order_id, RestingOrder& order, uint64_t quantity, uint64_t timestamp) {
+        int64_t price = order.price;
+        quantity = std::min(quantity, order.quantity);
+        
+        PriceLevel* level = side_levels<S>().find(price);
+        level->size -= quantity;
+        tracking_.remove(S, quantity);
+        
+        if (quantity == order.quantity) {
+            orders_.erase(order_id);
+            if (--level->order_count == 0) {
+                side_levels<S>().erase(price);
+            }
+        } else {
+            order.quantity -= quantity;
+        }
+        return BookUpdate(true, refresh_top<S>(timestamp));
+    }
+    
+    BookUpdate reduce(uint64_t order_id, uint64_t quantity, uint64_t timestamp) {
+        message_count_++;
+        RestingOrder* order = orders_.find(order_id);
+        if (!order) return BookUpdate();
+        return order->side == Side::Bid ? reduce<Side::Bid>(order_id, *order, quantity, timestamp)
+                                        : reduce<Side::Ask>(order_id, *order, quantity, timestamp);
+    }
+
+public:
+    explicit BasicOrderBook(SymbolId symbol = SymbolId()) : symbol_(symbol), message_count_(0) {}
+    
+    BookUpdate add_order(uint64_t order_id, char side, int64_t price, uint64_t quantity, uint64_t timestamp) {
+        message_count_++;
+        if (quantity == 0) return BookUpdate();
+        return (side == 'B' || side == 'b') ? add<Side::Bid>(order_id, price, quantity, timestamp)
+                                            : add<Side::Ask>(order_id, price, quantity, timestamp);
+    }
+    
+    template<Side S>
+    BookUpdate add_order(uint64_t order_id, int64_t price, uint64_t quantity, uint64_t timestamp) {
+        message_count_++;
+        if (quantity == 0) return BookUpdate();
+        return add<S>(order_id, price, quantity, timestamp);
+    }
+    
+    BookUpdate execute_order(uint64_t order_id, uint64_t quantity, uint64_t timestamp) {
+        return reduce(order_id, quantity, timestamp);
+    }
+    
+    BookUpdate cancel_order(uint64_t order_id, uint64_t quantity, uint64_t timestamp) {
+        return reduce(order_id, quantity, timestamp);
+    }
+    
+    BookUpdate delete_order(uint64_t order_id, uint64_t timestamp) {
+        return reduce(order_id, UINT64_MAX, timestamp);
+    }
+    
+    BookUpdate replace_order(uint64_t old_order_id, uint64_t new_order_id,
+                             uint64_t quantity, int64_t price, uint64_t timestamp) {
+        RestingOrder* order = orders_.find(old_order_id);
+        if (!order) {
+            message_count_++;
+            return BookUpdate();
+        }
+        
+        Side side = order->side;
+        BookUpdate removed = reduce(old_order_id, UINT64_MAX, timestamp);
+        BookUpdate added = side == Side::Bid ? add<Side::Bid>(new_order_id, price, quantity, timestamp)
+                                             : add<Side::Ask>(new_order_id, price, quantity, timestamp);
+        return BookUpdate(added.applied, removed.changes | added.changes);
+    }
+    
+    const TopOfBook& top() const { return top_; }
+    SymbolId symbol() const { return symbol_; }
+    uint64_t message_count() const { return message_count_; }
+    size_t total_orders() const { return orders_.size(); }
+    size_t bid_levels() const { return bids_.size(); }
+    size_t ask_levels() const { return asks_.size(); }
+    
+    template<Side S>
+    const LevelStore<S>& levels() const {
+        if constexpr (S == Side::Bid) return bids_;
+        else return asks_;
+    }
+    
+    template<bool Enabled = Tracking::enabled, typename = std::enable_if_t<Enabled>>
+    uint64_t total_quantity(Side side) const { return tracking_.total(side); }
+    
+    template<bool Enabled = Tracking::enabled, typename = std::enable_if_t<Enabled>>
+    double imbalance() const {
+        uint64_t bid = tracking_.total(Side::Bid);
+        uint64_t ask = tracking_.total(Side::Ask);
+        return bid + ask == 0 ? 0.0 : (static_cast<double>(bid) - static_cast<double>(ask)) / (bid + ask);
+    }
+    
+    void depth(DepthSnapshot<MaxDepth>& out) const {
+        out.timestamp = top_.timestamp;
+        out.bid_count = 0;
+        out.ask_count = 0;
+        bids_.for_each([&out](const PriceLevel& level) { out.bids[out.bid_count++] = level; }, MaxDepth);
+        asks_.for_each([&out](const PriceLevel& level) { out.asks[out.ask_count++] = level; }, MaxDepth);
+    }
+    
+    void clear() {
+        bids_.clear();
+        asks_.clear();
+        orders_.clear();
+        tracking_.clear();
+        top_ = TopOfBook();
+        message_count_ = 0;
+    }
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "itch_book_builder.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+class BookSnapshotter;
+
+// On-disk layout: header, then per book a CheckpointBook record followed by
+// its bid levels, ask levels and orders. Every record is a multiple of eight
+// bytes so the file can be walked in place once it is mapped.
+struct CheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t book_count;
+    uint64_t order_count;
+    uint64_t level_count;
+    uint64_t feed_offset;
+    uint64_t sequence;
+    uint64_t payload_size;
+    uint64_t checksum;
+};
+
+struct CheckpointBook {
+    uint64_t symbol;
+    uint16_t stock_locate;
+    uint16_t reserved;
+    uint32_t bid_levels;
+    uint32_t ask_levels;
+    uint32_t padding;
+    uint64_t order_count;
+    BookCounters counters;
+};
+
+struct CheckpointOrder {
+    uint64_t order_id;
+    int64_t price;
+    uint64_t quantity;
+    uint64_t timestamp;
+    uint64_t priority;
+    char side;
+    char padding[7];
+};
+
+static_assert(sizeof(CheckpointHeader) == 64, "checkpoint header layout changed");
+static_assert(sizeof(CheckpointBook) == 64, "checkpoint book layout changed");
+static_assert(sizeof(CheckpointOrder) == 48, "checkpoint order layout changed");
+static_assert(sizeof(PriceLevel) == 24, "checkpoint level layout changed");
+
+constexpr uint32_t CHECKPOINT_VERSION = 1;
+
+void start_checkpoint(std::vector<uint8_t>& out);
+void serialize_book(uint16_t stock_locate, const EnhancedOrderBook& book, std::vector<uint8_t>& out);
+size_t serialized_book_size(const EnhancedOrderBook& book);
+void seal_checkpoint(std::vector<uint8_t>& image, uint64_t feed_offset, uint64_t sequence);
+size_t serialize_checkpoint(const ItchBookBuilder& builder, uint64_t feed_offset,
+                            uint64_t sequence, std::vector<uint8_t>& out);
+
+// Rebuilds the book stored at cursor and returns the next record, or nullptr
+// when the record is truncated or inconsistent.
+const uint8_t* restore_book_record(const uint8_t* cursor, const uint8_t* end,
+                                   ItchBookBuilder& builder, std::vector<Order>& scratch);
+bool write_checkpoint_file(const std::string& path, const uint8_t* data, size_t size);
+
+// Captures the books at a single feed position and leaves the file I/O to a
+// background thread. submit() copies every book on the calling thread; with a
+// BookSnapshotter the feed marks the epoch and copies books as it goes, and
+// the background thread assembles the image from those copies. stop() then
+// belongs on the feed thread, which finishes the copies the writer waits for.
+class CheckpointWriter {
+public:
+    struct Stats {
+        uint64_t written;
+        uint64_t failed;
+        uint64_t superseded;
+        uint64_t last_bytes;
+        uint64_t last_sequence;
+        uint64_t last_write_ns;
+    };
+
+private:
+    std::string path_;
+    uint64_t interval_;
+    uint64_t last_submitted_;
+    
+    std::thread thread_;
+    std::mutex mutex_;
+    std::mutex io_mutex_;
+    std::condition_variable ready_;
+    std::vector<uint8_t> pending_;
+    std::vector<uint8_t> spare_;
+    BookSnapshotter* pending_snapshot_;
+    BookSnapshotter* last_snapshot_;
+    bool has_pending_;
+    bool running_;
+    
+    std::atomic<uint64_t> written_;
+    std::atomic<uint64_t> failed_;
+    std::atomic<uint64_t> superseded_;
+    std::atomic<uint64_t> last_bytes_;
+    std::atomic<uint64_t> last_sequence_;
+    std::atomic<uint64_t> last_write_ns_;
+    
+    void writer_loop();
+    bool write_image(const std::vector<uint8_t>& image);
+
+public:
+    explicit CheckpointWriter(const std::string& path, uint64_t interval_messages = 1000000);
+    ~CheckpointWriter();
+    
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+    
+    void start();
+    void stop();
+    
+    bool due(uint64_t sequence) const { return sequence - last_submitted_ >= interval_; }
+    void submit(const ItchBookBuilder& builder, uint64_t feed_offset, uint64_t sequence);
+    bool submit(BookSnapshotter& snapshot, uint64_t feed_offset, uint64_t sequence);
+    bool write_now(const ItchBookBuilder& builder, uint64_t feed_offset, uint64_t sequence);
+    
+    const std::string& path() const { return path_; }
+    Stats stats() const;
+};
+
+class CheckpointReader {
+    std::string filename_;
+    
+#ifdef _WIN32
+    HANDLE file_handle_;
+    HANDLE mapping_handle_;
+    const void* mapped_ptr_;
+#else
+    int fd_;
+    const void* mapped_ptr_;
+#endif
+    
+    size_t file_size_;
+    const CheckpointHeader* header_;
+    
+    void unmap();
+
+public:
+    explicit CheckpointReader(const std::string& filename);
+    ~CheckpointReader();
+    
+    CheckpointReader(const CheckpointReader&) = delete;
+    CheckpointReader& operator=(const CheckpointReader&) = delete;
+    
+    bool restore(ItchBookBuilder& builder) const;
+    
+    uint64_t feed_offset() const { return header_->feed_offset; }
+    uint64_t sequence() const { return header_->sequence; }
+    size_t book_count() const { return header_->book_count; }
+    uint64_t order_count() const { return header_->order_count; }
+    size_t size() const { return file_size_; }
+};
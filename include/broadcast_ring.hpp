@@ -0,0 +1,222 @@
+#pragma once
+
+#include "seqlock.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Single-producer ring read by several consumers, each through its own
+// sequence cursor, so an event is written once and every consumer reads the
+// same slot instead of its own copy. A consumer may depend on others (the
+// recorder after the book); it then never reads past the slowest of them.
+//
+// Gating decides what happens when the producer laps a consumer. The default
+// ring waits: claim() fails while the slowest consumer still needs the slot.
+// The lossy ring never waits; slots are seqlocks tagged with their sequence,
+// so a lapped consumer notices, skips to the oldest event still in the ring
+// and adds what it missed to lost(). Lossy payloads must be trivially
+// copyable, and consumers read copies rather than the slot in place.
+//
+// Register every consumer before the producer starts.
+template<typename T, bool Lossy>
+class BasicBroadcastRing {
+    struct Entry {
+        uint64_t sequence;
+        T value;
+    };
+    
+    using Slot = std::conditional_t<Lossy, Seqlock<Entry>, T>;
+    
+    static constexpr size_t CACHE_LINE = 64;
+    static constexpr int SPINS_BEFORE_YIELD = 64;
+    
+public:
+    class Consumer {
+        friend class BasicBroadcastRing;
+        
+        alignas(CACHE_LINE) std::atomic<uint64_t> cursor_;
+        std::atomic<uint64_t> lost_;
+        BasicBroadcastRing* ring_;
+        std::vector<const Consumer*> after_;
+        
+        uint64_t barrier() const {
+            if (after_.empty()) {
+                return ring_->published_.load(std::memory_order_acquire);
+            }
+            uint64_t end = std::numeric_limits<uint64_t>::max();
+            for (const Consumer* dependency : after_) {
+                end = std::min(end, dependency->cursor_.load(std::memory_order_acquire));
+            }
+            return end;
+        }
+    
+    public:
+        Consumer(BasicBroadcastRing& ring, std::vector<const Consumer*> after, uint64_t start)
+            : cursor_(start), lost_(0), ring_(&ring), after_(std::move(after)) {}
+        
+        Consumer(const Consumer&) = delete;
+        Consumer& operator=(const Consumer&) = delete;
+        
+        // Hands up to max available events to handler(const T&) and publishes
+        // the new cursor once for the whole batch. Returns the number handled.
+        template<typename Handler>
+        size_t poll(Handler&& handler, size_t max = std::numeric_limits<size_t>::max()) {
+            const uint64_t start = cursor_.load(std::memory_order_relaxed);
+            uint64_t cursor = start;
+            uint64_t end = barrier();
+            size_t n = 0;
+            
+            while (cursor < end && n < max) {
+                if constexpr (Lossy) {
+                    Entry entry;
+                    if (!ring_->slots_[cursor & ring_->mask_].try_load(entry) || entry.sequence != cursor) {
+                        // Only a lap makes the slot hold anything but our sequence.
+                        uint64_t published = ring_->published_.load(std::memory_order_acquire);
+                        uint64_t oldest = published > ring_->mask_ ? published - ring_->mask_ : 0;
+                        if (oldest > cursor) {
+                            lost_.store(lost_.load(std::memory_order_relaxed) + (oldest - cursor),
+                                        std::memory_order_relaxed);
+                            cursor = oldest;
+                        }
+                        continue;
+                    }
+                    handler(static_cast<const T&>(entry.value));
+                } else {
+                    handler(static_cast<const T&>(ring_->slots_[cursor & ring_->mask_]));
+                }
+                ++cursor;
+                ++n;
+            }
+            
+            if (cursor != start) {
+                cursor_.store(cursor, std::memory_order_release);
+            }
+            return n;
+        }
+        
+        // Next sequence this consumer will read.
+        uint64_t sequence() const { return cursor_.load(std::memory_order_acquire); }
+        
+        size_t backlog() const {
+            uint64_t published = ring_->published_.load(std::memory_order_acquire);
+            return static_cast<size_t>(published - sequence());
+        }
+        
+        // Events skipped because the producer overwrote them first; always
+        // zero on a waiting ring.
+        uint64_t lost() const { return lost_.load(std::memory_order_relaxed); }
+    };
+    
+private:
+    alignas(CACHE_LINE) std::atomic<uint64_t> published_{0};
+    uint64_t gate_cache_{0};
+    bool claimed_{false};
+    
+    alignas(CACHE_LINE) size_t capacity_;
+    size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    std::vector<std::unique_ptr<Consumer>> consumers_;
+    
+    uint64_t slowest_cursor() const {
+        uint64_t slowest = published_.load(std::memory_order_relaxed);
+        for (const auto& consumer : consumers_) {
+            slowest = std::min(slowest, consumer->cursor_.load(std::memory_order_acquire));
+        }
+        return slowest;
+    }
+    
+public:
+    explicit BasicBroadcastRing(size_t capacity)
+        : capacity_(capacity)
+        , mask_(capacity - 1) {
+        
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("capacity must be power of 2");
+        }
+        slots_.reset(new Slot[capacity]);
+    }
+    
+    BasicBroadcastRing(const BasicBroadcastRing&) = delete;
+    BasicBroadcastRing& operator=(const BasicBroadcastRing&) = delete;
+    
+    // The consumer starts at the next event published and reads nothing the
+    // consumers in after have not finished with.
+    Consumer& add_consumer(std::vector<const Consumer*> after = {}) {
+        for (const Consumer* dependency : after) {
+            if (!dependency || dependency->ring_ != this) {
+                throw std::invalid_argument("dependency belongs to another ring");
+            }
+        }
+        consumers_.push_back(std::make_unique<Consumer>(*this, std::move(after),
+                                                        published_.load(std::memory_order_relaxed)));
+        return *consumers_.back();
+    }
+    
+    // Returns the next slot to fill in place, or nullptr while the slowest
+    // consumer still needs it. Visible to consumers after commit(). Waiting
+    // ring only; a lossy slot is written whole by publish().
+    T* claim() {
+        static_assert(!Lossy, "lossy slots are written with publish()");
+        uint64_t sequence = published_.load(std::memory_order_relaxed);
+        if (!claimed_) {
+            if (sequence - gate_cache_ >= capacity_) {
+                gate_cache_ = slowest_cursor();
+                if (sequence - gate_cache_ >= capacity_) {
+                    return nullptr;
+                }
+            }
+            claimed_ = true;
+        }
+        return &slots_[sequence & mask_];
+    }
+    
+    void commit() {
+        if (!claimed_) return;
+        
+        claimed_ = false;
+        published_.store(published_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    
+    // Never fails on a lossy ring.
+    bool try_publish(const T& value) {
+        if constexpr (Lossy) {
+            uint64_t sequence = published_.load(std::memory_order_relaxed);
+            slots_[sequence & mask_].store(Entry{sequence, value});
+            published_.store(sequence + 1, std::memory_order_release);
+            return true;
+        } else {
+            T* slot = claim();
+            if (!slot) {
+                return false;
+            }
+            *slot = value;
+            commit();
+            return true;
+        }
+    }
+    
+    // Spins briefly, then yields, until the slowest consumer frees a slot.
+    void publish(const T& value) {
+        for (int spins = 0; !try_publish(value); ) {
+            if (++spins > SPINS_BEFORE_YIELD) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    
+    uint64_t published() const { return published_.load(std::memory_order_acquire); }
+    size_t capacity() const { return capacity_; }
+    size_t consumer_count() const { return consumers_.size(); }
+};
+
+template<typename T>
+using BroadcastRing = BasicBroadcastRing<T, false>;
+
+template<typename T>
+using LossyBroadcastRing = BasicBroadcastRing<T, true>;
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "seqlock.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+// Single-producer, single-consumer queue that keeps only the latest value per
+// key. publish() overwrites the key's slot and queues the key once until the
+// consumer takes it, so a slow consumer reads current state instead of a
+// backlog and memory is fixed by the key count. The producer never blocks.
+template<typename T>
+class ConflatingQueue {
+    struct Slot {
+        Seqlock<T> value;
+        alignas(64) std::atomic<bool> queued;
+        
+        Slot() : queued(false) {}
+    };
+    
+    static constexpr size_t CACHE_LINE = 64;
+    
+    size_t keys_;
+    size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    std::unique_ptr<uint32_t[]> ring_;
+    
+    alignas(CACHE_LINE) std::atomic<uint64_t> head_;
+    std::atomic<uint64_t> published_;
+    std::atomic<uint64_t> conflated_;
+    alignas(CACHE_LINE) std::atomic<uint64_t> tail_;
+    
+    static size_t ring_capacity(size_t keys) {
+        size_t capacity = 1;
+        while (capacity < keys) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+public:
+    explicit ConflatingQueue(size_t keys)
+        : keys_(keys)
+        , mask_(ring_capacity(keys) - 1)
+        , slots_(new Slot[keys])
+        , ring_(new uint32_t[ring_capacity(keys)])
+        , head_(0)
+        , published_(0)
+        , conflated_(0)
+        , tail_(0) {
+        
+        if (keys == 0 || keys > UINT32_MAX) {
+            throw std::invalid_argument("key count out of range");
+        }
+    }
+    
+    ConflatingQueue(const ConflatingQueue&) = delete;
+    ConflatingQueue& operator=(const ConflatingQueue&) = delete;
+    
+    void publish(uint32_t key, const T& value) {
+        Slot& slot = slots_[key];
+        slot.value.store(value);
+        published_.store(published_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        
+        // A key sits in the ring at most once, so the ring cannot overflow.
+        if (slot.queued.exchange(true, std::memory_order_seq_cst)) {
+            conflated_.store(conflated_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        ring_[head & mask_] = key;
+        head_.store(head + 1, std::memory_order_release);
+    }
+    
+    bool try_pop(uint32_t& key, T& value) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        
+        key = ring_[tail & mask_];
+        tail_.store(tail + 1, std::memory_order_release);
+        
+        // Clearing the flag before reading means a publish that lands after
+        // the read queues the key again rather than being lost.
+        Slot& slot = slots_[key];
+        slot.queued.store(false, std::memory_order_seq_cst);
+        value = slot.value.load();
+        return true;
+    }
+    
+    template<typename Visitor>
+    size_t drain(Visitor&& visit, size_t max_items = SIZE_MAX) {
+        uint32_t key;
+        T value;
+        size_t count = 0;
+        while (count < max_items && try_pop(key, value)) {
+            visit(key, value);
+            count++;
+        }
+        return count;
+    }
+    
+    // Latest value for a key regardless of whether it is queued.
+    T peek(uint32_t key) const { return slots_[key].value.load(); }
+    
+    size_t pending() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+    bool empty() const { return pending() == 0; }
+    size_t key_count() const { return keys_; }
+    
+    uint64_t published() const { return published_.load(std::memory_order_relaxed); }
+    uint64_t conflated() const { return conflated_.load(std::memory_order_relaxed); }
+};
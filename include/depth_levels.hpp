@@ -0,0 +1,104 @@
+#pragma once
+
+#include "order_book.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+struct LevelSpan {
+    const PriceLevel* data;
+    size_t size;
+    
+    LevelSpan() : data(nullptr), size(0) {}
+    LevelSpan(const PriceLevel* d, size_t s) : data(d), size(s) {}
+    
+    const PriceLevel* begin() const { return data; }
+    const PriceLevel* end() const { return data + size; }
+    const PriceLevel& operator[](size_t i) const { return data[i]; }
+    bool empty() const { return size == 0; }
+};
+
+template<size_t N>
+struct DepthSnapshot {
+    uint64_t timestamp;
+    uint32_t bid_count;
+    uint32_t ask_count;
+    PriceLevel bids[N];
+    PriceLevel asks[N];
+};
+
+template<size_t N, typename Compare>
+class TopLevels {
+    static_assert(N > 0, "TopLevels needs at least one level");
+    
+    alignas(64) std::array<PriceLevel, N> levels_;
+    size_t count_;
+    Compare better_;
+    
+    size_t lower_bound(int64_t price) const {
+        size_t i = 0;
+        while (i < count_ && better_(levels_[i].price, price)) {
+            ++i;
+        }
+        return i;
+    }
+    
+public:
+    TopLevels() : levels_(), count_(0), better_() {}
+    
+    static constexpr size_t capacity() { return N; }
+    
+    LevelSpan span() const { return LevelSpan(levels_.data(), count_); }
+    size_t size() const { return count_; }
+    
+    bool update(const PriceLevel& level) {
+        size_t i = lower_bound(level.price);
+        if (i < count_ && levels_[i].price == level.price) {
+            levels_[i] = level;
+            return true;
+        }
+        if (i == N) {
+            return false;
+        }
+        
+        size_t last = count_ < N ? count_ : N - 1;
+        for (size_t j = last; j > i; --j) {
+            levels_[j] = levels_[j - 1];
+        }
+        levels_[i] = level;
+        if (count_ < N) {
+            ++count_;
+        }
+        return true;
+    }
+    
+    template<typename Map>
+    bool remove(int64_t price, const Map& levels) {
+        size_t i = lower_bound(price);
+        if (i == count_ || levels_[i].price != price) {
+            return false;
+        }
+        
+        bool was_full = count_ == N;
+        for (size_t j = i + 1; j < count_; ++j) {
+            levels_[j - 1] = levels_[j];
+        }
+        --count_;
+        
+        // Only a full window can have levels waiting behind it in the map.
+        if (was_full) {
+            auto it = count_ == 0 ? levels.begin() : levels.upper_bound(levels_[count_ - 1].price);
+            if (it != levels.end()) {
+                levels_[count_++] = it->second;
+            }
+        }
+        return true;
+    }
+    
+    uint32_t copy_to(PriceLevel* out) const {
+        std::copy(levels_.begin(), levels_.begin() + count_, out);
+        return static_cast<uint32_t>(count_);
+    }
+    
+    void clear() { count_ = 0; }
+};
@@ -1,49 +1,111 @@
 #pragma once
 
 #include "order_book.hpp"
+#include "depth_levels.hpp"
+#include "seqlock.hpp"
+#include "arena.hpp"
 #include <unordered_map>
 #include <memory>
 
+#ifndef BOOK_DEPTH_LEVELS
+#define BOOK_DEPTH_LEVELS 10
+#endif
+
 struct Order {
     uint64_t order_id;
-    std::string symbol;
+    SymbolId symbol;
     char side;
     int64_t price;
     uint64_t quantity;
     uint64_t timestamp;
+    uint64_t priority;
+    
+    Order() : order_id(0), side('B'), price(0), quantity(0), timestamp(0), priority(0) {}
+    Order(uint64_t id, SymbolId sym, char s, int64_t p, uint64_t q, uint64_t ts)
+        : order_id(id), symbol(sym), side(s), price(p), quantity(q), timestamp(ts), priority(0) {}
+};
+
+struct QueuePosition {
+    uint64_t order_id;
+    char side;
+    int64_t price;
+    uint64_t quantity;
+    uint64_t priority;
+    uint64_t shares_ahead;
+    uint64_t orders_ahead;
     
-    Order() : order_id(0), side('B'), price(0), quantity(0), timestamp(0) {}
-    Order(uint64_t id, const std::string& sym, char s, int64_t p, uint64_t q, uint64_t ts)
-        : order_id(id), symbol(sym), side(s), price(p), quantity(q), timestamp(ts) {}
+    uint64_t rank() const { return orders_ahead; }
+};
+
+struct BookCounters {
+    uint64_t last_update_time;
+    uint64_t message_count;
+    uint64_t next_priority;
+    uint64_t next_level_order_id;
 };
 
 class EnhancedOrderBook {
-    std::string symbol_;
-    std::map<int64_t, PriceLevel, std::greater<int64_t>> bids_;
-    std::map<int64_t, PriceLevel, std::less<int64_t>> asks_;
-    std::unordered_map<uint64_t, Order> orders_;
+public:
+    static constexpr size_t DEPTH_LEVELS = BOOK_DEPTH_LEVELS;
+    using PublishedDepth = Seqlock<DepthSnapshot<DEPTH_LEVELS>>;
+    
+private:
+    using OrderMap = std::unordered_map<uint64_t, Order, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                                        PoolAllocator<std::pair<const uint64_t, Order>>>;
+    
+    SymbolId symbol_;
+    PoolResource node_pool_;
+    LevelMap<std::greater<int64_t>> bids_;
+    LevelMap<std::less<int64_t>> asks_;
+    OrderMap orders_;
     
     uint64_t last_update_time_;
     uint64_t message_count_;
     uint64_t total_bid_quantity_;
     uint64_t total_ask_quantity_;
+    uint64_t next_priority_;
+    uint64_t next_level_order_id_;
+    
+    std::unordered_map<uint64_t, QueuePosition> watched_;
+    std::unordered_map<int64_t, std::vector<uint64_t>> watched_bid_levels_;
+    std::unordered_map<int64_t, std::vector<uint64_t>> watched_ask_levels_;
+    std::vector<uint32_t> watched_mpids_;
+    
+    TopLevels<DEPTH_LEVELS, std::greater<int64_t>> bid_depth_;
+    TopLevels<DEPTH_LEVELS, std::less<int64_t>> ask_depth_;
+    bool depth_window_changed_;
+    
+    TopOfBook top_;
+    mutable OrderBookSnapshot snapshot_;
+    mutable bool snapshot_dirty_;
+    
+    Seqlock<TopOfBook> published_top_;
+    std::unique_ptr<PublishedDepth> published_depth_;
     
 public:
-    explicit EnhancedOrderBook(const std::string& symbol);
+    // Level and order nodes come from provider when one is given.
+    explicit EnhancedOrderBook(SymbolId symbol, MemoryProvider* provider = nullptr);
+    explicit EnhancedOrderBook(const std::string& symbol, MemoryProvider* provider = nullptr);
     
-    bool add_order(uint64_t order_id, char side, int64_t price, 
-                   uint64_t quantity, uint64_t timestamp);
+    BookUpdate add_order(uint64_t order_id, char side, int64_t price, 
+                         uint64_t quantity, uint64_t timestamp);
     
-    bool modify_order(uint64_t order_id, uint64_t new_quantity, uint64_t timestamp);
+    BookUpdate add_attributed_order(uint64_t order_id, char side, int64_t price,
+                                    uint64_t quantity, uint64_t timestamp, const char* mpid);
     
-    bool cancel_order(uint64_t order_id, uint64_t cancelled_quantity, uint64_t timestamp);
+    BookUpdate add_bid(int64_t price, uint64_t quantity, uint64_t timestamp);
+    BookUpdate add_ask(int64_t price, uint64_t quantity, uint64_t timestamp);
     
-    bool delete_order(uint64_t order_id, uint64_t timestamp);
+    BookUpdate modify_order(uint64_t order_id, uint64_t new_quantity, uint64_t timestamp);
     
-    bool execute_order(uint64_t order_id, uint64_t executed_quantity, uint64_t timestamp);
+    BookUpdate cancel_order(uint64_t order_id, uint64_t cancelled_quantity, uint64_t timestamp);
     
-    bool replace_order(uint64_t old_order_id, uint64_t new_order_id,
-                      uint64_t new_quantity, int64_t new_price, uint64_t timestamp);
+    BookUpdate delete_order(uint64_t order_id, uint64_t timestamp);
+    
+    BookUpdate execute_order(uint64_t order_id, uint64_t executed_quantity, uint64_t timestamp);
+    
+    BookUpdate replace_order(uint64_t old_order_id, uint64_t new_order_id,
+                             uint64_t new_quantity, int64_t new_price, uint64_t timestamp);
     
     std::optional<int64_t> best_bid() const;
     std::optional<int64_t> best_ask() const;
@@ -54,23 +116,73 @@ public:
     double imbalance() const;
     double mid_price() const;
     
-    OrderBookSnapshot snapshot() const;
+    const TopOfBook& top() const { return top_; }
+    const OrderBookSnapshot& snapshot() const;
+    
+    const Seqlock<TopOfBook>& published_top() const { return published_top_; }
+    const PublishedDepth* published_depth() const { return published_depth_.get(); }
+    void enable_depth_publishing();
     
-    const std::string& symbol() const { return symbol_; }
+    SymbolId symbol() const { return symbol_; }
     uint64_t message_count() const { return message_count_; }
     size_t total_orders() const { return orders_.size(); }
+    const Order* find_order(uint64_t order_id) const;
     
     size_t bid_levels() const { return bids_.size(); }
     size_t ask_levels() const { return asks_.size(); }
     
+    LevelSpan bid_depth() const { return bid_depth_.span(); }
+    LevelSpan ask_depth() const { return ask_depth_.span(); }
+    
     std::vector<PriceLevel> get_bid_depth(size_t levels) const;
     std::vector<PriceLevel> get_ask_depth(size_t levels) const;
     
+    // Copies into the arena; the span stays valid until the caller's scope rewinds.
+    LevelSpan get_bid_depth(size_t levels, Arena& arena) const;
+    LevelSpan get_ask_depth(size_t levels, Arena& arena) const;
+    
     bool has_crossing() const;
     
+    void watch_mpid(const char* mpid);
+    bool watch_order(uint64_t order_id);
+    void unwatch_order(uint64_t order_id);
+    const QueuePosition* queue_position(uint64_t order_id) const;
+    size_t watched_orders() const { return watched_.size(); }
+    
+    template<typename Visitor>
+    void for_each_order(Visitor&& visit) const {
+        for (const auto& entry : orders_) {
+            visit(entry.second);
+        }
+    }
+    
+    template<typename Visitor>
+    void for_each_level(char side, Visitor&& visit) const {
+        if (side == 'B' || side == 'b') {
+            for (const auto& entry : bids_) visit(entry.second);
+        } else {
+            for (const auto& entry : asks_) visit(entry.second);
+        }
+    }
+    
+    BookCounters counters() const;
+    void restore(const BookCounters& counters, const Order* orders, size_t count);
+    
     void clear();
     
 private:
     void remove_from_price_level(const Order& order);
     void add_to_price_level(const Order& order);
+    uint8_t level_changed(char side, int64_t price, uint64_t timestamp);
+    uint8_t refresh_top(char side, int64_t price);
+    void publish_update(uint8_t changes, uint64_t timestamp);
+    void publish_depth();
+    
+    std::unordered_map<int64_t, std::vector<uint64_t>>& watched_levels(char side) {
+        return (side == 'B' || side == 'b') ? watched_bid_levels_ : watched_ask_levels_;
+    }
+    
+    void start_watching(const Order& order, uint64_t shares_ahead, uint64_t orders_ahead);
+    void stop_watching(const QueuePosition& position);
+    void on_order_reduced(const Order& order, uint64_t reduced_quantity, bool removed);
 };
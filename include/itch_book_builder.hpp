@@ -0,0 +1,75 @@
+#pragma once
+
+#include "itch_parser.hpp"
+#include "enhanced_order_book.hpp"
+#include "market_event.hpp"
+#include <vector>
+#include <memory>
+#include <functional>
+#include <array>
+
+class BookSnapshotter;
+
+class ItchBookBuilder {
+public:
+    using ExecutionCallback = std::function<void(uint16_t, int64_t, uint64_t, uint64_t)>;
+    
+    static constexpr size_t MAX_LOCATES = 65536;
+    
+    struct Stats {
+        uint64_t messages;
+        uint64_t unknown_locate;
+        uint64_t unknown_order;
+        
+        Stats() : messages(0), unknown_locate(0), unknown_order(0) {}
+    };
+
+private:
+    std::vector<std::unique_ptr<EnhancedOrderBook>> books_;
+    std::vector<uint16_t> active_locates_;
+    std::vector<std::array<char, 4>> watched_mpids_;
+    ExecutionCallback execution_callback_;
+    BookSnapshotter* snapshotter_;
+    MemoryProvider* provider_;
+    Stats stats_;
+    
+    BookUpdate apply(const itch::SystemEvent& msg);
+    BookUpdate apply(const itch::StockDirectory& msg);
+    BookUpdate apply(const itch::AddOrder& msg);
+    BookUpdate apply(const itch::AddOrderMPID& msg);
+    BookUpdate apply(const itch::OrderExecuted& msg);
+    BookUpdate apply(const itch::OrderExecutedWithPrice& msg);
+    BookUpdate apply(const itch::OrderCancel& msg);
+    BookUpdate apply(const itch::OrderDelete& msg);
+    BookUpdate apply(const itch::OrderReplace& msg);
+    BookUpdate apply(const itch::Trade& msg);
+    
+    EnhancedOrderBook* find_book(uint16_t stock_locate);
+    EnhancedOrderBook& create_book(uint16_t stock_locate, const char* stock);
+
+public:
+    // Books created by the builder draw their nodes from provider, if given.
+    explicit ItchBookBuilder(MemoryProvider* provider = nullptr);
+    
+    BookUpdate process(const itch::Message& msg);
+    BookUpdate process(const MarketEvent& event);
+    size_t process_buffer(const uint8_t* data, size_t size);
+    
+    void set_execution_callback(ExecutionCallback callback);
+    void watch_mpid(const char* mpid);
+    void set_snapshotter(BookSnapshotter* snapshotter) { snapshotter_ = snapshotter; }
+    
+    EnhancedOrderBook* book(uint16_t stock_locate) { return books_[stock_locate].get(); }
+    const EnhancedOrderBook* book(uint16_t stock_locate) const { return books_[stock_locate].get(); }
+    
+    std::unique_ptr<EnhancedOrderBook> release_book(uint16_t stock_locate);
+    void adopt_book(uint16_t stock_locate, std::unique_ptr<EnhancedOrderBook> book);
+    EnhancedOrderBook& restore_book(uint16_t stock_locate, SymbolId symbol, const BookCounters& counters,
+                                    const Order* orders, size_t count);
+    
+    const std::vector<uint16_t>& locates() const { return active_locates_; }
+    size_t book_count() const { return active_locates_.size(); }
+    const Stats& stats() const { return stats_; }
+    
+    void clear();
+};
@@ -1,10 +1,15 @@
 #pragma once
 
+#include "memory_provider.hpp"
+#include <algorithm>
 #include <atomic>
 #include <optional>
 #include <memory>
 #include <new>
 #include <cstdlib>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
 
 #ifdef _WIN32
 #include <malloc.h>
@@ -15,99 +20,201 @@
 #define aligned_free_compat(ptr) free(ptr)
 #endif
 
-template<typename T>
-class SPSCQueue {
-    struct alignas(64) Node {
-        std::atomic<uint64_t> sequence;
-        T data;
+// Lamport ring with cached indices: each side re-reads the other's index only
+// when its cached copy says the ring is full (or empty), so in steady state
+// a push or pop touches no cache line the other thread is writing. Besides
+// the copying try_push/try_pop there are batch versions and in-place
+// claim()/commit() and peek()/release() for producers and consumers that
+// want to build or read a message directly in its slot.
+//
+// Padded gives every slot its own cache line, so the producer filling slot
+// i+1 never disturbs the consumer reading slot i. Unpadded slots are stored
+// back to back: a 4096-entry ring of 8-byte items takes 32 KB instead of
+// 256 KB and a cache line carries several messages, at the cost of sharing
+// that line while both sides work on it.
+template<typename T, bool Padded>
+class BasicSPSCQueue {
+    struct alignas(Padded ? 64 : alignof(T)) Node {
+        alignas(T) unsigned char storage[sizeof(T)];
     };
-
+    
     static constexpr size_t CACHE_LINE = 64;
     
     alignas(CACHE_LINE) std::atomic<uint64_t> head_{0};
+    uint64_t tail_cache_{0};
+    bool claimed_{false};
+    
     alignas(CACHE_LINE) std::atomic<uint64_t> tail_{0};
+    uint64_t head_cache_{0};
+    
     alignas(CACHE_LINE) size_t capacity_;
     alignas(CACHE_LINE) Node* buffer_;
     
     size_t mask_;
-
+    MemoryProvider* provider_;
+    
+    T* slot(uint64_t index) const {
+        return std::launder(reinterpret_cast<T*>(buffer_[index & mask_].storage));
+    }
+    
+    size_t writable(uint64_t head, size_t wanted) {
+        size_t free = mask_ - static_cast<size_t>(head - tail_cache_);
+        if (free < wanted) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            free = mask_ - static_cast<size_t>(head - tail_cache_);
+        }
+        return free;
+    }
+    
+    size_t readable(uint64_t tail, size_t wanted) {
+        size_t available = static_cast<size_t>(head_cache_ - tail);
+        if (available < wanted) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            available = static_cast<size_t>(head_cache_ - tail);
+        }
+        return available;
+    }
+    
 public:
-    explicit SPSCQueue(size_t capacity) 
+    // The ring comes from the provider when one is given; it must outlive the queue.
+    explicit BasicSPSCQueue(size_t capacity, MemoryProvider* provider = nullptr)
         : capacity_(capacity)
-        , mask_(capacity - 1) {
+        , mask_(capacity - 1)
+        , provider_(provider) {
         
-        if ((capacity & (capacity - 1)) != 0) {
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
             throw std::invalid_argument("capacity must be power of 2");
         }
         
+        // aligned_alloc wants a multiple of the alignment; dense slots may not be.
+        size_t bytes = (sizeof(Node) * capacity + CACHE_LINE - 1) & ~(CACHE_LINE - 1);
         buffer_ = static_cast<Node*>(
-            aligned_alloc_compat(CACHE_LINE, sizeof(Node) * capacity)
+            provider_ ? provider_->allocate(bytes, CACHE_LINE)
+                      : aligned_alloc_compat(CACHE_LINE, bytes)
         );
-        
-        for (size_t i = 0; i < capacity; ++i) {
-            new (&buffer_[i]) Node();
-            buffer_[i].sequence.store(i, std::memory_order_relaxed);
+        if (!buffer_) {
+            throw std::bad_alloc();
         }
     }
     
-    ~SPSCQueue() {
-        for (size_t i = 0; i < capacity_; ++i) {
-            buffer_[i].~Node();
+    ~BasicSPSCQueue() {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        for (uint64_t i = tail_.load(std::memory_order_relaxed); i != head; ++i) {
+            slot(i)->~T();
+        }
+        if (claimed_) {
+            slot(head)->~T();
+        }
+        if (!provider_) {
+            aligned_free_compat(buffer_);
         }
-        aligned_free_compat(buffer_);
     }
     
-    SPSCQueue(const SPSCQueue&) = delete;
-    SPSCQueue& operator=(const SPSCQueue&) = delete;
+    BasicSPSCQueue(const BasicSPSCQueue&) = delete;
+    BasicSPSCQueue& operator=(const BasicSPSCQueue&) = delete;
     
     bool try_push(const T& item) {
         uint64_t head = head_.load(std::memory_order_relaxed);
-        Node* node = &buffer_[head & mask_];
-        uint64_t seq = node->sequence.load(std::memory_order_acquire);
-        
-        if (seq != head) {
+        if (writable(head, 1) == 0) {
             return false;
         }
         
-        node->data = item;
-        node->sequence.store(head + 1, std::memory_order_release);
-        head_.store(head + 1, std::memory_order_relaxed);
-        
+        new (buffer_[head & mask_].storage) T(item);
+        head_.store(head + 1, std::memory_order_release);
         return true;
     }
     
     bool try_push(T&& item) {
         uint64_t head = head_.load(std::memory_order_relaxed);
-        Node* node = &buffer_[head & mask_];
-        uint64_t seq = node->sequence.load(std::memory_order_acquire);
-        
-        if (seq != head) {
+        if (writable(head, 1) == 0) {
             return false;
         }
         
-        node->data = std::move(item);
-        node->sequence.store(head + 1, std::memory_order_release);
-        head_.store(head + 1, std::memory_order_relaxed);
-        
+        new (buffer_[head & mask_].storage) T(std::move(item));
+        head_.store(head + 1, std::memory_order_release);
         return true;
     }
     
+    // Pushes as many of the items as fit and publishes them with one store.
+    size_t try_push_n(const T* items, size_t count) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        size_t n = std::min(count, writable(head, count));
+        
+        for (size_t i = 0; i < n; ++i) {
+            new (buffer_[(head + i) & mask_].storage) T(items[i]);
+        }
+        if (n > 0) {
+            head_.store(head + n, std::memory_order_release);
+        }
+        return n;
+    }
+    
     std::optional<T> try_pop() {
         uint64_t tail = tail_.load(std::memory_order_relaxed);
-        Node* node = &buffer_[tail & mask_];
-        uint64_t seq = node->sequence.load(std::memory_order_acquire);
-        
-        if (seq != tail + 1) {
+        if (readable(tail, 1) == 0) {
             return std::nullopt;
         }
         
-        T result = std::move(node->data);
-        node->sequence.store(tail + capacity_, std::memory_order_release);
-        tail_.store(tail + 1, std::memory_order_relaxed);
-        
+        T* item = slot(tail);
+        T result(std::move(*item));
+        item->~T();
+        tail_.store(tail + 1, std::memory_order_release);
         return result;
     }
     
+    size_t try_pop_n(T* out, size_t max) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        size_t n = std::min(max, readable(tail, max));
+        
+        for (size_t i = 0; i < n; ++i) {
+            T* item = slot(tail + i);
+            out[i] = std::move(*item);
+            item->~T();
+        }
+        if (n > 0) {
+            tail_.store(tail + n, std::memory_order_release);
+        }
+        return n;
+    }
+    
+    // Default-constructs the next slot in place and returns it, or nullptr if
+    // the ring is full. The consumer sees it after commit(). Repeated claims
+    // before a commit return the same slot; don't mix with try_push meanwhile.
+    T* claim() {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        if (!claimed_) {
+            if (writable(head, 1) == 0) {
+                return nullptr;
+            }
+            new (buffer_[head & mask_].storage) T();
+            claimed_ = true;
+        }
+        return slot(head);
+    }
+    
+    void commit() {
+        if (!claimed_) return;
+        
+        claimed_ = false;
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    
+    // Returns the oldest element in place, or nullptr if empty. It stays valid
+    // until release().
+    T* peek() {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (readable(tail, 1) == 0) {
+            return nullptr;
+        }
+        return slot(tail);
+    }
+    
+    void release() {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        slot(tail)->~T();
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+    
     size_t size() const {
         uint64_t head = head_.load(std::memory_order_acquire);
         uint64_t tail = tail_.load(std::memory_order_acquire);
@@ -117,8 +224,217 @@ public:
     bool empty() const {
         return size() == 0;
     }
+    
+    size_t capacity() const { return capacity_; }
+    size_t footprint() const { return sizeof(Node) * capacity_; }
+};
+
+template<typename T>
+using SPSCQueue = BasicSPSCQueue<T, true>;
+
+template<typename T>
+using CompactSPSCQueue = BasicSPSCQueue<T, false>;
+
+// Vyukov bounded queue: each slot carries a sequence number that says whose
+// turn it is, so producers (and, with MultiConsumer, consumers) claim a
+// position with one CAS and then hand the slot over with a single release
+// store. Nothing is allocated after construction. A full ring is reported
+// to the producer rather than grown: try_push() returns false so the caller
+// can drop, count or shed, while push() waits for room.
+//
+// With a single consumer the dequeue side needs no CAS; it is meant for
+// fanning several receive threads (A/B lines, channels) into one book thread.
+template<typename T, bool MultiConsumer>
+class BasicBoundedQueue {
+    struct Cell {
+        std::atomic<uint64_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+    
+    static constexpr size_t CACHE_LINE = 64;
+    static constexpr int SPINS_BEFORE_YIELD = 64;
+    
+    alignas(CACHE_LINE) std::atomic<uint64_t> enqueue_pos_{0};
+    alignas(CACHE_LINE) std::atomic<uint64_t> dequeue_pos_{0};
+    
+    alignas(CACHE_LINE) Cell* buffer_;
+    size_t capacity_;
+    size_t mask_;
+    MemoryProvider* provider_;
+    
+    static T* value(Cell& cell) {
+        return std::launder(reinterpret_cast<T*>(cell.storage));
+    }
+    
+    static void wait(int& spins) {
+        if (++spins > SPINS_BEFORE_YIELD) {
+            std::this_thread::yield();
+        }
+    }
+    
+    // Finds a cell the producer may fill, or nullptr if the ring is full.
+    Cell* acquire_enqueue(uint64_t& pos) {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = buffer_[pos & mask_];
+            uint64_t seq = cell.sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq - pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return &cell;
+                }
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    
+    Cell* acquire_dequeue(uint64_t& pos) {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = buffer_[pos & mask_];
+            uint64_t seq = cell.sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if constexpr (MultiConsumer) {
+                    if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        return &cell;
+                    }
+                } else {
+                    dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+                    return &cell;
+                }
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+    
+    template<typename U>
+    bool emplace(U&& item) {
+        uint64_t pos;
+        Cell* cell = acquire_enqueue(pos);
+        if (!cell) {
+            return false;
+        }
+        new (cell->storage) T(std::forward<U>(item));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    
+public:
+    // The ring comes from the provider when one is given; it must outlive the queue.
+    explicit BasicBoundedQueue(size_t capacity, MemoryProvider* provider = nullptr)
+        : capacity_(capacity)
+        , mask_(capacity - 1)
+        , provider_(provider) {
+        
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("capacity must be power of 2");
+        }
+        
+        size_t bytes = (sizeof(Cell) * capacity + CACHE_LINE - 1) & ~(CACHE_LINE - 1);
+        buffer_ = static_cast<Cell*>(
+            provider_ ? provider_->allocate(bytes, CACHE_LINE)
+                      : aligned_alloc_compat(CACHE_LINE, bytes)
+        );
+        if (!buffer_) {
+            throw std::bad_alloc();
+        }
+        for (size_t i = 0; i < capacity; ++i) {
+            new (&buffer_[i].sequence) std::atomic<uint64_t>(i);
+        }
+    }
+    
+    ~BasicBoundedQueue() {
+        while (try_pop()) {}
+        if (!provider_) {
+            aligned_free_compat(buffer_);
+        }
+    }
+    
+    BasicBoundedQueue(const BasicBoundedQueue&) = delete;
+    BasicBoundedQueue& operator=(const BasicBoundedQueue&) = delete;
+    
+    bool try_push(const T& item) { return emplace(item); }
+    bool try_push(T&& item) { return emplace(std::move(item)); }
+    
+    // Spins briefly, then yields, until there is room.
+    void push(const T& item) {
+        for (int spins = 0; !emplace(item); ) {
+            wait(spins);
+        }
+    }
+    
+    void push(T&& item) {
+        for (int spins = 0; !emplace(std::move(item)); ) {
+            wait(spins);
+        }
+    }
+    
+    std::optional<T> try_pop() {
+        uint64_t pos;
+        Cell* cell = acquire_dequeue(pos);
+        if (!cell) {
+            return std::nullopt;
+        }
+        T* item = value(*cell);
+        T result(std::move(*item));
+        item->~T();
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return result;
+    }
+    
+    T pop() {
+        for (int spins = 0; ; wait(spins)) {
+            if (auto item = try_pop()) {
+                return std::move(*item);
+            }
+        }
+    }
+    
+    // Drains up to max elements; with a single consumer this is just a loop
+    // of uncontended pops.
+    size_t try_pop_n(T* out, size_t max) {
+        size_t n = 0;
+        while (n < max) {
+            uint64_t pos;
+            Cell* cell = acquire_dequeue(pos);
+            if (!cell) break;
+            
+            T* item = value(*cell);
+            out[n++] = std::move(*item);
+            item->~T();
+            cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        }
+        return n;
+    }
+    
+    // Approximate while producers or consumers are active.
+    size_t size() const {
+        uint64_t head = enqueue_pos_.load(std::memory_order_acquire);
+        uint64_t tail = dequeue_pos_.load(std::memory_order_acquire);
+        return head > tail ? static_cast<size_t>(head - tail) : 0;
+    }
+    
+    bool empty() const {
+        return size() == 0;
+    }
+    
+    size_t capacity() const { return capacity_; }
 };
 
+template<typename T>
+using BoundedMPMCQueue = BasicBoundedQueue<T, true>;
+
+template<typename T>
+using BoundedMPSCQueue = BasicBoundedQueue<T, false>;
+
+// Unbounded, allocates a node per push. Prefer BoundedMPSCQueue on hot paths.
 template<typename T>
 class MPSCQueue {
     struct alignas(64) Node {
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "itch_parser.hpp"
+#include "iex_parser.hpp"
+#include "symbol.hpp"
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+enum class EventType : uint8_t {
+    None = 0,
+    SystemEvent,
+    SymbolDirectory,
+    AddOrder,
+    OrderExecuted,
+    OrderCancel,
+    OrderDelete,
+    OrderReplace,
+    Trade,
+    Quote,
+    PriceLevel
+};
+
+enum EventVenue : uint8_t {
+    VENUE_NASDAQ = 0,
+    VENUE_IEX = 1
+};
+
+enum EventFlags : uint8_t {
+    EVENT_PRICED = 1 << 0,
+    EVENT_PRINTABLE = 1 << 1,
+    EVENT_ATTRIBUTED = 1 << 2
+};
+
+// Protocol-neutral event, one cache line. Prices use the shared 4-decimal
+// scale. ITCH events are keyed by stock_locate and carry the directory symbol;
+// IEX events carry the symbol and stock_locate 0. The unions hold fields only
+// one event type uses; system events put their event code in side.
+struct alignas(64) MarketEvent {
+    SymbolId symbol;
+    uint64_t order_ref;
+    union {
+        uint64_t new_order_ref;
+        uint64_t match_number;
+        int64_t ask_price;
+    };
+    int64_t price;
+    uint64_t exchange_timestamp;
+    uint64_t receive_timestamp;
+    uint32_t quantity;
+    union {
+        uint32_t ask_quantity;
+        char attribution[4];
+    };
+    uint16_t stock_locate;
+    uint8_t venue;
+    EventType type;
+    char side;
+    uint8_t flags;
+    
+    MarketEvent() : order_ref(0), new_order_ref(0), price(0), exchange_timestamp(0), receive_timestamp(0)
+                  , quantity(0), ask_quantity(0), stock_locate(0), venue(0), type(EventType::None)
+                  , side(0), flags(0) {}
+};
+
+static_assert(sizeof(MarketEvent) == 64, "MarketEvent must fill exactly one cache line");
+static_assert(std::is_trivially_copyable<MarketEvent>::value, "MarketEvent is copied into rings");
+
+// Both adapters fill a caller-owned event and never allocate per message.
+// publish() pulls messages from a parser and pushes normalized events into
+// any ring with try_push, yielding while the ring is full, and stops at a
+// truncated message.
+class ItchEventAdapter {
+    std::vector<SymbolId> symbols_;
+    uint8_t venue_;
+
+public:
+    explicit ItchEventAdapter(uint8_t venue = VENUE_NASDAQ);
+    
+    bool normalize(const itch::Message& msg, uint64_t receive_timestamp, MarketEvent& out);
+    
+    template<typename Ring>
+    size_t publish(itch::Parser& parser, Ring& ring, uint64_t receive_timestamp, size_t max_events = SIZE_MAX) {
+        MarketEvent event;
+        size_t published = 0;
+        while (published < max_events && parser.has_more()) {
+            size_t position = parser.position();
+            auto msg = parser.parse_next();
+            if (!msg) {
+                if (parser.position() == position) break;
+                continue;
+            }
+            if (!normalize(*msg, receive_timestamp, event)) continue;
+            
+            while (!ring.try_push(event)) {
+                std::this_thread::yield();
+            }
+            published++;
+        }
+        return published;
+    }
+    
+    SymbolId symbol(uint16_t stock_locate) const { return symbols_[stock_locate]; }
+};
+
+class IexEventAdapter {
+    uint8_t venue_;
+
+public:
+    explicit IexEventAdapter(uint8_t venue = VENUE_IEX) : venue_(venue) {}
+    
+    bool normalize(const iex::Message& msg, uint64_t receive_timestamp, MarketEvent& out) const;
+    
+    template<typename Ring>
+    size_t publish(iex::Parser& parser, Ring& ring, uint64_t receive_timestamp, size_t max_events = SIZE_MAX) {
+        MarketEvent event;
+        size_t published = 0;
+        while (published < max_events && parser.has_more()) {
+            size_t position = parser.position();
+            auto msg = parser.parse_next();
+            if (!msg) {
+                if (parser.position() == position) break;
+                continue;
+            }
+            if (!normalize(*msg, receive_timestamp, event)) continue;
+            
+            while (!ring.try_push(event)) {
+                std::this_thread::yield();
+            }
+            published++;
+        }
+        return published;
+    }
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "memory_provider.hpp"
+#include <atomic>
 #include <cstddef>
 #include <cstdlib>
 #include <vector>
@@ -26,14 +28,19 @@ class MemoryPool {
         Chunk* next;
     };
     
+    MemoryProvider* provider_;
     Chunk* chunks_;
     Slot* free_list_;
     size_t allocated_count_;
     
     void allocate_chunk() {
         Chunk* chunk = static_cast<Chunk*>(
-            aligned_alloc_compat(64, sizeof(Chunk))
+            provider_ ? provider_->allocate(sizeof(Chunk), alignof(Chunk))
+                      : aligned_alloc_compat(64, sizeof(Chunk))
         );
+        if (!chunk) {
+            throw std::bad_alloc();
+        }
         
         chunk->next = chunks_;
         chunks_ = chunk;
@@ -44,14 +51,16 @@ class MemoryPool {
         chunk->slots[ChunkSize - 1].next = free_list_;
         free_list_ = &chunk->slots[0];
     }
-    
+
 public:
-    MemoryPool() : chunks_(nullptr), free_list_(nullptr), allocated_count_(0) {
+    // Chunks come from the provider when one is given; it must outlive the pool.
+    explicit MemoryPool(MemoryProvider* provider = nullptr)
+        : provider_(provider), chunks_(nullptr), free_list_(nullptr), allocated_count_(0) {
         allocate_chunk();
     }
     
     ~MemoryPool() {
-        while (chunks_) {
+        while (chunks_ && !provider_) {
             Chunk* next = chunks_->next;
             aligned_free_compat(chunks_);
             chunks_ = next;
@@ -87,3 +96,173 @@ public:
     
     size_t allocated() const { return allocated_count_; }
 };
+
+// MemoryPool variant whose objects may be released on a thread other than the
+// one that allocates them. allocate() and deallocate() belong to the owning
+// thread and touch only its private free list. Other threads return objects
+// through a lock-free remote list, ideally via a Magazine that caches frees
+// and hands them back in one CAS per batch. The owner takes the whole remote
+// list with a single exchange when its own list runs dry, so pooled messages
+// can cross SPSCQueue/MPSCQueue by pointer without copies or ABA hazards.
+template<typename T, size_t ChunkSize = 4096>
+class ConcurrentMemoryPool {
+    union Slot {
+        T element;
+        Slot* next;
+    };
+    
+    struct alignas(64) Chunk {
+        Slot slots[ChunkSize];
+        Chunk* next;
+    };
+    
+    static constexpr size_t CACHE_LINE = 64;
+    
+    MemoryProvider* provider_;
+    Chunk* chunks_;
+    Slot* free_list_;
+    size_t allocated_count_;
+    size_t chunk_count_;
+    
+    alignas(CACHE_LINE) std::atomic<Slot*> remote_list_;
+    std::atomic<size_t> remote_freed_;
+    
+    void allocate_chunk() {
+        Chunk* chunk = static_cast<Chunk*>(
+            provider_ ? provider_->allocate(sizeof(Chunk), alignof(Chunk))
+                      : aligned_alloc_compat(64, sizeof(Chunk))
+        );
+        if (!chunk) {
+            throw std::bad_alloc();
+        }
+        
+        chunk->next = chunks_;
+        chunks_ = chunk;
+        ++chunk_count_;
+        
+        for (size_t i = 0; i < ChunkSize - 1; ++i) {
+            chunk->slots[i].next = &chunk->slots[i + 1];
+        }
+        chunk->slots[ChunkSize - 1].next = free_list_;
+        free_list_ = &chunk->slots[0];
+    }
+    
+    void push_remote(Slot* first, Slot* last, size_t count) {
+        Slot* head = remote_list_.load(std::memory_order_relaxed);
+        do {
+            last->next = head;
+        } while (!remote_list_.compare_exchange_weak(head, first,
+                                                     std::memory_order_release,
+                                                     std::memory_order_relaxed));
+        remote_freed_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+public:
+    // Per-thread cache of remote frees. Not thread-safe; give each releasing
+    // thread its own and let the destructor flush whatever is left.
+    class Magazine {
+        ConcurrentMemoryPool* pool_;
+        Slot* first_;
+        Slot* last_;
+        size_t count_;
+        size_t capacity_;
+    
+    public:
+        explicit Magazine(ConcurrentMemoryPool& pool, size_t capacity = 64)
+            : pool_(&pool), first_(nullptr), last_(nullptr), count_(0), capacity_(capacity) {}
+        
+        ~Magazine() { flush(); }
+        
+        Magazine(const Magazine&) = delete;
+        Magazine& operator=(const Magazine&) = delete;
+        
+        void deallocate(T* ptr) {
+            if (!ptr) return;
+            
+            ptr->~T();
+            
+            Slot* slot = reinterpret_cast<Slot*>(ptr);
+            slot->next = first_;
+            first_ = slot;
+            if (!last_) {
+                last_ = slot;
+            }
+            if (++count_ >= capacity_) {
+                flush();
+            }
+        }
+        
+        void flush() {
+            if (count_ == 0) return;
+            
+            pool_->push_remote(first_, last_, count_);
+            first_ = nullptr;
+            last_ = nullptr;
+            count_ = 0;
+        }
+        
+        size_t size() const { return count_; }
+    };
+    
+    explicit ConcurrentMemoryPool(MemoryProvider* provider = nullptr)
+        : provider_(provider), chunks_(nullptr), free_list_(nullptr), allocated_count_(0), chunk_count_(0)
+        , remote_list_(nullptr), remote_freed_(0) {
+        allocate_chunk();
+    }
+    
+    ~ConcurrentMemoryPool() {
+        while (chunks_ && !provider_) {
+            Chunk* next = chunks_->next;
+            aligned_free_compat(chunks_);
+            chunks_ = next;
+        }
+    }
+    
+    ConcurrentMemoryPool(const ConcurrentMemoryPool&) = delete;
+    ConcurrentMemoryPool& operator=(const ConcurrentMemoryPool&) = delete;
+    
+    template<typename... Args>
+    T* allocate(Args&&... args) {
+        if (!free_list_) {
+            free_list_ = remote_list_.exchange(nullptr, std::memory_order_acquire);
+            if (!free_list_) {
+                allocate_chunk();
+            }
+        }
+        
+        Slot* slot = free_list_;
+        free_list_ = slot->next;
+        ++allocated_count_;
+        
+        return new (&slot->element) T(std::forward<Args>(args)...);
+    }
+    
+    void deallocate(T* ptr) {
+        if (!ptr) return;
+        
+        ptr->~T();
+        
+        Slot* slot = reinterpret_cast<Slot*>(ptr);
+        slot->next = free_list_;
+        free_list_ = slot;
+        --allocated_count_;
+    }
+    
+    // Safe from any thread; prefer a Magazine on hot paths.
+    void deallocate_remote(T* ptr) {
+        if (!ptr) return;
+        
+        ptr->~T();
+        
+        Slot* slot = reinterpret_cast<Slot*>(ptr);
+        push_remote(slot, slot, 1);
+    }
+    
+    // Exact once the releasing threads have flushed; may briefly overstate
+    // while a remote batch is in flight.
+    size_t allocated() const {
+        return allocated_count_ - remote_freed_.load(std::memory_order_relaxed);
+    }
+    
+    size_t chunk_count() const { return chunk_count_; }
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Startup-provisioned memory for pools, rings and book stores. Regions are
+// mapped up front, optionally on 2 MB huge pages (falling back to a THP hint),
+// bound to one NUMA node, prefaulted and locked, so the hot path never takes
+// a page fault. allocate() carves aligned blocks out of the current region;
+// nothing is returned until the provider is destroyed, so it must outlive
+// every pool and queue that draws from it.
+class MemoryProvider {
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    
+    struct Config {
+        size_t region_size;
+        bool huge_pages;
+        int numa_node;
+        bool prefault;
+        bool lock;
+        
+        Config() : region_size(HUGE_PAGE_SIZE * 16), huge_pages(true), numa_node(-1), prefault(true), lock(false) {}
+    };
+    
+    struct Stats {
+        size_t regions;
+        size_t mapped_bytes;
+        size_t huge_page_bytes;
+        size_t transparent_huge_bytes;
+        size_t numa_bound_bytes;
+        size_t locked_bytes;
+        size_t used_bytes;
+    };
+
+private:
+    struct Region {
+        void* base;
+        size_t size;
+        bool huge;
+    };
+    
+    Config config_;
+    std::vector<Region> regions_;
+    Stats stats_;
+    
+    uint8_t* cursor_;
+    uint8_t* limit_;
+    
+    mutable std::mutex mutex_;
+    
+    bool map_region(size_t bytes);
+    static void unmap(const Region& region);
+
+public:
+    explicit MemoryProvider(const Config& config = Config());
+    ~MemoryProvider();
+    
+    MemoryProvider(const MemoryProvider&) = delete;
+    MemoryProvider& operator=(const MemoryProvider&) = delete;
+    
+    // Returns nullptr if the OS refuses the mapping. Thread-safe, but meant
+    // for setup and pool growth, not per-message use.
+    void* allocate(size_t bytes, size_t alignment = 64);
+    
+    const Config& config() const { return config_; }
+    Stats stats() const;
+    
+    // NUMA node owning the given CPU, or -1 when unknown.
+    static int node_of_cpu(int cpu);
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "order_book.hpp"
+#include "iex_parser.hpp"
+#include <array>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+struct VenueQuote {
+    int64_t bid_price;
+    uint64_t bid_size;
+    int64_t ask_price;
+    uint64_t ask_size;
+    uint64_t timestamp;
+    
+    VenueQuote() : bid_price(0), bid_size(0), ask_price(0), ask_size(0), timestamp(0) {}
+};
+
+// Sizes are aggregated across every venue quoting at the best price; the
+// venue masks say which ones. venue and source_timestamp attribute the update
+// that produced this state.
+struct Nbbo {
+    int64_t bid_price;
+    uint64_t bid_size;
+    int64_t ask_price;
+    uint64_t ask_size;
+    uint32_t bid_venues;
+    uint32_t ask_venues;
+    uint64_t source_timestamp;
+    uint8_t venue;
+    uint8_t changes;
+    
+    Nbbo() : bid_price(0), bid_size(0), ask_price(0), ask_size(0), bid_venues(0), ask_venues(0)
+           , source_timestamp(0), venue(0), changes(BOOK_UNCHANGED) {}
+    
+    bool crossed() const { return bid_size > 0 && ask_size > 0 && bid_price >= ask_price; }
+    bool locked() const { return bid_size > 0 && ask_size > 0 && bid_price == ask_price; }
+};
+
+class NbboEngine {
+public:
+    static constexpr size_t MAX_VENUES = 32;
+    
+    using NbboCallback = std::function<void(uint32_t, SymbolId, const Nbbo&)>;
+    
+    struct Stats {
+        uint64_t updates;
+        uint64_t nbbo_changes;
+        uint64_t rescans;
+    };
+
+private:
+    struct Consolidated {
+        SymbolId symbol;
+        Nbbo nbbo;
+        std::array<VenueQuote, MAX_VENUES> venues;
+    };
+    
+    std::vector<Consolidated> symbols_;
+    std::unordered_map<SymbolId, uint32_t> index_;
+    NbboCallback nbbo_callback_;
+    Stats stats_;
+    
+    uint8_t update_bid(Consolidated& entry, uint8_t venue, uint64_t old_size);
+    uint8_t update_ask(Consolidated& entry, uint8_t venue, uint64_t old_size);
+    void rescan_bid(Consolidated& entry);
+    void rescan_ask(Consolidated& entry);
+
+public:
+    NbboEngine();
+    
+    uint32_t symbol_index(SymbolId symbol);
+    SymbolId symbol(uint32_t index) const { return symbols_[index].symbol; }
+    size_t symbol_count() const { return symbols_.size(); }
+    
+    uint8_t update(uint8_t venue, uint32_t index, const VenueQuote& quote);
+    uint8_t update(uint8_t venue, uint32_t index, const TopOfBook& top);
+    uint8_t on_quote(uint8_t venue, const iex::QuoteUpdate& quote);
+    uint8_t clear_venue(uint8_t venue, uint32_t index, uint64_t timestamp);
+    
+    void set_nbbo_callback(NbboCallback callback);
+    
+    const Nbbo& nbbo(uint32_t index) const { return symbols_[index].nbbo; }
+    const VenueQuote& venue_quote(uint8_t venue, uint32_t index) const { return symbols_[index].venues[venue]; }
+    const Stats& stats() const { return stats_; }
+};
@@ -1,6 +1,10 @@
 #pragma once
 
+#include "symbol.hpp"
+#include "seqlock.hpp"
+#include "pool_allocator.hpp"
 #include <map>
+#include <deque>
 #include <string>
 #include <cstdint>
 #include <optional>
@@ -15,8 +19,41 @@ struct PriceLevel {
     PriceLevel(int64_t p, uint64_t s) : price(p), size(s), order_count(1) {}
 };
 
+using LevelAllocator = PoolAllocator<std::pair<const int64_t, PriceLevel>>;
+
+template<typename Compare>
+using LevelMap = std::map<int64_t, PriceLevel, Compare, LevelAllocator>;
+
+enum BookChange : uint8_t {
+    BOOK_UNCHANGED = 0,
+    BBO_PRICE_CHANGED = 1 << 0,
+    BBO_SIZE_CHANGED = 1 << 1,
+    DEPTH_CHANGED = 1 << 2
+};
+
+struct BookUpdate {
+    bool applied;
+    uint8_t changes;
+    
+    BookUpdate() : applied(false), changes(BOOK_UNCHANGED) {}
+    BookUpdate(bool a, uint8_t c) : applied(a), changes(c) {}
+    
+    explicit operator bool() const { return applied; }
+    bool top_changed() const { return (changes & (BBO_PRICE_CHANGED | BBO_SIZE_CHANGED)) != 0; }
+};
+
+struct TopOfBook {
+    int64_t bid_price;
+    uint64_t bid_size;
+    int64_t ask_price;
+    uint64_t ask_size;
+    uint64_t timestamp;
+    
+    TopOfBook() : bid_price(0), bid_size(0), ask_price(0), ask_size(0), timestamp(0) {}
+};
+
 struct OrderBookSnapshot {
-    std::string symbol;
+    SymbolId symbol;
     uint64_t timestamp;
     int64_t best_bid;
     uint64_t best_bid_size;
@@ -29,25 +66,38 @@ struct OrderBookSnapshot {
 };
 
 class OrderBook {
-    std::string symbol_;
-    std::map<int64_t, PriceLevel, std::greater<int64_t>> bids_;
-    std::map<int64_t, PriceLevel, std::less<int64_t>> asks_;
+    SymbolId symbol_;
+    PoolResource node_pool_;
+    LevelMap<std::greater<int64_t>> bids_;
+    LevelMap<std::less<int64_t>> asks_;
     
     uint64_t last_update_time_;
     uint64_t message_count_;
     
+    TopOfBook top_;
+    mutable OrderBookSnapshot snapshot_;
+    mutable bool snapshot_dirty_;
+    
+    Seqlock<TopOfBook> published_top_;
+    
+    void touch(uint64_t timestamp);
+    uint8_t bid_changed(int64_t price, uint64_t timestamp);
+    uint8_t ask_changed(int64_t price, uint64_t timestamp);
+    
 public:
-    explicit OrderBook(const std::string& symbol);
+    // Level nodes come from provider when one is given, else from the heap.
+    explicit OrderBook(SymbolId symbol, MemoryProvider* provider = nullptr);
+    explicit OrderBook(const std::string& symbol, MemoryProvider* provider = nullptr);
     
-    void add_bid(int64_t price, uint64_t size, uint64_t timestamp);
-    void add_ask(int64_t price, uint64_t size, uint64_t timestamp);
-    void modify_bid(int64_t price, uint64_t size, uint64_t timestamp);
-    void modify_ask(int64_t price, uint64_t size, uint64_t timestamp);
-    void remove_bid(int64_t price, uint64_t timestamp);
-    void remove_ask(int64_t price, uint64_t timestamp);
+    uint8_t add_bid(int64_t price, uint64_t size, uint64_t timestamp);
+    uint8_t add_ask(int64_t price, uint64_t size, uint64_t timestamp);
+    uint8_t modify_bid(int64_t price, uint64_t size, uint64_t timestamp);
+    uint8_t modify_ask(int64_t price, uint64_t size, uint64_t timestamp);
+    uint8_t remove_bid(int64_t price, uint64_t timestamp);
+    uint8_t remove_ask(int64_t price, uint64_t timestamp);
     
-    void execute_bid(int64_t price, uint64_t size, uint64_t timestamp);
-    void execute_ask(int64_t price, uint64_t size, uint64_t timestamp);
+    uint8_t execute_bid(int64_t price, uint64_t size, uint64_t timestamp);
+    uint8_t execute_ask(int64_t price, uint64_t size, uint64_t timestamp);
     
     std::optional<int64_t> best_bid() const;
     std::optional<int64_t> best_ask() const;
@@ -57,9 +107,11 @@ public:
     double spread() const;
     double imbalance() const;
     
-    OrderBookSnapshot snapshot() const;
+    const TopOfBook& top() const { return top_; }
+    const OrderBookSnapshot& snapshot() const;
+    const Seqlock<TopOfBook>& published_top() const { return published_top_; }
     
-    const std::string& symbol() const { return symbol_; }
+    SymbolId symbol() const { return symbol_; }
     uint64_t message_count() const { return message_count_; }
     
     size_t bid_levels() const { return bids_.size(); }
@@ -69,9 +121,21 @@ public:
 };
 
 class OrderBookManager {
-    std::map<std::string, OrderBook> books_;
+    SymbolTable table_;
+    std::deque<OrderBook> books_;
     
 public:
+    OrderBookManager() = default;
+    explicit OrderBookManager(const PerfectHashIndex& universe);
+    
+    OrderBook& get_or_create(SymbolId symbol);
+    OrderBook* get(SymbolId symbol);
+    const OrderBook* get(SymbolId symbol) const;
+    
+    OrderBook& at(uint32_t index) { return books_[index]; }
+    const OrderBook& at(uint32_t index) const { return books_[index]; }
+    uint32_t index_of(SymbolId symbol) const { return table_.find(symbol); }
+    
     OrderBook& get_or_create(const std::string& symbol);
     OrderBook* get(const std::string& symbol);
     const OrderBook* get(const std::string& symbol) const;
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "memory_pool.hpp"
+#include <cstddef>
+#include <new>
+#include <vector>
+
+template<size_t Size, size_t Align>
+struct alignas(Align) NodeStorage {
+    unsigned char bytes[Size];
+};
+
+// Owns one MemoryPool per node size, created the first time a container
+// allocates a node of that size. Each book owns its resource, so a book that
+// migrates between threads carries its nodes with it and no pool is ever
+// shared across threads. Not thread-safe.
+class PoolResource {
+public:
+    static constexpr size_t NODES_PER_CHUNK = 64;
+    
+    template<size_t Size, size_t Align>
+    using Pool = MemoryPool<NodeStorage<Size, Align>, NODES_PER_CHUNK>;
+
+private:
+    struct Entry {
+        size_t size;
+        size_t align;
+        void* pool;
+        void (*destroy)(void*);
+        size_t (*allocated)(const void*);
+    };
+    
+    MemoryProvider* provider_;
+    std::vector<Entry> pools_;
+
+public:
+    explicit PoolResource(MemoryProvider* provider = nullptr) : provider_(provider) {}
+    
+    ~PoolResource() {
+        for (const Entry& entry : pools_) {
+            entry.destroy(entry.pool);
+        }
+    }
+    
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+    
+    template<size_t Size, size_t Align>
+    Pool<Size, Align>& pool() {
+        for (const Entry& entry : pools_) {
+            if (entry.size == Size && entry.align == Align) {
+                return *static_cast<Pool<Size, Align>*>(entry.pool);
+            }
+        }
+        
+        auto* pool = new Pool<Size, Align>(provider_);
+        pools_.push_back(Entry{Size, Align, pool,
+                               [](void* p) { delete static_cast<Pool<Size, Align>*>(p); },
+                               [](const void* p) { return static_cast<const Pool<Size, Align>*>(p)->allocated(); }});
+        return *pool;
+    }
+    
+    size_t pool_count() const { return pools_.size(); }
+    
+    size_t allocated() const {
+        size_t total = 0;
+        for (const Entry& entry : pools_) {
+            total += entry.allocated(entry.pool);
+        }
+        return total;
+    }
+};
+
+// Standard allocator over a PoolResource. Single-object requests, which is
+// every node a map, set or list allocates, come from the pool for sizeof(T)
+// after rebinding; array requests such as hash bucket tables go to operator
+// new. The pool is looked up on first use, so the value_type allocator a
+// container is constructed with never creates a pool of its own.
+template<typename T>
+class PoolAllocator {
+    using Storage = NodeStorage<sizeof(T), alignof(T)>;
+    using Pool = PoolResource::Pool<sizeof(T), alignof(T)>;
+    
+    template<typename U>
+    friend class PoolAllocator;
+    
+    PoolResource* resource_;
+    Pool* pool_;
+
+public:
+    using value_type = T;
+    
+    explicit PoolAllocator(PoolResource* resource) : resource_(resource), pool_(nullptr) {}
+    
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>& other) : resource_(other.resource_), pool_(nullptr) {}
+    
+    T* allocate(size_t n) {
+        if (n == 1 && resource_) {
+            if (!pool_) {
+                pool_ = &resource_->pool<sizeof(T), alignof(T)>();
+            }
+            return reinterpret_cast<T*>(pool_->allocate());
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    
+    void deallocate(T* ptr, size_t n) {
+        if (n == 1 && resource_) {
+            if (!pool_) {
+                pool_ = &resource_->pool<sizeof(T), alignof(T)>();
+            }
+            pool_->deallocate(reinterpret_cast<Storage*>(ptr));
+            return;
+        }
+        ::operator delete(ptr);
+    }
+    
+    PoolResource* resource() const { return resource_; }
+    
+    template<typename U>
+    bool operator==(const PoolAllocator<U>& other) const { return resource_ == other.resource_; }
+    
+    template<typename U>
+    bool operator!=(const PoolAllocator<U>& other) const { return resource_ != other.resource_; }
+};
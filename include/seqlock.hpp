@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-writer, multi-reader slot. The payload is stored as relaxed atomic
+// words so concurrent reads are well defined; the sequence tells a reader
+// whether the words it copied belong to one write.
+template<typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock payload must be trivially copyable");
+    
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    
+    alignas(64) std::atomic<uint64_t> sequence_;
+    std::atomic<uint64_t> words_[WORDS];
+    
+public:
+    Seqlock() : sequence_(0) {
+        for (auto& word : words_) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+    
+    explicit Seqlock(const T& value) : Seqlock() {
+        store(value);
+    }
+    
+    Seqlock(const Seqlock&) = delete;
+    Seqlock& operator=(const Seqlock&) = delete;
+    
+    void store(const T& value) {
+        uint64_t buffer[WORDS] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+        
+        uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        
+        for (size_t i = 0; i < WORDS; ++i) {
+            words_[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+    
+    bool try_load(T& out) const {
+        uint64_t before = sequence_.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+        
+        uint64_t buffer[WORDS];
+        for (size_t i = 0; i < WORDS; ++i) {
+            buffer[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+        
+        std::memcpy(&out, buffer, sizeof(T));
+        return true;
+    }
+    
+    T load(uint64_t* retries = nullptr) const {
+        T value;
+        uint64_t attempts = 0;
+        while (!try_load(value)) {
+            attempts++;
+        }
+        if (retries) {
+            *retries += attempts;
+        }
+        return value;
+    }
+    
+    uint64_t version() const { return sequence_.load(std::memory_order_acquire) >> 1; }
+};
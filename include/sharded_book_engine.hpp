@@ -0,0 +1,143 @@
+#pragma once
+
+#include "itch_book_builder.hpp"
+#include "lock_free_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <optional>
+
+struct BookUpdateEvent {
+    uint64_t sequence;
+    uint16_t stock_locate;
+    uint8_t changes;
+    TopOfBook top;
+};
+
+class ShardedBookEngine {
+public:
+    struct Config {
+        size_t shards;
+        size_t queue_capacity;
+        std::vector<int> cpus;
+        
+        size_t rebalance_interval;
+        double imbalance_threshold;
+        
+        Config() : shards(2), queue_capacity(65536), rebalance_interval(0), imbalance_threshold(1.5) {}
+    };
+    
+    struct ShardStats {
+        uint64_t messages;
+        uint64_t updates;
+        uint64_t output_stalls;
+        uint64_t dropped_updates;
+        double utilization;
+    };
+    
+    struct MigrationStats {
+        uint64_t migrations;
+        uint64_t rebalances;
+        uint64_t handoff_wait_ns;
+        uint16_t last_locate;
+    };
+    
+private:
+    enum class Command : uint8_t {
+        Apply,
+        Release,
+        Adopt
+    };
+    
+    struct InputMessage {
+        uint64_t sequence;
+        Command command;
+        uint16_t stock_locate;
+        itch::Message message;
+    };
+    
+    struct Shard {
+        SPSCQueue<InputMessage> input;
+        SPSCQueue<BookUpdateEvent> output;
+        ItchBookBuilder builder;
+        std::thread thread;
+        int cpu;
+        
+        alignas(64) std::atomic<uint64_t> routed;
+        alignas(64) std::atomic<uint64_t> watermark;
+        std::atomic<uint64_t> messages;
+        std::atomic<uint64_t> updates;
+        std::atomic<uint64_t> output_stalls;
+        std::atomic<uint64_t> dropped_updates;
+        std::atomic<uint64_t> busy_ns;
+        
+        alignas(64) std::optional<BookUpdateEvent> pending;
+        bool pending_fresh;
+        uint64_t seen_routed;
+        uint64_t seen_watermark;
+        
+        Shard(size_t capacity, int core)
+            : input(capacity), output(capacity), cpu(core)
+            , routed(0), watermark(0), messages(0), updates(0)
+            , output_stalls(0), dropped_updates(0), busy_ns(0), pending_fresh(false)
+            , seen_routed(0), seen_watermark(0) {}
+    };
+    
+    Config config_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::vector<uint16_t> shard_of_;
+    std::atomic<bool> running_;
+    std::chrono::steady_clock::time_point started_;
+    std::chrono::steady_clock::time_point stopped_;
+    uint64_t next_sequence_;
+    uint64_t dispatched_;
+    uint64_t input_stalls_;
+    
+    std::vector<uint32_t> locate_messages_;
+    std::vector<uint16_t> hot_locates_;
+    uint64_t since_rebalance_;
+    
+    std::atomic<bool> migration_in_flight_;
+    std::atomic<bool> handoff_ready_;
+    std::unique_ptr<EnhancedOrderBook> handoff_;
+    std::atomic<uint64_t> migrations_;
+    std::atomic<uint64_t> handoff_wait_ns_;
+    uint64_t rebalances_;
+    uint16_t last_migrated_;
+    
+    void worker_loop(Shard& shard);
+    void handle(Shard& shard, InputMessage& item);
+    void push(Shard& shard, InputMessage&& item);
+    
+public:
+    explicit ShardedBookEngine(const Config& config = Config());
+    ~ShardedBookEngine();
+    
+    ShardedBookEngine(const ShardedBookEngine&) = delete;
+    ShardedBookEngine& operator=(const ShardedBookEngine&) = delete;
+    
+    void assign(uint16_t stock_locate, size_t shard);
+    size_t shard_of(uint16_t stock_locate) const { return shard_of_[stock_locate]; }
+    size_t shard_count() const { return shards_.size(); }
+    
+    void start();
+    void stop();
+    bool is_running() const { return running_; }
+    
+    uint64_t dispatch(const itch::Message& msg);
+    size_t dispatch_buffer(const uint8_t* data, size_t size);
+    
+    bool migrate(uint16_t stock_locate, size_t shard);
+    bool rebalance();
+    bool migration_in_flight() const { return migration_in_flight_; }
+    
+    bool poll(BookUpdateEvent& event);
+    
+    const EnhancedOrderBook* book(uint16_t stock_locate) const;
+    ShardStats shard_stats(size_t shard) const;
+    MigrationStats migration_stats() const;
+    uint64_t dispatched() const { return dispatched_; }
+    uint64_t input_stalls() const { return input_stalls_; }
+};
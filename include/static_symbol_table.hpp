@@ -0,0 +1,130 @@
+#pragma once
+
+#include "symbol.hpp"
+#include <array>
+#include <stdexcept>
+
+// Compile-time perfect hash over a fixed symbol universe (hash-and-displace):
+// a multiply-shift picks a bucket, the bucket's displacement perturbs a second
+// multiply-shift into a unique slot, and one compare confirms membership.
+template<size_t N>
+class StaticSymbolTable {
+    static constexpr size_t next_pow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+    
+    static constexpr unsigned log2(size_t n) {
+        unsigned bits = 0;
+        while ((size_t(1) << bits) < n) ++bits;
+        return bits;
+    }
+    
+public:
+    static constexpr size_t SLOTS = next_pow2(N * 2 < 2 ? 2 : N * 2);
+    static constexpr size_t BUCKETS = next_pow2(N / 4 < 2 ? 2 : N / 4);
+    static constexpr unsigned SLOT_SHIFT = 64 - log2(SLOTS);
+    static constexpr unsigned BUCKET_SHIFT = 64 - log2(BUCKETS);
+    static constexpr uint32_t MAX_DISPLACEMENT = 1u << 20;
+    
+private:
+    std::array<uint64_t, SLOTS> keys_{};
+    std::array<uint32_t, SLOTS> indices_{};
+    std::array<uint32_t, BUCKETS> displacements_{};
+    std::array<SymbolId, N> symbols_{};
+    
+public:
+    explicit constexpr StaticSymbolTable(const std::array<SymbolId, N>& symbols) {
+        std::array<uint32_t, BUCKETS + 1> bucket_start{};
+        std::array<uint32_t, N> by_bucket{};
+        uint32_t largest = 0;
+        
+        for (size_t i = 0; i < N; ++i) {
+            symbols_[i] = symbols[i];
+            ++bucket_start[PerfectHashIndex::bucket_of(symbols[i].value(), BUCKET_SHIFT) + 1];
+        }
+        for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+            uint32_t size = bucket_start[bucket + 1];
+            if (size > largest) largest = size;
+            bucket_start[bucket + 1] += bucket_start[bucket];
+        }
+        
+        std::array<uint32_t, BUCKETS> fill{};
+        for (size_t i = 0; i < N; ++i) {
+            size_t bucket = PerfectHashIndex::bucket_of(symbols[i].value(), BUCKET_SHIFT);
+            by_bucket[bucket_start[bucket] + fill[bucket]++] = static_cast<uint32_t>(i);
+        }
+        
+        // Place the most crowded buckets first, while free slots are plentiful.
+        for (uint32_t size = largest; size > 0; --size) {
+            for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+                if (bucket_start[bucket + 1] - bucket_start[bucket] == size) {
+                    place_bucket(bucket, &by_bucket[bucket_start[bucket]], size);
+                }
+            }
+        }
+    }
+    
+    constexpr uint32_t find(SymbolId symbol) const {
+        uint64_t key = symbol.value();
+        size_t slot = PerfectHashIndex::slot_of(
+            key, displacements_[PerfectHashIndex::bucket_of(key, BUCKET_SHIFT)], SLOT_SHIFT);
+        return keys_[slot] == key ? indices_[slot] : PerfectHashIndex::NOT_FOUND;
+    }
+    
+    constexpr SymbolId symbol(uint32_t index) const { return symbols_[index]; }
+    static constexpr size_t size() { return N; }
+    
+    PerfectHashIndex index() const {
+        PerfectHashIndex view;
+        view.keys = keys_.data();
+        view.indices = indices_.data();
+        view.displacements = displacements_.data();
+        view.symbols = symbols_.data();
+        view.size = N;
+        view.bucket_shift = BUCKET_SHIFT;
+        view.slot_shift = SLOT_SHIFT;
+        return view;
+    }
+    
+private:
+    constexpr void place_bucket(size_t bucket, const uint32_t* members, uint32_t count) {
+        for (uint32_t displacement = 0; displacement < MAX_DISPLACEMENT; ++displacement) {
+            if (try_place(members, count, displacement)) {
+                displacements_[bucket] = displacement;
+                return;
+            }
+        }
+        throw std::logic_error("no perfect hash displacement found for symbol universe");
+    }
+    
+    constexpr bool try_place(const uint32_t* members, uint32_t count, uint32_t displacement) {
+        for (uint32_t i = 0; i < count; ++i) {
+            uint64_t key = symbols_[members[i]].value();
+            size_t slot = PerfectHashIndex::slot_of(key, displacement, SLOT_SHIFT);
+            
+            if (keys_[slot] != 0) {
+                if (keys_[slot] == key) {
+                    throw std::logic_error("duplicate symbol in universe");
+                }
+                for (uint32_t j = 0; j < i; ++j) {
+                    size_t placed = PerfectHashIndex::slot_of(
+                        symbols_[members[j]].value(), displacement, SLOT_SHIFT);
+                    keys_[placed] = 0;
+                    indices_[placed] = 0;
+                }
+                return false;
+            }
+            
+            keys_[slot] = key;
+            indices_[slot] = members[i];
+        }
+        return true;
+    }
+};
+
+template<typename... Symbols>
+constexpr std::array<SymbolId, sizeof...(Symbols)> symbol_universe(Symbols... symbols) {
+    return {{SymbolId::from_cstr(symbols)...}};
+}
@@ -2,10 +2,11 @@
 
 #include "order_book.hpp"
 #include <functional>
+#include <unordered_map>
 
 class TradingStrategy {
 public:
-    using OrderSignal = std::function<void(const std::string&, double, uint64_t, bool)>;
+    using OrderSignal = std::function<void(SymbolId, double, uint64_t, bool)>;
     
 private:
     OrderSignal signal_callback_;
@@ -18,7 +19,7 @@ private:
         double avg_price;
     };
     
-    std::map<std::string, PositionInfo> positions_;
+    std::unordered_map<SymbolId, PositionInfo> positions_;
     
 public:
     TradingStrategy();
@@ -28,9 +29,9 @@ public:
     void set_imbalance_threshold(double threshold);
     
     void on_quote_update(const OrderBookSnapshot& snapshot);
-    void on_trade(const std::string& symbol, int64_t price, uint64_t size);
+    void on_trade(SymbolId symbol, int64_t price, uint64_t size);
     
-    const std::map<std::string, PositionInfo>& positions() const { 
+    const std::unordered_map<SymbolId, PositionInfo>& positions() const { 
         return positions_; 
     }
 };
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <ostream>
+
+class SymbolId {
+    uint64_t packed_;
+    
+    static constexpr uint64_t SPACES = 0x2020202020202020ULL;
+    
+public:
+    static constexpr size_t LENGTH = 8;
+    
+    constexpr SymbolId() : packed_(SPACES) {}
+    explicit constexpr SymbolId(uint64_t packed) : packed_(packed) {}
+    
+    static SymbolId from_chars(const char* symbol) {
+        uint64_t packed;
+        std::memcpy(&packed, symbol, LENGTH);
+        
+        // Recorded symbols may be NUL padded; map each zero byte to a space.
+        uint64_t nonzero = ((packed & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | packed;
+        uint64_t zero_bytes = ~nonzero & 0x8080808080808080ULL;
+        return SymbolId(packed | (zero_bytes >> 2));
+    }
+    
+    static constexpr SymbolId from_cstr(const char* symbol) {
+        uint64_t packed = 0;
+        size_t i = 0;
+        for (; i < LENGTH && symbol[i] != '\0'; ++i) {
+            packed |= static_cast<uint64_t>(static_cast<uint8_t>(symbol[i])) << (8 * i);
+        }
+        for (; i < LENGTH; ++i) {
+            packed |= uint64_t(' ') << (8 * i);
+        }
+        return SymbolId(packed);
+    }
+    
+    static SymbolId from_string(const std::string& symbol) {
+        char padded[LENGTH];
+        std::memset(padded, ' ', LENGTH);
+        std::memcpy(padded, symbol.data(), std::min(symbol.size(), LENGTH));
+        return from_chars(padded);
+    }
+    
+    constexpr uint64_t value() const { return packed_; }
+    constexpr bool empty() const { return packed_ == SPACES; }
+    
+    void copy_to(char* dest) const {
+        std::memcpy(dest, &packed_, LENGTH);
+    }
+    
+    size_t length() const {
+        size_t len = LENGTH;
+        while (len > 0 && static_cast<char>(packed_ >> (8 * (len - 1))) == ' ') {
+            --len;
+        }
+        return len;
+    }
+    
+    std::string to_string() const {
+        char chars[LENGTH];
+        copy_to(chars);
+        return std::string(chars, length());
+    }
+    
+    constexpr bool operator==(SymbolId other) const { return packed_ == other.packed_; }
+    constexpr bool operator!=(SymbolId other) const { return packed_ != other.packed_; }
+    constexpr bool operator<(SymbolId other) const { return packed_ < other.packed_; }
+};
+
+inline std::ostream& operator<<(std::ostream& os, SymbolId symbol) {
+    char chars[SymbolId::LENGTH];
+    symbol.copy_to(chars);
+    return os.write(chars, symbol.length());
+}
+
+namespace std {
+template<>
+struct hash<SymbolId> {
+    size_t operator()(SymbolId symbol) const {
+        return static_cast<size_t>((symbol.value() * 0x9E3779B97F4A7C15ULL) >> 16);
+    }
+};
+}
+
+struct PerfectHashIndex {
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+    static constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+    static constexpr uint64_t DISPLACEMENT_MULTIPLIER = 0xC2B2AE3D27D4EB4FULL;
+    
+    const uint64_t* keys = nullptr;
+    const uint32_t* indices = nullptr;
+    const uint32_t* displacements = nullptr;
+    const SymbolId* symbols = nullptr;
+    size_t size = 0;
+    unsigned bucket_shift = 63;
+    unsigned slot_shift = 63;
+    
+    static constexpr size_t bucket_of(uint64_t key, unsigned shift) {
+        return static_cast<size_t>((key * MULTIPLIER) >> shift);
+    }
+    
+    static constexpr size_t slot_of(uint64_t key, uint32_t displacement, unsigned shift) {
+        return static_cast<size_t>(((key ^ (displacement * DISPLACEMENT_MULTIPLIER)) * MULTIPLIER) >> shift);
+    }
+    
+    uint32_t find(SymbolId symbol) const {
+        if (size == 0) return NOT_FOUND;
+        uint64_t key = symbol.value();
+        size_t slot = slot_of(key, displacements[bucket_of(key, bucket_shift)], slot_shift);
+        return keys[slot] == key ? indices[slot] : NOT_FOUND;
+    }
+};
+
+class SymbolTable {
+    PerfectHashIndex universe_;
+    std::unordered_map<SymbolId, uint32_t> index_;
+    std::vector<SymbolId> symbols_;
+    
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+    
+    SymbolTable() = default;
+    
+    explicit SymbolTable(const PerfectHashIndex& universe)
+        : universe_(universe)
+        , symbols_(universe.symbols, universe.symbols + universe.size) {}
+    
+    uint32_t intern(SymbolId symbol) {
+        uint32_t known = universe_.find(symbol);
+        if (known != NOT_FOUND) {
+            return known;
+        }
+        
+        auto it = index_.find(symbol);
+        if (it != index_.end()) {
+            return it->second;
+        }
+        
+        uint32_t index = static_cast<uint32_t>(symbols_.size());
+        index_.emplace(symbol, index);
+        symbols_.push_back(symbol);
+        return index;
+    }
+    
+    uint32_t find(SymbolId symbol) const {
+        uint32_t known = universe_.find(symbol);
+        if (known != NOT_FOUND || index_.empty()) {
+            return known;
+        }
+        
+        auto it = index_.find(symbol);
+        return it != index_.end() ? it->second : NOT_FOUND;
+    }
+    
+    SymbolId symbol(uint32_t index) const { return symbols_[index]; }
+    const std::vector<SymbolId>& symbols() const { return symbols_; }
+    size_t size() const { return symbols_.size(); }
+    size_t universe_size() const { return universe_.size; }
+    
+    void clear() {
+        index_.clear();
+        symbols_.resize(universe_.size);
+    }
+};
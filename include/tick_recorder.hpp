@@ -1,5 +1,6 @@
 #pragma once
 
+#include "symbol.hpp"
 #include <fstream>
 #include <string>
 #include <cstdint>
@@ -44,10 +45,10 @@ public:
     explicit TickRecorder(const std::string& filename, bool use_mmap = true);
     ~TickRecorder();
     
-    void record_trade(uint64_t timestamp, const std::string& symbol, 
+    void record_trade(uint64_t timestamp, SymbolId symbol, 
                      int64_t price, uint64_t size, uint8_t side);
     
-    void record_quote(uint64_t timestamp, const std::string& symbol,
+    void record_quote(uint64_t timestamp, SymbolId symbol,
                      int64_t bid_price, uint64_t bid_size,
                      int64_t ask_price, uint64_t ask_size);
     
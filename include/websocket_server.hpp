@@ -37,6 +37,7 @@ class WebSocketServer {
     std::vector<WebSocketClient> clients_;
     
     void accept_loop();
+    void send_frame(uint8_t opcode, const uint8_t* payload, size_t size);
     bool handle_handshake(socket_t client_socket);
     std::string generate_accept_key(const std::string& key);
     
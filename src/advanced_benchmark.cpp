@@ -3,10 +3,30 @@
 #include "itch_parser.hpp"
 #include "order_book.hpp"
 #include "enhanced_order_book.hpp"
+#include "basic_order_book.hpp"
+#include "itch_book_builder.hpp"
+#include "sharded_book_engine.hpp"
+#include "book_checkpoint.hpp"
+#include "book_snapshot.hpp"
+#include "nbbo_engine.hpp"
+#include "market_event.hpp"
+#include "static_symbol_table.hpp"
 #include "lock_free_queue.hpp"
+#include "broadcast_ring.hpp"
 #include "memory_pool.hpp"
+#include "arena.hpp"
+#include "alloc_tracker.hpp"
 #include "latency_tracker.hpp"
 #include <random>
+#include <thread>
+
+// Adds an allocs/op counter when built with ENABLE_ALLOC_TRACKING, so a hot
+// path that starts allocating shows up next to its timings.
+static void report_allocations(benchmark::State& state, const AllocRegion& region, size_t ops_per_iteration = 1) {
+    if (!AllocTracker::active()) return;
+    double ops = static_cast<double>(state.iterations()) * static_cast<double>(ops_per_iteration);
+    state.counters["allocs/op"] = ops > 0 ? static_cast<double>(region.allocations()) / ops : 0.0;
+}
 
 static void BM_IEXParsing(benchmark::State& state) {
     iex::QuoteUpdate quote{};
@@ -119,11 +139,9 @@ BENCHMARK(BM_EnhancedOrderBookAddOrder);
 static void BM_EnhancedOrderBookExecuteOrder(benchmark::State& state) {
     EnhancedOrderBook book("AAPL");
     
-    state.PauseTiming();
     for (uint64_t i = 0; i < 1000; ++i) {
         book.add_order(i, 'B', 1500000, 100, i);
     }
-    state.ResumeTiming();
     
     uint64_t order_id = 0;
     for (auto _ : state) {
@@ -139,6 +157,7 @@ static void BM_SPSCQueuePushPop(benchmark::State& state) {
     SPSCQueue<uint64_t> queue(1024);
     uint64_t value = 0;
     
+    AllocRegion region;
     for (auto _ : state) {
         queue.try_push(value++);
         auto result = queue.try_pop();
@@ -146,9 +165,45 @@ static void BM_SPSCQueuePushPop(benchmark::State& state) {
     }
     
     state.SetItemsProcessed(state.iterations() * 2);
+    report_allocations(state, region);
 }
 BENCHMARK(BM_SPSCQueuePushPop);
 
+// Moves MarketEvents through the ring: arg 0 copies one at a time, arg 1
+// builds and reads them in place, larger args transfer in batches of that size.
+static void BM_SPSCQueueEvents(benchmark::State& state) {
+    const size_t mode = static_cast<size_t>(state.range(0));
+    SPSCQueue<MarketEvent> queue(1024);
+    std::vector<MarketEvent> events(mode > 1 ? mode : 1);
+    std::vector<MarketEvent> out(events.size());
+    uint64_t checksum = 0;
+    
+    AllocRegion region;
+    for (auto _ : state) {
+        if (mode == 0) {
+            events[0].order_ref++;
+            queue.try_push(events[0]);
+            auto event = queue.try_pop();
+            checksum += event->order_ref;
+        } else if (mode == 1) {
+            MarketEvent* slot = queue.claim();
+            slot->order_ref = checksum;
+            queue.commit();
+            checksum += queue.peek()->order_ref + 1;
+            queue.release();
+        } else {
+            queue.try_push_n(events.data(), events.size());
+            size_t n = queue.try_pop_n(out.data(), out.size());
+            checksum += out[n - 1].order_ref;
+        }
+    }
+    benchmark::DoNotOptimize(checksum);
+    
+    state.SetItemsProcessed(state.iterations() * events.size());
+    report_allocations(state, region);
+}
+BENCHMARK(BM_SPSCQueueEvents)->Arg(0)->Arg(1)->Arg(16)->Arg(64);
+
 static void BM_MemoryPoolAllocation(benchmark::State& state) {
     MemoryPool<uint64_t> pool;
     std::vector<uint64_t*> ptrs;
@@ -200,6 +255,152 @@ static void BM_HeapAllocation(benchmark::State& state) {
 }
 BENCHMARK(BM_HeapAllocation);
 
+// Producer allocates events and hands them to a consumer thread by pointer;
+// arg 0 releases with new/delete, arg 1 through a ConcurrentMemoryPool magazine.
+static void BM_EventHandoff(benchmark::State& state) {
+    const bool pooled = state.range(0) != 0;
+    const uint64_t batch = 65536;
+    ConcurrentMemoryPool<MarketEvent> pool;
+    
+    for (auto _ : state) {
+        SPSCQueue<MarketEvent*> queue(1024);
+        std::thread consumer([&]() {
+            ConcurrentMemoryPool<MarketEvent>::Magazine magazine(pool);
+            for (uint64_t received = 0; received < batch;) {
+                auto event = queue.try_pop();
+                if (!event) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                benchmark::DoNotOptimize((*event)->order_ref);
+                if (pooled) {
+                    magazine.deallocate(*event);
+                } else {
+                    delete *event;
+                }
+                ++received;
+            }
+        });
+        
+        for (uint64_t i = 0; i < batch; ++i) {
+            MarketEvent* event = pooled ? pool.allocate() : new MarketEvent();
+            event->order_ref = i;
+            while (!queue.try_push(event)) {
+                std::this_thread::yield();
+            }
+        }
+        consumer.join();
+    }
+    
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_EventHandoff)->Arg(0)->Arg(1)->UseRealTime();
+
+// Several receive threads fan events into one consumer; arg 0 uses the
+// node-per-push MPSCQueue, arg 1 the bounded sequence ring.
+static void BM_FanIn(benchmark::State& state) {
+    const bool bounded = state.range(0) != 0;
+    const size_t producers = 2;
+    const uint64_t per_producer = 32768;
+    
+    for (auto _ : state) {
+        MPSCQueue<MarketEvent> list_queue;
+        BoundedMPSCQueue<MarketEvent> ring_queue(1024);
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p]() {
+                MarketEvent event;
+                for (uint64_t i = 0; i < per_producer; ++i) {
+                    event.order_ref = p * per_producer + i;
+                    if (bounded) {
+                        ring_queue.push(event);
+                    } else {
+                        list_queue.push(event);
+                    }
+                }
+            });
+        }
+        
+        for (uint64_t received = 0; received < producers * per_producer;) {
+            auto event = bounded ? ring_queue.try_pop() : list_queue.try_pop();
+            if (!event) {
+                std::this_thread::yield();
+                continue;
+            }
+            benchmark::DoNotOptimize(event->order_ref);
+            ++received;
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+    
+    state.SetItemsProcessed(state.iterations() * producers * per_producer);
+}
+BENCHMARK(BM_FanIn)->Arg(0)->Arg(1)->UseRealTime();
+
+// One producer delivers every event to three consumers; arg 0 copies into
+// an SPSCQueue per consumer, arg 1 publishes once into a BroadcastRing.
+static void BM_FanOut(benchmark::State& state) {
+    const bool broadcast = state.range(0) != 0;
+    const size_t consumers = 3;
+    const uint64_t batch = 65536;
+    
+    for (auto _ : state) {
+        std::vector<std::unique_ptr<SPSCQueue<MarketEvent>>> queues;
+        BroadcastRing<MarketEvent> ring(1024);
+        std::vector<BroadcastRing<MarketEvent>::Consumer*> cursors;
+        for (size_t c = 0; c < consumers; ++c) {
+            queues.push_back(std::make_unique<SPSCQueue<MarketEvent>>(1024));
+            cursors.push_back(&ring.add_consumer());
+        }
+        
+        std::vector<std::thread> threads;
+        for (size_t c = 0; c < consumers; ++c) {
+            threads.emplace_back([&, c]() {
+                uint64_t sum = 0;
+                for (uint64_t received = 0; received < batch;) {
+                    size_t n = 0;
+                    if (broadcast) {
+                        n = cursors[c]->poll([&](const MarketEvent& event) { sum += event.order_ref; });
+                    } else if (MarketEvent* event = queues[c]->peek()) {
+                        sum += event->order_ref;
+                        queues[c]->release();
+                        n = 1;
+                    }
+                    if (n == 0) {
+                        std::this_thread::yield();
+                    }
+                    received += n;
+                }
+                benchmark::DoNotOptimize(sum);
+            });
+        }
+        
+        MarketEvent event;
+        for (uint64_t i = 0; i < batch; ++i) {
+            event.order_ref = i;
+            if (broadcast) {
+                while (!ring.try_publish(event)) {
+                    std::this_thread::yield();
+                }
+            } else {
+                for (auto& queue : queues) {
+                    while (!queue->try_push(event)) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+    
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_FanOut)->Arg(0)->Arg(1)->UseRealTime();
+
 static void BM_LatencyMeasurement(benchmark::State& state) {
     for (auto _ : state) {
         auto start = perf::rdtsc_start();
@@ -227,34 +428,84 @@ static void BM_EndToEndPipeline(benchmark::State& state) {
     quote.ask_price = 1500100;
     quote.ask_size = 200;
     
+    AllocRegion region;
     for (auto _ : state) {
         queue.try_push(quote);
         
         auto msg = queue.try_pop();
         if (msg) {
-            book.modify_bid(msg->bid_price, msg->bid_size, msg->header.timestamp);
-            book.modify_ask(msg->ask_price, msg->ask_size, msg->header.timestamp);
+            uint8_t changes = book.modify_bid(msg->bid_price, msg->bid_size, msg->header.timestamp);
+            changes |= book.modify_ask(msg->ask_price, msg->ask_size, msg->header.timestamp);
             
-            auto snapshot = book.snapshot();
-            benchmark::DoNotOptimize(snapshot);
+            if (changes & (BBO_PRICE_CHANGED | BBO_SIZE_CHANGED)) {
+                const auto& snapshot = book.snapshot();
+                benchmark::DoNotOptimize(snapshot);
+            }
         }
     }
     
     state.SetItemsProcessed(state.iterations());
+    report_allocations(state, region);
 }
 BENCHMARK(BM_EndToEndPipeline);
 
 static void BM_OrderBookDepth(benchmark::State& state) {
     EnhancedOrderBook book("AAPL");
     
-    state.PauseTiming();
     for (int i = 0; i < 100; ++i) {
         book.add_order(i, 'B', 1500000 - i * 100, 100, i);
         book.add_order(1000 + i, 'S', 1500100 + i * 100, 100, i);
     }
-    state.ResumeTiming();
     
+    AllocRegion region;
     for (auto _ : state) {
+        auto bid_depth = book.get_bid_depth(state.range(0));
+        auto ask_depth = book.get_ask_depth(state.range(0));
+        benchmark::DoNotOptimize(bid_depth);
+        benchmark::DoNotOptimize(ask_depth);
+    }
+    
+    state.SetItemsProcessed(state.iterations());
+    report_allocations(state, region);
+}
+BENCHMARK(BM_OrderBookDepth)->Arg(10)->Arg(50);
+
+static void BM_OrderBookDepthArena(benchmark::State& state) {
+    EnhancedOrderBook book("AAPL");
+    Arena arena;
+    
+    for (int i = 0; i < 100; ++i) {
+        book.add_order(i, 'B', 1500000 - i * 100, 100, i);
+        book.add_order(1000 + i, 'S', 1500100 + i * 100, 100, i);
+    }
+    
+    AllocRegion region;
+    for (auto _ : state) {
+        ArenaScope scope(arena);
+        LevelSpan bid_depth = book.get_bid_depth(state.range(0), arena);
+        LevelSpan ask_depth = book.get_ask_depth(state.range(0), arena);
+        benchmark::DoNotOptimize(bid_depth);
+        benchmark::DoNotOptimize(ask_depth);
+    }
+    
+    state.SetItemsProcessed(state.iterations());
+    report_allocations(state, region);
+}
+BENCHMARK(BM_OrderBookDepthArena)->Arg(10)->Arg(50);
+
+static void BM_DepthPublishVector(benchmark::State& state) {
+    EnhancedOrderBook book("AAPL");
+    
+    for (int i = 0; i < 100; ++i) {
+        book.add_order(i, 'B', 1500000 - i * 100, 100, i);
+        book.add_order(1000 + i, 'S', 1500100 + i * 100, 100, i);
+    }
+    
+    uint64_t timestamp = 100;
+    for (auto _ : state) {
+        book.modify_order(timestamp % 20, 50 + timestamp % 50, timestamp);
+        ++timestamp;
+        
         auto bid_depth = book.get_bid_depth(10);
         auto ask_depth = book.get_ask_depth(10);
         benchmark::DoNotOptimize(bid_depth);
@@ -263,6 +514,460 @@ static void BM_OrderBookDepth(benchmark::State& state) {
     
     state.SetItemsProcessed(state.iterations());
 }
-BENCHMARK(BM_OrderBookDepth);
+BENCHMARK(BM_DepthPublishVector);
+
+static void BM_DepthPublishSpan(benchmark::State& state) {
+    EnhancedOrderBook book("AAPL");
+    
+    for (int i = 0; i < 100; ++i) {
+        book.add_order(i, 'B', 1500000 - i * 100, 100, i);
+        book.add_order(1000 + i, 'S', 1500100 + i * 100, 100, i);
+    }
+    
+    uint64_t timestamp = 100;
+    for (auto _ : state) {
+        book.modify_order(timestamp % 20, 50 + timestamp % 50, timestamp);
+        ++timestamp;
+        
+        LevelSpan bid_depth = book.bid_depth();
+        LevelSpan ask_depth = book.ask_depth();
+        benchmark::DoNotOptimize(bid_depth.data);
+        benchmark::DoNotOptimize(ask_depth.data);
+    }
+    
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DepthPublishSpan);
+
+static std::vector<itch::Message> make_itch_stream(uint16_t num_locates, size_t orders_per_locate) {
+    std::vector<itch::Message> stream;
+    uint64_t ref = 1;
+    
+    for (uint16_t locate = 1; locate <= num_locates; ++locate) {
+        itch::StockDirectory dir{};
+        dir.type = 'R';
+        dir.stock_locate = locate;
+        std::memcpy(dir.stock, "SYM     ", 8);
+        stream.push_back(dir);
+    }
+    
+    for (size_t i = 0; i < orders_per_locate; ++i) {
+        for (uint16_t locate = 1; locate <= num_locates; ++locate) {
+            itch::AddOrder add{};
+            add.type = 'A';
+            add.stock_locate = locate;
+            add.order_reference = ref;
+            add.buy_sell = (i % 2 == 0) ? 'B' : 'S';
+            add.shares = 100 + (i % 7) * 100;
+            add.price = (i % 2 == 0) ? 1500000 - (i % 20) * 100 : 1500100 + (i % 20) * 100;
+            stream.push_back(add);
+            
+            switch (i % 4) {
+                case 0: {
+                    itch::OrderExecuted exec{};
+                    exec.type = 'E';
+                    exec.stock_locate = locate;
+                    exec.order_reference = ref;
+                    exec.executed_shares = 50;
+                    stream.push_back(exec);
+                    break;
+                }
+                case 1: {
+                    itch::OrderCancel cancel{};
+                    cancel.type = 'X';
+                    cancel.stock_locate = locate;
+                    cancel.order_reference = ref;
+                    cancel.cancelled_shares = 50;
+                    stream.push_back(cancel);
+                    break;
+                }
+                case 2: {
+                    itch::OrderReplace replace{};
+                    replace.type = 'U';
+                    replace.stock_locate = locate;
+                    replace.original_order_reference = ref;
+                    replace.new_order_reference = ref + 1;
+                    replace.shares = add.shares;
+                    replace.price = add.price + 100;
+                    stream.push_back(replace);
+                    ref++;
+                    break;
+                }
+                default:
+                    break;
+            }
+            
+            itch::OrderDelete del{};
+            del.type = 'D';
+            del.stock_locate = locate;
+            del.order_reference = ref;
+            stream.push_back(del);
+            ref++;
+        }
+    }
+    
+    return stream;
+}
+
+static void BM_ItchBookBuilder(benchmark::State& state) {
+    auto stream = make_itch_stream(static_cast<uint16_t>(state.range(0)), 4096);
+    ItchBookBuilder builder;
+    
+    for (const auto& msg : stream) {
+        builder.process(msg);
+    }
+    
+    for (auto _ : state) {
+        for (const auto& msg : stream) {
+            benchmark::DoNotOptimize(builder.process(msg));
+        }
+    }
+    
+    state.SetItemsProcessed(state.iterations() * stream.size());
+}
+BENCHMARK(BM_ItchBookBuilder)->Arg(16)->Arg(256);
+
+static void BM_ItchBookBuilderEvents(benchmark::State& state) {
+    auto stream = make_itch_stream(static_cast<uint16_t>(state.range(0)), 4096);
+    ItchBookBuilder builder;
+    ItchEventAdapter adapter;
+    MarketEvent event;
+    
+    for (const auto& msg : stream) {
+        adapter.normalize(msg, 0, event);
+        builder.process(event);
+    }
+    
+    for (auto _ : state) {
+        for (const auto& msg : stream) {
+            adapter.normalize(msg, 0, event);
+            benchmark::DoNotOptimize(builder.process(event));
+        }
+    }
+    
+    state.SetItemsProcessed(state.iterations() * stream.size());
+}
+BENCHMARK(BM_ItchBookBuilderEvents)->Arg(16)->Arg(256);
+
+struct BookOp {
+    uint64_t id;
+    int64_t price;
+    uint64_t quantity;
+    char side;
+    char action;
+};
+
+// range(0) selects the workload: 0 keeps activity within a few ticks of the
+// touch, 1 spreads it over hundreds of levels.
+static std::vector<BookOp> make_book_ops(int workload, size_t count) {
+    std::mt19937_64 rng(99);
+    int64_t spread_ticks = workload == 0 ? 5 : 400;
+    std::vector<BookOp> ops;
+    std::vector<BookOp> live;
+    uint64_t next_id = 1;
+    
+    while (ops.size() < count) {
+        if (live.size() < 256 || rng() % 2 == 0) {
+            BookOp op;
+            op.id = next_id++;
+            op.side = rng() % 2 ? 'B' : 'S';
+            int64_t offset = static_cast<int64_t>(rng() % spread_ticks) * 100;
+            op.price = op.side == 'B' ? 1000000 - offset : 1000100 + offset;
+            op.quantity = 100 + rng() % 400;
+            op.action = 'A';
+            ops.push_back(op);
+            live.push_back(op);
+        } else {
+            size_t pick = rng() % live.size();
+            BookOp op = live[pick];
+            op.action = rng() % 3 ? 'D' : 'E';
+            ops.push_back(op);
+            live[pick] = live.back();
+            live.pop_back();
+        }
+    }
+    return ops;
+}
+
+template<typename Book>
+static void BM_BasicOrderBook(benchmark::State& state) {
+    auto ops = make_book_ops(static_cast<int>(state.range(0)), 1 << 16);
+    
+    AllocRegion region;
+    for (auto _ : state) {
+        state.PauseTiming();
+        Book book(SymbolId::from_cstr("BENCH"));
+        state.ResumeTiming();
+        for (const auto& op : ops) {
+            if (op.action == 'A') {
+                benchmark::DoNotOptimize(book.add_order(op.id, op.side, op.price, op.quantity, 0));
+            } else if (op.action == 'E') {
+                benchmark::DoNotOptimize(book.execute_order(op.id, op.quantity, 0));
+            } else {
+                benchmark::DoNotOptimize(book.delete_order(op.id, 0));
+            }
+        }
+    }
+    
+    state.SetItemsProcessed(state.iterations() * ops.size());
+    report_allocations(state, region, ops.size());
+}
+BENCHMARK_TEMPLATE(BM_BasicOrderBook, BasicOrderBook<TreeLevels, HashOrderStore>)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_BasicOrderBook, BasicOrderBook<TreeLevels, DenseOrderStore>)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_BasicOrderBook, BasicOrderBook<PooledTreeLevels, PooledHashOrderStore>)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_BasicOrderBook, BasicOrderBook<SortedVectorLevels, HashOrderStore>)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_BasicOrderBook, BasicOrderBook<SortedVectorLevels, DenseOrderStore>)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_BasicOrderBook, BasicOrderBook<DenseLadderLevels<100>, HashOrderStore>)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_BasicOrderBook, BasicOrderBook<DenseLadderLevels<100>, DenseOrderStore>)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_BasicOrderBook, BasicOrderBook<InlineLevels<16>, HashOrderStore>)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_BasicOrderBook, BasicOrderBook<InlineLevels<16>, DenseOrderStore>)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_BasicOrderBook, EnhancedOrderBook)->Arg(0)->Arg(1);
+
+static void build_resting_books(ItchBookBuilder& builder, uint16_t num_locates, size_t orders_per_locate) {
+    uint64_t ref = 1;
+    for (uint16_t locate = 1; locate <= num_locates; ++locate) {
+        for (size_t i = 0; i < orders_per_locate; ++i) {
+            itch::AddOrder add{};
+            add.type = 'A';
+            add.stock_locate = locate;
+            add.order_reference = ref++;
+            add.buy_sell = (i % 2 == 0) ? 'B' : 'S';
+            add.shares = 100 + (i % 7) * 100;
+            add.price = (i % 2 == 0) ? 1500000 - (i % 40) * 100 : 1500100 + (i % 40) * 100;
+            std::memcpy(add.stock, "SYM     ", 8);
+            builder.process(add);
+        }
+    }
+}
+
+static void BM_CheckpointSerialize(benchmark::State& state) {
+    ItchBookBuilder builder;
+    build_resting_books(builder, 256, static_cast<size_t>(state.range(0)));
+    
+    std::vector<uint8_t> image;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(serialize_checkpoint(builder, 0, 0, image));
+    }
+    
+    state.SetBytesProcessed(state.iterations() * image.size());
+}
+BENCHMARK(BM_CheckpointSerialize)->Arg(1024)->Arg(8192)->Unit(benchmark::kMillisecond);
+
+static void BM_SnapshotBegin(benchmark::State& state) {
+    ItchBookBuilder builder;
+    build_resting_books(builder, 256, static_cast<size_t>(state.range(0)));
+    BookSnapshotter snapshot(builder);
+    std::vector<uint8_t> image;
+    
+    // Feed-side pause of a copy-on-write checkpoint, including sizing the
+    // copy buffers; the copies and the read-out are not timed.
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(snapshot.begin(0, 0));
+        state.PauseTiming();
+        while (snapshot.capture_next()) {}
+        snapshot.write_image(image);
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_SnapshotBegin)->Arg(1024)->Arg(8192)->Iterations(20)->Unit(benchmark::kMicrosecond);
+
+// Worst-case feed stall under a snapshot: the first write to a book after
+// begin() copies the whole book on the feed thread.
+static void BM_SnapshotFeedCopy(benchmark::State& state) {
+    ItchBookBuilder builder;
+    build_resting_books(builder, 1, static_cast<size_t>(state.range(0)));
+    BookSnapshotter snapshot(builder);
+    std::vector<uint8_t> image;
+    
+    for (auto _ : state) {
+        state.PauseTiming();
+        snapshot.begin(0, 0);
+        state.ResumeTiming();
+        snapshot.before_write(1);
+        state.PauseTiming();
+        snapshot.write_image(image);
+        state.ResumeTiming();
+    }
+    
+    state.counters["max_copy_us"] = snapshot.stats().max_feed_copy_ns / 1000.0;
+    state.counters["ns_per_order"] = static_cast<double>(snapshot.stats().feed_copy_ns) /
+                                     (static_cast<double>(snapshot.stats().feed_copies) * state.range(0));
+}
+BENCHMARK(BM_SnapshotFeedCopy)->Arg(1024)->Arg(8192)->Arg(65536)->Iterations(20)->Unit(benchmark::kMicrosecond);
+
+static void BM_CheckpointRestore(benchmark::State& state) {
+    ItchBookBuilder builder;
+    build_resting_books(builder, 256, static_cast<size_t>(state.range(0)));
+    
+    CheckpointWriter writer("bench_books.ckpt");
+    writer.write_now(builder, 0, 0);
+    
+    ItchBookBuilder restored;
+    for (auto _ : state) {
+        CheckpointReader reader(writer.path());
+        benchmark::DoNotOptimize(reader.restore(restored));
+    }
+    
+    state.SetItemsProcessed(state.iterations() * builder.book_count() * state.range(0));
+    std::remove(writer.path().c_str());
+}
+BENCHMARK(BM_CheckpointRestore)->Arg(1024)->Arg(8192)->Unit(benchmark::kMillisecond);
+
+static void BM_NbboUpdate(benchmark::State& state) {
+    NbboEngine engine;
+    const size_t venues = static_cast<size_t>(state.range(0));
+    uint32_t index = engine.symbol_index(SymbolId::from_cstr("AAPL"));
+    
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> offset(-3, 3);
+    std::vector<VenueQuote> quotes(4096);
+    for (size_t i = 0; i < quotes.size(); ++i) {
+        quotes[i].bid_price = 1500000 + offset(rng) * 100;
+        quotes[i].ask_price = quotes[i].bid_price + 500;
+        quotes[i].bid_size = 100 + i % 7;
+        quotes[i].ask_size = 100 + i % 5;
+        quotes[i].timestamp = i;
+    }
+    
+    size_t i = 0;
+    for (auto _ : state) {
+        const VenueQuote& quote = quotes[i & (quotes.size() - 1)];
+        benchmark::DoNotOptimize(engine.update(static_cast<uint8_t>(i % venues), index, quote));
+        i++;
+    }
+    
+    state.SetItemsProcessed(state.iterations());
+    state.counters["rescans"] = static_cast<double>(engine.stats().rescans);
+}
+BENCHMARK(BM_NbboUpdate)->Arg(4)->Arg(16);
+
+static void run_sharded_engine(benchmark::State& state, const ShardedBookEngine::Config& config,
+                               size_t skewed_locates) {
+    auto stream = make_itch_stream(256, 1024);
+    double max_utilization = 0.0;
+    uint64_t migrations = 0;
+    
+    for (auto _ : state) {
+        state.PauseTiming();
+        ShardedBookEngine engine(config);
+        for (size_t locate = 1; locate <= skewed_locates; ++locate) {
+            engine.assign(static_cast<uint16_t>(locate), 0);
+        }
+        std::atomic<bool> consuming{true};
+        std::thread consumer([&engine, &consuming]() {
+            BookUpdateEvent event;
+            while (consuming.load(std::memory_order_relaxed)) {
+                if (!engine.poll(event)) {
+                    std::this_thread::yield();
+                }
+            }
+            while (engine.poll(event)) {}
+        });
+        engine.start();
+        state.ResumeTiming();
+        
+        for (const auto& msg : stream) {
+            engine.dispatch(msg);
+        }
+        engine.stop();
+        
+        state.PauseTiming();
+        consuming = false;
+        consumer.join();
+        for (size_t shard = 0; shard < engine.shard_count(); ++shard) {
+            max_utilization = std::max(max_utilization, engine.shard_stats(shard).utilization);
+        }
+        migrations += engine.migration_stats().migrations;
+        state.ResumeTiming();
+    }
+    
+    state.SetItemsProcessed(state.iterations() * stream.size());
+    state.counters["max_util"] = max_utilization;
+    state.counters["migrations"] = benchmark::Counter(static_cast<double>(migrations),
+                                                      benchmark::Counter::kAvgIterations);
+}
+
+static ShardedBookEngine::Config sharded_config(size_t shards, size_t rebalance_interval) {
+    ShardedBookEngine::Config config;
+    config.shards = shards;
+    config.rebalance_interval = rebalance_interval;
+    for (size_t i = 0; i < shards; ++i) {
+        config.cpus.push_back(static_cast<int>(1 + i));
+    }
+    return config;
+}
+
+static void BM_ShardedBookEngine(benchmark::State& state) {
+    run_sharded_engine(state, sharded_config(static_cast<size_t>(state.range(0)), 0), 0);
+}
+BENCHMARK(BM_ShardedBookEngine)->Arg(1)->Arg(2)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_ShardedBookEngineSkewed(benchmark::State& state) {
+    auto config = sharded_config(4, static_cast<size_t>(state.range(0)));
+    run_sharded_engine(state, config, 128);
+}
+BENCHMARK(BM_ShardedBookEngineSkewed)->Arg(0)->Arg(16384)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+template<size_t N>
+static constexpr std::array<SymbolId, N> benchmark_universe() {
+    std::array<SymbolId, N> symbols{};
+    for (size_t i = 0; i < N; ++i) {
+        char name[5] = {'S', char('A' + (i / 676) % 26), char('A' + (i / 26) % 26),
+                        char('A' + i % 26), '\0'};
+        symbols[i] = SymbolId::from_cstr(name);
+    }
+    return symbols;
+}
+
+static constexpr auto BENCH_SYMBOLS = benchmark_universe<500>();
+static constexpr StaticSymbolTable<500> BENCH_TABLE(BENCH_SYMBOLS);
+
+static void BM_BookLookupStaticUniverse(benchmark::State& state) {
+    OrderBookManager manager(BENCH_TABLE.index());
+    size_t i = 0;
+    
+    for (auto _ : state) {
+        OrderBook* book = manager.get(BENCH_SYMBOLS[i++ % BENCH_SYMBOLS.size()]);
+        benchmark::DoNotOptimize(book);
+    }
+    
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BookLookupStaticUniverse);
+
+static void BM_BookLookupRuntimeTable(benchmark::State& state) {
+    OrderBookManager manager;
+    for (SymbolId symbol : BENCH_SYMBOLS) {
+        manager.get_or_create(symbol);
+    }
+    size_t i = 0;
+    
+    for (auto _ : state) {
+        OrderBook* book = manager.get(BENCH_SYMBOLS[i++ % BENCH_SYMBOLS.size()]);
+        benchmark::DoNotOptimize(book);
+    }
+    
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BookLookupRuntimeTable);
+
+static void BM_BookLookupStringMap(benchmark::State& state) {
+    std::map<std::string, OrderBook> books;
+    std::vector<std::string> names;
+    for (SymbolId symbol : BENCH_SYMBOLS) {
+        names.push_back(symbol.to_string());
+        books.emplace(std::piecewise_construct, std::forward_as_tuple(names.back()),
+                      std::forward_as_tuple(symbol));
+    }
+    size_t i = 0;
+    
+    for (auto _ : state) {
+        auto it = books.find(names[i++ % names.size()]);
+        benchmark::DoNotOptimize(it);
+    }
+    
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BookLookupStringMap);
 
 BENCHMARK_MAIN();
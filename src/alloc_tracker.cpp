@@ -0,0 +1,215 @@
+#include "alloc_tracker.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define ALLOC_TRACKER_SANITIZED 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer)
+#define ALLOC_TRACKER_SANITIZED 1
+#endif
+#endif
+
+// Sanitizers own malloc; handing their blocks to __libc_free corrupts the heap.
+#if defined(FEEDHANDLER_ALLOC_TRACKING) && defined(__GLIBC__) && !defined(ALLOC_TRACKER_SANITIZED)
+#include <execinfo.h>
+#include <unistd.h>
+#define ALLOC_TRACKER_HOOK_MALLOC 1
+#endif
+
+#ifdef FEEDHANDLER_ALLOC_TRACKING
+
+namespace {
+
+// Plain data only: a zero-initialised thread_local needs no constructor and
+// no allocation, so the hooks are safe to run from any thread at any time.
+struct ThreadState {
+    AllocCounts counts;
+    bool capturing;
+    bool in_hook;
+    size_t stack_count;
+    int depths[AllocTracker::MAX_STACKS];
+    void* stacks[AllocTracker::MAX_STACKS][AllocTracker::MAX_FRAMES];
+};
+
+thread_local ThreadState tls_state;
+
+inline void record_allocation(size_t size) {
+    ThreadState& state = tls_state;
+    if (state.in_hook) return;
+    
+    ++state.counts.allocations;
+    state.counts.bytes += size;
+    
+#ifdef ALLOC_TRACKER_HOOK_MALLOC
+    if (state.capturing && state.stack_count < AllocTracker::MAX_STACKS) {
+        state.in_hook = true;
+        state.depths[state.stack_count] = backtrace(state.stacks[state.stack_count],
+                                                    static_cast<int>(AllocTracker::MAX_FRAMES));
+        ++state.stack_count;
+        state.in_hook = false;
+    }
+#endif
+}
+
+inline void record_deallocation(void* ptr) {
+    if (ptr && !tls_state.in_hook) {
+        ++tls_state.counts.deallocations;
+    }
+}
+
+}
+
+bool AllocTracker::active() { return true; }
+
+AllocCounts AllocTracker::counts() { return tls_state.counts; }
+
+void AllocTracker::capture_stacks(bool enabled) {
+    ThreadState& state = tls_state;
+#ifdef ALLOC_TRACKER_HOOK_MALLOC
+    if (enabled) {
+        // The first backtrace() loads the unwinder, which allocates; keep
+        // that out of the caller's counts.
+        void* frames[1];
+        state.in_hook = true;
+        backtrace(frames, 1);
+        state.in_hook = false;
+        state.stack_count = 0;
+    }
+#endif
+    state.capturing = enabled;
+}
+
+size_t AllocTracker::captured_stacks() { return tls_state.stack_count; }
+
+void AllocTracker::dump_stacks(int fd) {
+#ifdef ALLOC_TRACKER_HOOK_MALLOC
+    ThreadState& state = tls_state;
+    state.in_hook = true;
+    for (size_t i = 0; i < state.stack_count; ++i) {
+        const char separator[] = "--- allocation ---\n";
+        ssize_t written = write(fd, separator, sizeof(separator) - 1);
+        (void)written;
+        backtrace_symbols_fd(state.stacks[i], state.depths[i], fd);
+    }
+    state.in_hook = false;
+#else
+    (void)fd;
+#endif
+}
+
+#ifdef ALLOC_TRACKER_HOOK_MALLOC
+
+// glibc lets the executable interpose the malloc family; operator new and
+// the C library both come through here, so each allocation counts once.
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) {
+    record_allocation(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    record_allocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    record_allocation(size);
+    record_deallocation(ptr);
+    return __libc_realloc(ptr, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    record_allocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    record_allocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    record_allocation(size);
+    void* ptr = __libc_memalign(alignment, size);
+    if (!ptr) {
+        return ENOMEM;
+    }
+    *out = ptr;
+    return 0;
+}
+
+void free(void* ptr) {
+    record_deallocation(ptr);
+    __libc_free(ptr);
+}
+
+}
+
+#else
+
+// Without malloc interposition, count at the C++ allocation functions.
+void* operator new(size_t size) {
+    record_allocation(size);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    record_allocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return ::operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept {
+    record_deallocation(ptr);
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    ::operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    ::operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    ::operator delete(ptr);
+}
+
+#endif
+
+#else
+
+bool AllocTracker::active() { return false; }
+
+AllocCounts AllocTracker::counts() { return AllocCounts{0, 0, 0}; }
+
+void AllocTracker::capture_stacks(bool) {}
+
+size_t AllocTracker::captured_stacks() { return 0; }
+
+void AllocTracker::dump_stacks(int) {}
+
+#endif
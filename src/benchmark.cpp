@@ -269,13 +269,15 @@ void benchmark_end_to_end() {
         auto popped = queue.try_pop();
         if (popped) {
             auto& book = manager.get_or_create("AAPL");
-            book.modify_bid(popped->bid_price, popped->bid_size, 
-                          popped->header.timestamp);
-            book.modify_ask(popped->ask_price, popped->ask_size, 
-                          popped->header.timestamp);
+            uint8_t changes = book.modify_bid(popped->bid_price, popped->bid_size, 
+                                              popped->header.timestamp);
+            changes |= book.modify_ask(popped->ask_price, popped->ask_size, 
+                                       popped->header.timestamp);
             
-            auto snapshot = book.snapshot();
-            (void)snapshot;
+            if (changes & (BBO_PRICE_CHANGED | BBO_SIZE_CHANGED)) {
+                const auto& snapshot = book.snapshot();
+                (void)snapshot;
+            }
         }
         
         auto msg_end = high_resolution_clock::now();
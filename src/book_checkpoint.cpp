@@ -0,0 +1,461 @@
+#include "book_checkpoint.hpp"
+#include "book_snapshot.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char CHECKPOINT_MAGIC[8] = {'B', 'O', 'O', 'K', 'C', 'K', 'P', 'T'};
+
+static uint64_t checksum_words(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t offset = 0; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + offset, sizeof(word));
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+template<typename T>
+static T* append_record(std::vector<uint8_t>& out, size_t count = 1) {
+    size_t offset = out.size();
+    out.resize(offset + sizeof(T) * count);
+    return reinterpret_cast<T*>(out.data() + offset);
+}
+
+void start_checkpoint(std::vector<uint8_t>& out) {
+    out.clear();
+    std::memset(append_record<CheckpointHeader>(out), 0, sizeof(CheckpointHeader));
+}
+
+void serialize_book(uint16_t stock_locate, const EnhancedOrderBook& book, std::vector<uint8_t>& out) {
+    CheckpointBook* record = append_record<CheckpointBook>(out);
+    std::memset(record, 0, sizeof(*record));
+    record->symbol = book.symbol().value();
+    record->stock_locate = stock_locate;
+    record->bid_levels = static_cast<uint32_t>(book.bid_levels());
+    record->ask_levels = static_cast<uint32_t>(book.ask_levels());
+    record->order_count = book.total_orders();
+    record->counters = book.counters();
+    
+    PriceLevel* levels = append_record<PriceLevel>(out, book.bid_levels() + book.ask_levels());
+    book.for_each_level('B', [&levels](const PriceLevel& level) { *levels++ = level; });
+    book.for_each_level('S', [&levels](const PriceLevel& level) { *levels++ = level; });
+    
+    CheckpointOrder* orders = append_record<CheckpointOrder>(out, book.total_orders());
+    book.for_each_order([&orders](const Order& order) {
+        CheckpointOrder& entry = *orders++;
+        std::memset(&entry, 0, sizeof(entry));
+        entry.order_id = order.order_id;
+        entry.price = order.price;
+        entry.quantity = order.quantity;
+        entry.timestamp = order.timestamp;
+        entry.priority = order.priority;
+        entry.side = order.side;
+    });
+}
+
+size_t serialized_book_size(const EnhancedOrderBook& book) {
+    return sizeof(CheckpointBook) +
+           sizeof(PriceLevel) * (book.bid_levels() + book.ask_levels()) +
+           sizeof(CheckpointOrder) * book.total_orders();
+}
+
+void seal_checkpoint(std::vector<uint8_t>& image, uint64_t feed_offset, uint64_t sequence) {
+    uint32_t book_count = 0;
+    uint64_t order_count = 0;
+    uint64_t level_count = 0;
+    
+    for (size_t offset = sizeof(CheckpointHeader); offset < image.size(); ) {
+        const CheckpointBook* record = reinterpret_cast<const CheckpointBook*>(image.data() + offset);
+        size_t levels = static_cast<size_t>(record->bid_levels) + record->ask_levels;
+        offset += sizeof(CheckpointBook) + sizeof(PriceLevel) * levels +
+                  sizeof(CheckpointOrder) * record->order_count;
+        book_count++;
+        order_count += record->order_count;
+        level_count += levels;
+    }
+    
+    CheckpointHeader* header = reinterpret_cast<CheckpointHeader*>(image.data());
+    std::memset(header, 0, sizeof(*header));
+    std::memcpy(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic));
+    header->version = CHECKPOINT_VERSION;
+    header->book_count = book_count;
+    header->order_count = order_count;
+    header->level_count = level_count;
+    header->feed_offset = feed_offset;
+    header->sequence = sequence;
+    header->payload_size = image.size() - sizeof(CheckpointHeader);
+    header->checksum = checksum_words(image.data() + sizeof(CheckpointHeader), header->payload_size);
+}
+
+size_t serialize_checkpoint(const ItchBookBuilder& builder, uint64_t feed_offset,
+                            uint64_t sequence, std::vector<uint8_t>& out) {
+    size_t total = sizeof(CheckpointHeader);
+    for (uint16_t locate : builder.locates()) {
+        total += serialized_book_size(*builder.book(locate));
+    }
+    
+    start_checkpoint(out);
+    out.reserve(total);
+    for (uint16_t locate : builder.locates()) {
+        serialize_book(locate, *builder.book(locate), out);
+    }
+    seal_checkpoint(out, feed_offset, sequence);
+    return out.size();
+}
+
+const uint8_t* restore_book_record(const uint8_t* cursor, const uint8_t* end,
+                                   ItchBookBuilder& builder, std::vector<Order>& scratch) {
+    if (static_cast<size_t>(end - cursor) < sizeof(CheckpointBook)) return nullptr;
+    const CheckpointBook* record = reinterpret_cast<const CheckpointBook*>(cursor);
+    cursor += sizeof(CheckpointBook);
+    
+    size_t levels = static_cast<size_t>(record->bid_levels) + record->ask_levels;
+    if (static_cast<size_t>(end - cursor) / sizeof(PriceLevel) < levels) return nullptr;
+    const PriceLevel* bids = reinterpret_cast<const PriceLevel*>(cursor);
+    const PriceLevel* asks = bids + record->bid_levels;
+    cursor += sizeof(PriceLevel) * levels;
+    
+    if (static_cast<size_t>(end - cursor) / sizeof(CheckpointOrder) < record->order_count) return nullptr;
+    const CheckpointOrder* entries = reinterpret_cast<const CheckpointOrder*>(cursor);
+    cursor += sizeof(CheckpointOrder) * record->order_count;
+    
+    scratch.resize(record->order_count);
+    for (size_t i = 0; i < scratch.size(); ++i) {
+        Order& order = scratch[i];
+        order.order_id = entries[i].order_id;
+        order.side = entries[i].side;
+        order.price = entries[i].price;
+        order.quantity = entries[i].quantity;
+        order.timestamp = entries[i].timestamp;
+        order.priority = entries[i].priority;
+    }
+    
+    const EnhancedOrderBook& book = builder.restore_book(record->stock_locate, SymbolId(record->symbol),
+                                                         record->counters, scratch.data(), scratch.size());
+    
+    // Levels are rebuilt from the orders; the stored ones catch an image that disagrees with itself.
+    if (book.bid_levels() != record->bid_levels || book.ask_levels() != record->ask_levels) {
+        return nullptr;
+    }
+    if ((record->bid_levels > 0 && (book.top().bid_price != bids[0].price ||
+                                    book.top().bid_size != bids[0].size)) ||
+        (record->ask_levels > 0 && (book.top().ask_price != asks[0].price ||
+                                    book.top().ask_size != asks[0].size))) {
+        return nullptr;
+    }
+    
+    return cursor;
+}
+
+bool write_checkpoint_file(const std::string& path, const uint8_t* data, size_t size) {
+    // Write beside the target and rename over it, so a crash mid-write leaves
+    // the previous checkpoint intact.
+    std::string temp = path + ".tmp";
+    
+#ifdef _WIN32
+    HANDLE file = CreateFileA(temp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    
+    bool ok = true;
+    while (ok && size > 0) {
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+        DWORD written = 0;
+        ok = WriteFile(file, data, chunk, &written, nullptr) && written > 0;
+        data += written;
+        size -= written;
+    }
+    ok = ok && FlushFileBuffers(file);
+    CloseHandle(file);
+    
+    return ok && MoveFileExA(temp.c_str(), path.c_str(),
+                             MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        return false;
+    }
+    
+    bool ok = true;
+    while (ok && size > 0) {
+        ssize_t written = write(fd, data, size);
+        ok = written > 0;
+        if (ok) {
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+    ok = ok && fsync(fd) == 0;
+    close(fd);
+    
+    return ok && std::rename(temp.c_str(), path.c_str()) == 0;
+#endif
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& path, uint64_t interval_messages)
+    : path_(path)
+    , interval_(interval_messages)
+    , last_submitted_(0)
+    , pending_snapshot_(nullptr)
+    , last_snapshot_(nullptr)
+    , has_pending_(false)
+    , running_(false)
+    , written_(0)
+    , failed_(0)
+    , superseded_(0)
+    , last_bytes_(0)
+    , last_sequence_(0)
+    , last_write_ns_(0) {}
+
+CheckpointWriter::~CheckpointWriter() {
+    stop();
+}
+
+void CheckpointWriter::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return;
+    
+    running_ = true;
+    thread_ = std::thread([this]() { writer_loop(); });
+}
+
+void CheckpointWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    ready_.notify_one();
+    
+    // The writer may still be waiting for books the feed has not copied.
+    if (last_snapshot_) {
+        while (last_snapshot_->capture_next()) {}
+    }
+    thread_.join();
+}
+
+void CheckpointWriter::submit(const ItchBookBuilder& builder, uint64_t feed_offset, uint64_t sequence) {
+    last_submitted_ = sequence;
+    
+    // spare_ belongs to the feed thread between submits; swapping under the
+    // lock hands the image over and takes back whichever buffer is free.
+    serialize_checkpoint(builder, feed_offset, sequence, spare_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (has_pending_) {
+            superseded_.fetch_add(1, std::memory_order_relaxed);
+        }
+        pending_.swap(spare_);
+        has_pending_ = true;
+    }
+    ready_.notify_one();
+}
+
+bool CheckpointWriter::submit(BookSnapshotter& snapshot, uint64_t feed_offset, uint64_t sequence) {
+    last_submitted_ = sequence;
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return false;
+        }
+        // An open snapshot means the previous checkpoint is still being read out.
+        if (!snapshot.begin(feed_offset, sequence)) {
+            superseded_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        pending_snapshot_ = &snapshot;
+        last_snapshot_ = &snapshot;
+    }
+    ready_.notify_one();
+    return true;
+}
+
+bool CheckpointWriter::write_now(const ItchBookBuilder& builder, uint64_t feed_offset, uint64_t sequence) {
+    last_submitted_ = sequence;
+    
+    std::vector<uint8_t> image;
+    serialize_checkpoint(builder, feed_offset, sequence, image);
+    return write_image(image);
+}
+
+bool CheckpointWriter::write_image(const std::vector<uint8_t>& image) {
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    
+    auto start = std::chrono::steady_clock::now();
+    bool ok = write_checkpoint_file(path_, image.data(), image.size());
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    
+    if (!ok) {
+        failed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    const CheckpointHeader* header = reinterpret_cast<const CheckpointHeader*>(image.data());
+    written_.fetch_add(1, std::memory_order_relaxed);
+    last_bytes_.store(image.size(), std::memory_order_relaxed);
+    last_sequence_.store(header->sequence, std::memory_order_relaxed);
+    last_write_ns_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                         std::memory_order_relaxed);
+    return true;
+}
+
+void CheckpointWriter::writer_loop() {
+    std::vector<uint8_t> image;
+    BookSnapshotter* snapshot = nullptr;
+    
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this]() { return has_pending_ || pending_snapshot_ || !running_; });
+            snapshot = pending_snapshot_;
+            pending_snapshot_ = nullptr;
+            if (!snapshot && !has_pending_) {
+                break;
+            }
+            if (!snapshot) {
+                image.swap(pending_);
+                has_pending_ = false;
+            }
+        }
+        
+        if (snapshot) {
+            snapshot->write_image(image);
+        }
+        write_image(image);
+    }
+}
+
+CheckpointWriter::Stats CheckpointWriter::stats() const {
+    Stats stats;
+    stats.written = written_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.superseded = superseded_.load(std::memory_order_relaxed);
+    stats.last_bytes = last_bytes_.load(std::memory_order_relaxed);
+    stats.last_sequence = last_sequence_.load(std::memory_order_relaxed);
+    stats.last_write_ns = last_write_ns_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+CheckpointReader::CheckpointReader(const std::string& filename)
+    : filename_(filename)
+    , mapped_ptr_(nullptr)
+    , file_size_(0)
+    , header_(nullptr) {
+    
+#ifdef _WIN32
+    mapping_handle_ = nullptr;
+    file_handle_ = CreateFileA(filename.c_str(), GENERIC_READ,
+        FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    
+    if (file_handle_ == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open checkpoint");
+    }
+    
+    LARGE_INTEGER li;
+    GetFileSizeEx(file_handle_, &li);
+    file_size_ = li.QuadPart;
+    
+    if (file_size_ > 0) {
+        mapping_handle_ = CreateFileMappingA(file_handle_, nullptr,
+            PAGE_READONLY, 0, 0, nullptr);
+    }
+    if (mapping_handle_) {
+        mapped_ptr_ = MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0);
+    }
+#else
+    fd_ = open(filename.c_str(), O_RDONLY);
+    if (fd_ == -1) {
+        throw std::runtime_error("Cannot open checkpoint");
+    }
+    
+    file_size_ = lseek(fd_, 0, SEEK_END);
+    lseek(fd_, 0, SEEK_SET);
+    
+    if (file_size_ > 0) {
+        mapped_ptr_ = mmap(nullptr, file_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (mapped_ptr_ == MAP_FAILED) {
+            mapped_ptr_ = nullptr;
+        }
+    }
+#endif
+    
+    const uint8_t* data = static_cast<const uint8_t*>(mapped_ptr_);
+    header_ = static_cast<const CheckpointHeader*>(mapped_ptr_);
+    
+    const char* error = nullptr;
+    if (!data || file_size_ < sizeof(CheckpointHeader)) {
+        error = "Checkpoint is truncated";
+    } else if (std::memcmp(header_->magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0 ||
+               header_->version != CHECKPOINT_VERSION) {
+        error = "Unsupported checkpoint format";
+    } else if (header_->payload_size != file_size_ - sizeof(CheckpointHeader)) {
+        error = "Checkpoint is truncated";
+    } else if (checksum_words(data + sizeof(CheckpointHeader), header_->payload_size) != header_->checksum) {
+        error = "Checkpoint checksum mismatch";
+    }
+    
+    if (error) {
+        unmap();
+        throw std::runtime_error(error);
+    }
+}
+
+CheckpointReader::~CheckpointReader() {
+    unmap();
+}
+
+void CheckpointReader::unmap() {
+#ifdef _WIN32
+    if (mapped_ptr_) {
+        UnmapViewOfFile(mapped_ptr_);
+        mapped_ptr_ = nullptr;
+    }
+    if (mapping_handle_) {
+        CloseHandle(mapping_handle_);
+        mapping_handle_ = nullptr;
+    }
+    if (file_handle_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(file_handle_);
+        file_handle_ = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (mapped_ptr_) {
+        munmap(const_cast<void*>(mapped_ptr_), file_size_);
+        mapped_ptr_ = nullptr;
+    }
+    if (fd_ != -1) {
+        close(fd_);
+        fd_ = -1;
+    }
+#endif
+}
+
+bool CheckpointReader::restore(ItchBookBuilder& builder) const {
+    const uint8_t* cursor = static_cast<const uint8_t*>(mapped_ptr_) + sizeof(CheckpointHeader);
+    const uint8_t* end = cursor + header_->payload_size;
+    std::vector<Order> orders;
+    
+    builder.clear();
+    
+    for (uint32_t i = 0; i < header_->book_count; ++i) {
+        cursor = restore_book_record(cursor, end, builder, orders);
+        if (!cursor) return false;
+    }
+    
+    return cursor == end;
+}
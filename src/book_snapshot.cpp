@@ -0,0 +1,144 @@
+#include "book_snapshot.hpp"
+#include <chrono>
+#include <thread>
+
+BookSnapshotter::BookSnapshotter(ItchBookBuilder& builder)
+    : builder_(builder)
+    , captured_(new std::atomic<uint64_t>[ItchBookBuilder::MAX_LOCATES])
+    , member_epoch_(ItchBookBuilder::MAX_LOCATES, 0)
+    , copies_(ItchBookBuilder::MAX_LOCATES)
+    , sweep_(0)
+    , active_epoch_(0)
+    , next_epoch_(0)
+    , feed_offset_(0)
+    , sequence_(0)
+    , snapshots_(0)
+    , feed_copies_(0)
+    , sweep_copies_(0)
+    , feed_copy_ns_(0)
+    , max_feed_copy_ns_(0)
+    , copy_bytes_(0)
+    , reader_wait_ns_(0) {
+    
+    for (size_t i = 0; i < ItchBookBuilder::MAX_LOCATES; ++i) {
+        captured_[i].store(0, std::memory_order_relaxed);
+    }
+    builder_.set_snapshotter(this);
+}
+
+BookSnapshotter::~BookSnapshotter() {
+    builder_.set_snapshotter(nullptr);
+}
+
+bool BookSnapshotter::begin(uint64_t feed_offset, uint64_t sequence) {
+    if (active_epoch_.load(std::memory_order_acquire) != 0) {
+        return false;
+    }
+    
+    uint64_t epoch = ++next_epoch_;
+    locates_ = builder_.locates();
+    for (uint16_t locate : locates_) {
+        member_epoch_[locate] = epoch;
+        // A book is copied before its first write, so its size is fixed from
+        // here on. Buffers keep their capacity between snapshots.
+        std::vector<uint8_t>& copy = copies_[locate];
+        copy.clear();
+        copy.reserve(serialized_book_size(*builder_.book(locate)));
+    }
+    sweep_ = 0;
+    feed_offset_ = feed_offset;
+    sequence_ = sequence;
+    snapshots_.fetch_add(1, std::memory_order_relaxed);
+    
+    // Everything the feed wrote so far is visible to a reader that sees the epoch.
+    active_epoch_.store(epoch, std::memory_order_release);
+    return true;
+}
+
+void BookSnapshotter::on_write(uint16_t stock_locate, uint64_t epoch) {
+    if (member_epoch_[stock_locate] == epoch &&
+        captured_[stock_locate].load(std::memory_order_relaxed) != epoch) {
+        capture(stock_locate, epoch);
+        feed_copies_.fetch_add(1, std::memory_order_relaxed);
+    }
+    capture_next();
+}
+
+bool BookSnapshotter::capture_next() {
+    uint64_t epoch = active_epoch_.load(std::memory_order_acquire);
+    if (epoch == 0) return false;
+    
+    while (sweep_ < locates_.size()) {
+        uint16_t locate = locates_[sweep_++];
+        if (captured_[locate].load(std::memory_order_relaxed) != epoch) {
+            capture(locate, epoch);
+            sweep_copies_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void BookSnapshotter::capture(uint16_t stock_locate, uint64_t epoch) {
+    auto copy_start = std::chrono::steady_clock::now();
+    std::vector<uint8_t>& copy = copies_[stock_locate];
+    serialize_book(stock_locate, *builder_.book(stock_locate), copy);
+    size_t bytes = copy.size();
+    uint64_t copy_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - copy_start).count();
+    
+    // After this store the copy belongs to the reader until finish().
+    captured_[stock_locate].store(epoch, std::memory_order_release);
+    
+    copy_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    feed_copy_ns_.fetch_add(copy_ns, std::memory_order_relaxed);
+    if (copy_ns > max_feed_copy_ns_.load(std::memory_order_relaxed)) {
+        max_feed_copy_ns_.store(copy_ns, std::memory_order_relaxed);
+    }
+}
+
+const std::vector<uint8_t>& BookSnapshotter::wait_for(uint16_t stock_locate, uint64_t epoch) {
+    std::atomic<uint64_t>& state = captured_[stock_locate];
+    if (state.load(std::memory_order_acquire) != epoch) {
+        auto wait_start = std::chrono::steady_clock::now();
+        while (state.load(std::memory_order_acquire) != epoch) {
+            std::this_thread::yield();
+        }
+        auto waited = std::chrono::steady_clock::now() - wait_start;
+        reader_wait_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count(),
+                                  std::memory_order_relaxed);
+    }
+    return copies_[stock_locate];
+}
+
+size_t BookSnapshotter::write_image(std::vector<uint8_t>& image) {
+    uint64_t epoch = active_epoch_.load(std::memory_order_acquire);
+    if (epoch == 0) return 0;
+    
+    start_checkpoint(image);
+    for (uint16_t locate : locates_) {
+        const std::vector<uint8_t>& copy = wait_for(locate, epoch);
+        image.insert(image.end(), copy.begin(), copy.end());
+    }
+    seal_checkpoint(image, feed_offset_, sequence_);
+    
+    finish();
+    return image.size();
+}
+
+// The feed reuses the copy buffers once it sees the epoch cleared.
+void BookSnapshotter::finish() {
+    active_epoch_.store(0, std::memory_order_release);
+}
+
+BookSnapshotter::Stats BookSnapshotter::stats() const {
+    Stats stats;
+    stats.snapshots = snapshots_.load(std::memory_order_relaxed);
+    stats.feed_copies = feed_copies_.load(std::memory_order_relaxed);
+    stats.sweep_copies = sweep_copies_.load(std::memory_order_relaxed);
+    stats.feed_copy_ns = feed_copy_ns_.load(std::memory_order_relaxed);
+    stats.max_feed_copy_ns = max_feed_copy_ns_.load(std::memory_order_relaxed);
+    stats.copy_bytes = copy_bytes_.load(std::memory_order_relaxed);
+    stats.reader_wait_ns = reader_wait_ns_.load(std::memory_order_relaxed);
+    return stats;
+}
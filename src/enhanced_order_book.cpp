@@ -1,130 +1,217 @@
 #include "enhanced_order_book.hpp"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
-EnhancedOrderBook::EnhancedOrderBook(const std::string& symbol)
+EnhancedOrderBook::EnhancedOrderBook(const std::string& symbol, MemoryProvider* provider)
+    : EnhancedOrderBook(SymbolId::from_string(symbol), provider) {}
+
+EnhancedOrderBook::EnhancedOrderBook(SymbolId symbol, MemoryProvider* provider)
     : symbol_(symbol)
+    , node_pool_(provider)
+    , bids_(LevelAllocator(&node_pool_))
+    , asks_(LevelAllocator(&node_pool_))
+    , orders_(OrderMap::allocator_type(&node_pool_))
     , last_update_time_(0)
     , message_count_(0)
     , total_bid_quantity_(0)
-    , total_ask_quantity_(0) {}
+    , total_ask_quantity_(0)
+    , next_priority_(0)
+    , next_level_order_id_(UINT64_MAX)
+    , depth_window_changed_(false)
+    , snapshot_()
+    , snapshot_dirty_(true) {}
 
-bool EnhancedOrderBook::add_order(uint64_t order_id, char side, int64_t price,
-                                  uint64_t quantity, uint64_t timestamp) {
+BookUpdate EnhancedOrderBook::add_order(uint64_t order_id, char side, int64_t price,
+                                        uint64_t quantity, uint64_t timestamp) {
     if (orders_.find(order_id) != orders_.end()) {
-        return false;
+        return BookUpdate();
     }
     
     Order order(order_id, symbol_, side, price, quantity, timestamp);
+    order.priority = next_priority_++;
     orders_[order_id] = order;
     
     add_to_price_level(order);
     
-    last_update_time_ = timestamp;
-    message_count_++;
+    return BookUpdate(true, level_changed(side, price, timestamp));
+}
+
+BookUpdate EnhancedOrderBook::add_attributed_order(uint64_t order_id, char side, int64_t price,
+                                                   uint64_t quantity, uint64_t timestamp,
+                                                   const char* mpid) {
+    BookUpdate update = add_order(order_id, side, price, quantity, timestamp);
+    if (!update) {
+        return update;
+    }
     
-    return true;
+    uint32_t packed;
+    std::memcpy(&packed, mpid, sizeof(packed));
+    
+    if (std::find(watched_mpids_.begin(), watched_mpids_.end(), packed) != watched_mpids_.end()) {
+        const Order& order = orders_.find(order_id)->second;
+        const PriceLevel& level = (side == 'B' || side == 'b') ? bids_.at(price) : asks_.at(price);
+        start_watching(order, level.size - quantity, level.order_count - 1);
+    }
+    
+    return update;
 }
 
-bool EnhancedOrderBook::modify_order(uint64_t order_id, uint64_t new_quantity, 
-                                     uint64_t timestamp) {
+BookUpdate EnhancedOrderBook::add_bid(int64_t price, uint64_t quantity, uint64_t timestamp) {
+    return add_order(next_level_order_id_--, 'B', price, quantity, timestamp);
+}
+
+BookUpdate EnhancedOrderBook::add_ask(int64_t price, uint64_t quantity, uint64_t timestamp) {
+    return add_order(next_level_order_id_--, 'S', price, quantity, timestamp);
+}
+
+BookUpdate EnhancedOrderBook::modify_order(uint64_t order_id, uint64_t new_quantity, 
+                                           uint64_t timestamp) {
     auto it = orders_.find(order_id);
     if (it == orders_.end()) {
-        return false;
+        return BookUpdate();
     }
     
     Order& order = it->second;
+    char side = order.side;
+    int64_t price = order.price;
+    uint64_t old_quantity = order.quantity;
     remove_from_price_level(order);
     
-    order.quantity = new_quantity;
-    order.timestamp = timestamp;
-    
-    if (new_quantity > 0) {
+    if (new_quantity == 0) {
+        on_order_reduced(order, old_quantity, true);
+        orders_.erase(it);
+    } else if (new_quantity <= old_quantity) {
+        on_order_reduced(order, old_quantity - new_quantity, false);
+        order.quantity = new_quantity;
+        order.timestamp = timestamp;
         add_to_price_level(order);
     } else {
-        orders_.erase(it);
+        // A size increase loses time priority: the order rejoins the back of its level.
+        bool was_watched = watched_.find(order_id) != watched_.end();
+        on_order_reduced(order, old_quantity, true);
+        
+        order.quantity = new_quantity;
+        order.timestamp = timestamp;
+        order.priority = next_priority_++;
+        add_to_price_level(order);
+        
+        if (was_watched) {
+            const PriceLevel& level = (order.side == 'B' || order.side == 'b') ?
+                bids_.at(order.price) : asks_.at(order.price);
+            start_watching(order, level.size - new_quantity, level.order_count - 1);
+        }
     }
     
-    last_update_time_ = timestamp;
-    message_count_++;
-    
-    return true;
+    return BookUpdate(true, level_changed(side, price, timestamp));
 }
 
-bool EnhancedOrderBook::cancel_order(uint64_t order_id, uint64_t cancelled_quantity,
-                                     uint64_t timestamp) {
+BookUpdate EnhancedOrderBook::cancel_order(uint64_t order_id, uint64_t cancelled_quantity,
+                                           uint64_t timestamp) {
     auto it = orders_.find(order_id);
     if (it == orders_.end()) {
-        return false;
+        return BookUpdate();
     }
     
     Order& order = it->second;
+    char side = order.side;
+    int64_t price = order.price;
     remove_from_price_level(order);
     
     if (order.quantity > cancelled_quantity) {
+        on_order_reduced(order, cancelled_quantity, false);
         order.quantity -= cancelled_quantity;
         order.timestamp = timestamp;
         add_to_price_level(order);
     } else {
+        on_order_reduced(order, order.quantity, true);
         orders_.erase(it);
     }
     
-    last_update_time_ = timestamp;
-    message_count_++;
-    
-    return true;
+    return BookUpdate(true, level_changed(side, price, timestamp));
 }
 
-bool EnhancedOrderBook::delete_order(uint64_t order_id, uint64_t timestamp) {
+BookUpdate EnhancedOrderBook::delete_order(uint64_t order_id, uint64_t timestamp) {
     auto it = orders_.find(order_id);
     if (it == orders_.end()) {
-        return false;
+        return BookUpdate();
     }
     
+    char side = it->second.side;
+    int64_t price = it->second.price;
     remove_from_price_level(it->second);
+    on_order_reduced(it->second, it->second.quantity, true);
     orders_.erase(it);
     
-    last_update_time_ = timestamp;
-    message_count_++;
-    
-    return true;
+    return BookUpdate(true, level_changed(side, price, timestamp));
 }
 
-bool EnhancedOrderBook::execute_order(uint64_t order_id, uint64_t executed_quantity,
-                                      uint64_t timestamp) {
+BookUpdate EnhancedOrderBook::execute_order(uint64_t order_id, uint64_t executed_quantity,
+                                            uint64_t timestamp) {
     auto it = orders_.find(order_id);
     if (it == orders_.end()) {
-        return false;
+        return BookUpdate();
     }
     
     Order& order = it->second;
+    char side = order.side;
+    int64_t price = order.price;
     remove_from_price_level(order);
     
     if (order.quantity > executed_quantity) {
+        on_order_reduced(order, executed_quantity, false);
         order.quantity -= executed_quantity;
         order.timestamp = timestamp;
         add_to_price_level(order);
     } else {
+        on_order_reduced(order, order.quantity, true);
         orders_.erase(it);
     }
     
-    last_update_time_ = timestamp;
-    message_count_++;
-    
-    return true;
+    return BookUpdate(true, level_changed(side, price, timestamp));
 }
 
-bool EnhancedOrderBook::replace_order(uint64_t old_order_id, uint64_t new_order_id,
-                                      uint64_t new_quantity, int64_t new_price,
-                                      uint64_t timestamp) {
+BookUpdate EnhancedOrderBook::replace_order(uint64_t old_order_id, uint64_t new_order_id,
+                                            uint64_t new_quantity, int64_t new_price,
+                                            uint64_t timestamp) {
     auto it = orders_.find(old_order_id);
     if (it == orders_.end()) {
-        return false;
+        return BookUpdate();
     }
     
     char side = it->second.side;
-    delete_order(old_order_id, timestamp);
-    return add_order(new_order_id, side, new_price, new_quantity, timestamp);
+    int64_t old_price = it->second.price;
+    bool was_watched = watched_.find(old_order_id) != watched_.end();
+    
+    // Both halves land before anything is published, so readers never see the
+    // book with the old order gone and the new one not yet in.
+    remove_from_price_level(it->second);
+    on_order_reduced(it->second, it->second.quantity, true);
+    orders_.erase(it);
+    
+    if (orders_.find(new_order_id) != orders_.end()) {
+        uint8_t changes = refresh_top(side, old_price);
+        publish_update(changes, timestamp);
+        return BookUpdate(false, changes);
+    }
+    
+    Order replacement(new_order_id, symbol_, side, new_price, new_quantity, timestamp);
+    replacement.priority = next_priority_++;
+    orders_[new_order_id] = replacement;
+    add_to_price_level(replacement);
+    
+    uint8_t changes = refresh_top(side, old_price);
+    changes |= refresh_top(side, new_price);
+    publish_update(changes, timestamp);
+    
+    if (was_watched) {
+        const Order& order = orders_.find(new_order_id)->second;
+        const PriceLevel& level = (side == 'B' || side == 'b') ?
+            bids_.at(new_price) : asks_.at(new_price);
+        start_watching(order, level.size - new_quantity, level.order_count - 1);
+    }
+    
+    return BookUpdate(true, changes);
 }
 
 std::optional<int64_t> EnhancedOrderBook::best_bid() const {
@@ -173,32 +260,39 @@ double EnhancedOrderBook::mid_price() const {
     return (*bid + *ask) / 20000.0;
 }
 
-OrderBookSnapshot EnhancedOrderBook::snapshot() const {
-    OrderBookSnapshot snap;
-    snap.symbol = symbol_;
-    snap.timestamp = last_update_time_;
-    
-    auto bid = best_bid();
-    auto ask = best_ask();
-    auto bid_sz = best_bid_size();
-    auto ask_sz = best_ask_size();
-    
-    snap.best_bid = bid.value_or(0);
-    snap.best_ask = ask.value_or(0);
-    snap.best_bid_size = bid_sz.value_or(0);
-    snap.best_ask_size = ask_sz.value_or(0);
-    snap.spread = spread();
-    snap.imbalance = imbalance();
-    snap.bid_levels = bids_.size();
-    snap.ask_levels = asks_.size();
-    
-    return snap;
+const OrderBookSnapshot& EnhancedOrderBook::snapshot() const {
+    if (!snapshot_dirty_) return snapshot_;
+    
+    snapshot_.symbol = symbol_;
+    snapshot_.timestamp = last_update_time_;
+    snapshot_.best_bid = top_.bid_price;
+    snapshot_.best_ask = top_.ask_price;
+    snapshot_.best_bid_size = top_.bid_size;
+    snapshot_.best_ask_size = top_.ask_size;
+    snapshot_.spread = spread();
+    snapshot_.imbalance = imbalance();
+    snapshot_.bid_levels = bids_.size();
+    snapshot_.ask_levels = asks_.size();
+    snapshot_dirty_ = false;
+    
+    return snapshot_;
+}
+
+const Order* EnhancedOrderBook::find_order(uint64_t order_id) const {
+    auto it = orders_.find(order_id);
+    return it != orders_.end() ? &it->second : nullptr;
 }
 
 std::vector<PriceLevel> EnhancedOrderBook::get_bid_depth(size_t levels) const {
     std::vector<PriceLevel> result;
     result.reserve(std::min(levels, bids_.size()));
     
+    if (levels <= DEPTH_LEVELS) {
+        LevelSpan depth = bid_depth_.span();
+        result.assign(depth.begin(), depth.begin() + std::min(levels, depth.size));
+        return result;
+    }
+    
     size_t count = 0;
     for (const auto& [price, level] : bids_) {
         if (count >= levels) break;
@@ -213,6 +307,12 @@ std::vector<PriceLevel> EnhancedOrderBook::get_ask_depth(size_t levels) const {
     std::vector<PriceLevel> result;
     result.reserve(std::min(levels, asks_.size()));
     
+    if (levels <= DEPTH_LEVELS) {
+        LevelSpan depth = ask_depth_.span();
+        result.assign(depth.begin(), depth.begin() + std::min(levels, depth.size));
+        return result;
+    }
+    
     size_t count = 0;
     for (const auto& [price, level] : asks_) {
         if (count >= levels) break;
@@ -223,6 +323,32 @@ std::vector<PriceLevel> EnhancedOrderBook::get_ask_depth(size_t levels) const {
     return result;
 }
 
+template<typename Window, typename Map>
+static LevelSpan copy_depth(const Window& window, const Map& levels, size_t count, Arena& arena) {
+    count = std::min(count, levels.size());
+    PriceLevel* out = arena.allocate_array<PriceLevel>(count);
+    
+    if (count <= window.size()) {
+        LevelSpan depth = window.span();
+        std::copy(depth.begin(), depth.begin() + count, out);
+        return LevelSpan(out, count);
+    }
+    
+    size_t i = 0;
+    for (auto it = levels.begin(); i < count; ++it) {
+        out[i++] = it->second;
+    }
+    return LevelSpan(out, count);
+}
+
+LevelSpan EnhancedOrderBook::get_bid_depth(size_t levels, Arena& arena) const {
+    return copy_depth(bid_depth_, bids_, levels, arena);
+}
+
+LevelSpan EnhancedOrderBook::get_ask_depth(size_t levels, Arena& arena) const {
+    return copy_depth(ask_depth_, asks_, levels, arena);
+}
+
 bool EnhancedOrderBook::has_crossing() const {
     auto bid = best_bid();
     auto ask = best_ask();
@@ -232,14 +358,191 @@ bool EnhancedOrderBook::has_crossing() const {
     return *bid >= *ask;
 }
 
+void EnhancedOrderBook::watch_mpid(const char* mpid) {
+    uint32_t packed;
+    std::memcpy(&packed, mpid, sizeof(packed));
+    
+    if (std::find(watched_mpids_.begin(), watched_mpids_.end(), packed) == watched_mpids_.end()) {
+        watched_mpids_.push_back(packed);
+    }
+}
+
+bool EnhancedOrderBook::watch_order(uint64_t order_id) {
+    auto it = orders_.find(order_id);
+    if (it == orders_.end()) {
+        return false;
+    }
+    
+    const Order& order = it->second;
+    bool is_bid = order.side == 'B' || order.side == 'b';
+    
+    // One-off O(orders) walk to seed the position; every later update is incremental.
+    uint64_t shares_ahead = 0;
+    uint64_t orders_ahead = 0;
+    for (const auto& [id, other] : orders_) {
+        bool other_bid = other.side == 'B' || other.side == 'b';
+        if (other_bid == is_bid && other.price == order.price &&
+            other.priority < order.priority) {
+            shares_ahead += other.quantity;
+            orders_ahead++;
+        }
+    }
+    
+    start_watching(order, shares_ahead, orders_ahead);
+    return true;
+}
+
+void EnhancedOrderBook::unwatch_order(uint64_t order_id) {
+    auto it = watched_.find(order_id);
+    if (it != watched_.end()) {
+        stop_watching(it->second);
+    }
+}
+
+const QueuePosition* EnhancedOrderBook::queue_position(uint64_t order_id) const {
+    auto it = watched_.find(order_id);
+    return it != watched_.end() ? &it->second : nullptr;
+}
+
 void EnhancedOrderBook::clear() {
     bids_.clear();
     asks_.clear();
     orders_.clear();
+    watched_.clear();
+    watched_bid_levels_.clear();
+    watched_ask_levels_.clear();
     last_update_time_ = 0;
     message_count_ = 0;
     total_bid_quantity_ = 0;
     total_ask_quantity_ = 0;
+    next_priority_ = 0;
+    next_level_order_id_ = UINT64_MAX;
+    bid_depth_.clear();
+    ask_depth_.clear();
+    depth_window_changed_ = false;
+    top_ = TopOfBook();
+    snapshot_dirty_ = true;
+    published_top_.store(top_);
+    if (published_depth_) {
+        publish_depth();
+    }
+}
+
+BookCounters EnhancedOrderBook::counters() const {
+    BookCounters counters;
+    counters.last_update_time = last_update_time_;
+    counters.message_count = message_count_;
+    counters.next_priority = next_priority_;
+    counters.next_level_order_id = next_level_order_id_;
+    return counters;
+}
+
+void EnhancedOrderBook::restore(const BookCounters& counters, const Order* orders, size_t count) {
+    clear();
+    orders_.reserve(count);
+    
+    // Orders carry their original priorities, so queue order survives the round trip.
+    for (size_t i = 0; i < count; ++i) {
+        Order& order = orders_[orders[i].order_id];
+        order = orders[i];
+        order.symbol = symbol_;
+        add_to_price_level(order);
+    }
+    
+    last_update_time_ = counters.last_update_time;
+    message_count_ = counters.message_count;
+    next_priority_ = counters.next_priority;
+    next_level_order_id_ = counters.next_level_order_id;
+    depth_window_changed_ = false;
+    
+    top_.bid_price = bids_.empty() ? 0 : bids_.begin()->first;
+    top_.bid_size = bids_.empty() ? 0 : bids_.begin()->second.size;
+    top_.ask_price = asks_.empty() ? 0 : asks_.begin()->first;
+    top_.ask_size = asks_.empty() ? 0 : asks_.begin()->second.size;
+    top_.timestamp = last_update_time_;
+    published_top_.store(top_);
+    if (published_depth_) {
+        publish_depth();
+    }
+}
+
+void EnhancedOrderBook::enable_depth_publishing() {
+    if (!published_depth_) {
+        published_depth_ = std::make_unique<PublishedDepth>();
+        publish_depth();
+    }
+}
+
+void EnhancedOrderBook::start_watching(const Order& order, uint64_t shares_ahead,
+                                       uint64_t orders_ahead) {
+    unwatch_order(order.order_id);
+    
+    QueuePosition position;
+    position.order_id = order.order_id;
+    position.side = order.side;
+    position.price = order.price;
+    position.quantity = order.quantity;
+    position.priority = order.priority;
+    position.shares_ahead = shares_ahead;
+    position.orders_ahead = orders_ahead;
+    
+    watched_[order.order_id] = position;
+    watched_levels(order.side)[order.price].push_back(order.order_id);
+}
+
+void EnhancedOrderBook::stop_watching(const QueuePosition& position) {
+    uint64_t order_id = position.order_id;
+    auto& levels = watched_levels(position.side);
+    auto level_it = levels.find(position.price);
+    
+    if (level_it != levels.end()) {
+        auto& ids = level_it->second;
+        auto id_it = std::find(ids.begin(), ids.end(), order_id);
+        if (id_it != ids.end()) {
+            *id_it = ids.back();
+            ids.pop_back();
+        }
+        if (ids.empty()) {
+            levels.erase(level_it);
+        }
+    }
+    
+    watched_.erase(order_id);
+}
+
+void EnhancedOrderBook::on_order_reduced(const Order& order, uint64_t reduced_quantity,
+                                         bool removed) {
+    if (watched_.empty()) {
+        return;
+    }
+    
+    auto self = watched_.find(order.order_id);
+    if (self != watched_.end()) {
+        if (removed) {
+            stop_watching(self->second);
+        } else {
+            self->second.quantity -= reduced_quantity;
+        }
+    }
+    
+    // Our own orders behind this one move up too.
+    auto& levels = watched_levels(order.side);
+    auto level_it = levels.find(order.price);
+    if (level_it == levels.end()) {
+        return;
+    }
+    
+    for (uint64_t watched_id : level_it->second) {
+        if (watched_id == order.order_id) continue;
+        
+        QueuePosition& position = watched_.find(watched_id)->second;
+        if (order.priority < position.priority) {
+            position.shares_ahead -= std::min(position.shares_ahead, reduced_quantity);
+            if (removed && position.orders_ahead > 0) {
+                position.orders_ahead--;
+            }
+        }
+    }
 }
 
 void EnhancedOrderBook::remove_from_price_level(const Order& order) {
@@ -256,6 +559,9 @@ void EnhancedOrderBook::remove_from_price_level(const Order& order) {
             }
             if (level.size == 0 || level.order_count == 0) {
                 bids_.erase(it);
+                depth_window_changed_ |= bid_depth_.remove(order.price, bids_);
+            } else {
+                depth_window_changed_ |= bid_depth_.update(level);
             }
         }
     } else {
@@ -271,6 +577,9 @@ void EnhancedOrderBook::remove_from_price_level(const Order& order) {
             }
             if (level.size == 0 || level.order_count == 0) {
                 asks_.erase(it);
+                depth_window_changed_ |= ask_depth_.remove(order.price, asks_);
+            } else {
+                depth_window_changed_ |= ask_depth_.update(level);
             }
         }
     }
@@ -283,11 +592,73 @@ void EnhancedOrderBook::add_to_price_level(const Order& order) {
         level.size += order.quantity;
         level.order_count++;
         total_bid_quantity_ += order.quantity;
+        depth_window_changed_ |= bid_depth_.update(level);
     } else {
         auto& level = asks_[order.price];
         level.price = order.price;
         level.size += order.quantity;
         level.order_count++;
         total_ask_quantity_ += order.quantity;
+        depth_window_changed_ |= ask_depth_.update(level);
+    }
+}
+
+uint8_t EnhancedOrderBook::level_changed(char side, int64_t price, uint64_t timestamp) {
+    uint8_t changes = refresh_top(side, price);
+    publish_update(changes, timestamp);
+    return changes;
+}
+
+uint8_t EnhancedOrderBook::refresh_top(char side, int64_t price) {
+    int64_t best;
+    uint64_t size;
+    int64_t* top_price;
+    uint64_t* top_size;
+    
+    // Levels behind the cached best cannot move the top; only re-read when the event is at or through it.
+    if (side == 'B' || side == 'b') {
+        if (top_.bid_size != 0 && price < top_.bid_price) return DEPTH_CHANGED;
+        best = bids_.empty() ? 0 : bids_.begin()->first;
+        size = bids_.empty() ? 0 : bids_.begin()->second.size;
+        top_price = &top_.bid_price;
+        top_size = &top_.bid_size;
+    } else {
+        if (top_.ask_size != 0 && price > top_.ask_price) return DEPTH_CHANGED;
+        best = asks_.empty() ? 0 : asks_.begin()->first;
+        size = asks_.empty() ? 0 : asks_.begin()->second.size;
+        top_price = &top_.ask_price;
+        top_size = &top_.ask_size;
+    }
+    
+    uint8_t changes = DEPTH_CHANGED;
+    if (best != *top_price) changes |= BBO_PRICE_CHANGED;
+    if (size != *top_size) changes |= BBO_SIZE_CHANGED;
+    *top_price = best;
+    *top_size = size;
+    return changes;
+}
+
+// Runs once per book operation, after every level it touches has been updated.
+void EnhancedOrderBook::publish_update(uint8_t changes, uint64_t timestamp) {
+    last_update_time_ = timestamp;
+    message_count_++;
+    snapshot_dirty_ = true;
+    
+    if (published_depth_ && depth_window_changed_) {
+        publish_depth();
     }
+    depth_window_changed_ = false;
+    
+    if (changes != DEPTH_CHANGED) {
+        top_.timestamp = timestamp;
+        published_top_.store(top_);
+    }
+}
+
+void EnhancedOrderBook::publish_depth() {
+    DepthSnapshot<DEPTH_LEVELS> depth;
+    depth.timestamp = last_update_time_;
+    depth.bid_count = bid_depth_.copy_to(depth.bids);
+    depth.ask_count = ask_depth_.copy_to(depth.asks);
+    published_depth_->store(depth);
 }
@@ -0,0 +1,293 @@
+#include "itch_book_builder.hpp"
+#include "book_snapshot.hpp"
+#include <algorithm>
+
+ItchBookBuilder::ItchBookBuilder(MemoryProvider* provider)
+    : books_(MAX_LOCATES)
+    , snapshotter_(nullptr)
+    , provider_(provider) {}
+
+BookUpdate ItchBookBuilder::process(const itch::Message& msg) {
+    stats_.messages++;
+    if (snapshotter_) {
+        snapshotter_->before_write(std::visit([](const auto& m) -> uint16_t { return m.stock_locate; }, msg));
+    }
+    return std::visit([this](const auto& m) { return apply(m); }, msg);
+}
+
+// Events from other venues carry no locate and leave the books untouched.
+BookUpdate ItchBookBuilder::process(const MarketEvent& event) {
+    stats_.messages++;
+    if (event.stock_locate == 0) {
+        return BookUpdate();
+    }
+    if (snapshotter_) {
+        snapshotter_->before_write(event.stock_locate);
+    }
+    
+    char stock[SymbolId::LENGTH];
+    EnhancedOrderBook* book = books_[event.stock_locate].get();
+    BookUpdate update;
+    switch (event.type) {
+        case EventType::SymbolDirectory:
+            event.symbol.copy_to(stock);
+            create_book(event.stock_locate, stock);
+            return BookUpdate(true, BOOK_UNCHANGED);
+        case EventType::AddOrder:
+            if (!book) {
+                event.symbol.copy_to(stock);
+                book = &create_book(event.stock_locate, stock);
+            }
+            update = (event.flags & EVENT_ATTRIBUTED)
+                ? book->add_attributed_order(event.order_ref, event.side, event.price, event.quantity,
+                                             event.exchange_timestamp, event.attribution)
+                : book->add_order(event.order_ref, event.side, event.price, event.quantity,
+                                  event.exchange_timestamp);
+            break;
+        case EventType::OrderExecuted: {
+            if (!(book = find_book(event.stock_locate))) return BookUpdate();
+            const Order* order = execution_callback_ ? book->find_order(event.order_ref) : nullptr;
+            int64_t print_price = (event.flags & EVENT_PRICED) ? event.price : (order ? order->price : 0);
+            update = book->execute_order(event.order_ref, event.quantity, event.exchange_timestamp);
+            if (update && order && (event.flags & EVENT_PRINTABLE)) {
+                execution_callback_(event.stock_locate, print_price, event.quantity, event.exchange_timestamp);
+            }
+            break;
+        }
+        case EventType::OrderCancel:
+            if (!(book = find_book(event.stock_locate))) return BookUpdate();
+            update = book->cancel_order(event.order_ref, event.quantity, event.exchange_timestamp);
+            break;
+        case EventType::OrderDelete:
+            if (!(book = find_book(event.stock_locate))) return BookUpdate();
+            update = book->delete_order(event.order_ref, event.exchange_timestamp);
+            break;
+        case EventType::OrderReplace:
+            if (!(book = find_book(event.stock_locate))) return BookUpdate();
+            update = book->replace_order(event.order_ref, event.new_order_ref, event.quantity,
+                                         event.price, event.exchange_timestamp);
+            break;
+        case EventType::Trade:
+            if (execution_callback_) {
+                execution_callback_(event.stock_locate, event.price, event.quantity, event.exchange_timestamp);
+            }
+            return BookUpdate();
+        default:
+            return BookUpdate();
+    }
+    
+    if (!update) {
+        stats_.unknown_order++;
+    }
+    return update;
+}
+
+size_t ItchBookBuilder::process_buffer(const uint8_t* data, size_t size) {
+    itch::Parser parser(data, size);
+    size_t processed = 0;
+    
+    while (parser.has_more()) {
+        auto msg = parser.parse_next();
+        if (msg) {
+            process(*msg);
+            processed++;
+        }
+    }
+    
+    return processed;
+}
+
+void ItchBookBuilder::set_execution_callback(ExecutionCallback callback) {
+    execution_callback_ = callback;
+}
+
+void ItchBookBuilder::watch_mpid(const char* mpid) {
+    std::array<char, 4> packed;
+    std::copy(mpid, mpid + 4, packed.begin());
+    watched_mpids_.push_back(packed);
+    
+    for (uint16_t locate : active_locates_) {
+        books_[locate]->watch_mpid(mpid);
+    }
+}
+
+std::unique_ptr<EnhancedOrderBook> ItchBookBuilder::release_book(uint16_t stock_locate) {
+    auto& slot = books_[stock_locate];
+    if (slot) {
+        if (snapshotter_) {
+            snapshotter_->before_write(stock_locate);
+        }
+        active_locates_.erase(std::find(active_locates_.begin(), active_locates_.end(), stock_locate));
+    }
+    return std::move(slot);
+}
+
+void ItchBookBuilder::adopt_book(uint16_t stock_locate, std::unique_ptr<EnhancedOrderBook> book) {
+    if (!book) return;
+    
+    auto& slot = books_[stock_locate];
+    if (!slot) {
+        active_locates_.push_back(stock_locate);
+    }
+    for (const auto& mpid : watched_mpids_) {
+        book->watch_mpid(mpid.data());
+    }
+    slot = std::move(book);
+}
+
+EnhancedOrderBook& ItchBookBuilder::restore_book(uint16_t stock_locate, SymbolId symbol,
+                                                 const BookCounters& counters,
+                                                 const Order* orders, size_t count) {
+    char stock[SymbolId::LENGTH];
+    symbol.copy_to(stock);
+    
+    EnhancedOrderBook& book = create_book(stock_locate, stock);
+    book.restore(counters, orders, count);
+    return book;
+}
+
+void ItchBookBuilder::clear() {
+    for (uint16_t locate : active_locates_) {
+        if (snapshotter_) {
+            snapshotter_->before_write(locate);
+        }
+        books_[locate].reset();
+    }
+    active_locates_.clear();
+    stats_ = Stats();
+}
+
+EnhancedOrderBook* ItchBookBuilder::find_book(uint16_t stock_locate) {
+    EnhancedOrderBook* book = books_[stock_locate].get();
+    if (!book) {
+        stats_.unknown_locate++;
+    }
+    return book;
+}
+
+EnhancedOrderBook& ItchBookBuilder::create_book(uint16_t stock_locate, const char* stock) {
+    auto& slot = books_[stock_locate];
+    if (!slot) {
+        slot = std::make_unique<EnhancedOrderBook>(SymbolId::from_chars(stock), provider_);
+        for (const auto& mpid : watched_mpids_) {
+            slot->watch_mpid(mpid.data());
+        }
+        active_locates_.push_back(stock_locate);
+    }
+    return *slot;
+}
+
+BookUpdate ItchBookBuilder::apply(const itch::SystemEvent&) {
+    return BookUpdate();
+}
+
+BookUpdate ItchBookBuilder::apply(const itch::StockDirectory& msg) {
+    create_book(msg.stock_locate, msg.stock);
+    return BookUpdate(true, BOOK_UNCHANGED);
+}
+
+BookUpdate ItchBookBuilder::apply(const itch::AddOrder& msg) {
+    EnhancedOrderBook* book = books_[msg.stock_locate].get();
+    if (!book) {
+        book = &create_book(msg.stock_locate, msg.stock);
+    }
+    
+    BookUpdate update = book->add_order(msg.order_reference, msg.buy_sell, msg.price,
+                                        msg.shares, msg.timestamp);
+    if (!update) {
+        stats_.unknown_order++;
+    }
+    return update;
+}
+
+BookUpdate ItchBookBuilder::apply(const itch::AddOrderMPID& msg) {
+    EnhancedOrderBook* book = books_[msg.stock_locate].get();
+    if (!book) {
+        book = &create_book(msg.stock_locate, msg.stock);
+    }
+    
+    BookUpdate update = book->add_attributed_order(msg.order_reference, msg.buy_sell, msg.price,
+                                                   msg.shares, msg.timestamp, msg.attribution);
+    if (!update) {
+        stats_.unknown_order++;
+    }
+    return update;
+}
+
+BookUpdate ItchBookBuilder::apply(const itch::OrderExecuted& msg) {
+    EnhancedOrderBook* book = find_book(msg.stock_locate);
+    if (!book) return BookUpdate();
+    
+    if (execution_callback_) {
+        const Order* order = book->find_order(msg.order_reference);
+        if (order) {
+            execution_callback_(msg.stock_locate, order->price,
+                                msg.executed_shares, msg.timestamp);
+        }
+    }
+    
+    BookUpdate update = book->execute_order(msg.order_reference, msg.executed_shares, msg.timestamp);
+    if (!update) {
+        stats_.unknown_order++;
+    }
+    return update;
+}
+
+BookUpdate ItchBookBuilder::apply(const itch::OrderExecutedWithPrice& msg) {
+    EnhancedOrderBook* book = find_book(msg.stock_locate);
+    if (!book) return BookUpdate();
+    
+    // The resting order leaves the book at its own price; the print carries the cross price.
+    BookUpdate update = book->execute_order(msg.order_reference, msg.executed_shares, msg.timestamp);
+    if (!update) {
+        stats_.unknown_order++;
+        return update;
+    }
+    
+    if (execution_callback_ && msg.printable == 'Y') {
+        execution_callback_(msg.stock_locate, msg.execution_price,
+                            msg.executed_shares, msg.timestamp);
+    }
+    return update;
+}
+
+BookUpdate ItchBookBuilder::apply(const itch::OrderCancel& msg) {
+    EnhancedOrderBook* book = find_book(msg.stock_locate);
+    if (!book) return BookUpdate();
+    
+    BookUpdate update = book->cancel_order(msg.order_reference, msg.cancelled_shares, msg.timestamp);
+    if (!update) {
+        stats_.unknown_order++;
+    }
+    return update;
+}
+
+BookUpdate ItchBookBuilder::apply(const itch::OrderDelete& msg) {
+    EnhancedOrderBook* book = find_book(msg.stock_locate);
+    if (!book) return BookUpdate();
+    
+    BookUpdate update = book->delete_order(msg.order_reference, msg.timestamp);
+    if (!update) {
+        stats_.unknown_order++;
+    }
+    return update;
+}
+
+BookUpdate ItchBookBuilder::apply(const itch::OrderReplace& msg) {
+    EnhancedOrderBook* book = find_book(msg.stock_locate);
+    if (!book) return BookUpdate();
+    
+    BookUpdate update = book->replace_order(msg.original_order_reference, msg.new_order_reference,
+                                            msg.shares, msg.price, msg.timestamp);
+    if (!update) {
+        stats_.unknown_order++;
+    }
+    return update;
+}
+
+BookUpdate ItchBookBuilder::apply(const itch::Trade& msg) {
+    if (execution_callback_) {
+        execution_callback_(msg.stock_locate, msg.price, msg.shares, msg.timestamp);
+    }
+    return BookUpdate();
+}
@@ -1,15 +1,19 @@
 #include "iex_parser.hpp"
 #include "enhanced_order_book.hpp"
 #include "itch_parser.hpp"
+#include "itch_book_builder.hpp"
+#include "book_checkpoint.hpp"
 #include "order_book.hpp"
 #include "websocket_server.hpp"
 #include "tick_recorder.hpp"
 #include "replay_engine.hpp"
 #include "strategy.hpp"
 #include "lock_free_queue.hpp"
+#include "conflating_queue.hpp"
 #include "latency_tracker.hpp"
 #include "pcap_reader.hpp"
 #include "memory_pool.hpp"
+#include "memory_provider.hpp"
 #include <iostream>
 #include <fstream>
 #include <thread>
@@ -37,8 +41,10 @@ void demo_complete_system() {
     EnhancedOrderBook msft_book("MSFT");
     EnhancedOrderBook googl_book("GOOGL");
     
-    SPSCQueue<iex::QuoteUpdate> quote_queue(4096);
-    MemoryPool<iex::QuoteUpdate> message_pool;
+    // Map and prefault the queue and pool memory now rather than on the first messages.
+    MemoryProvider memory;
+    SPSCQueue<iex::QuoteUpdate> quote_queue(4096, &memory);
+    MemoryPool<iex::QuoteUpdate> message_pool(&memory);
     
     TickRecorder recorder("demo_ticks.dat");
     
@@ -47,7 +53,7 @@ void demo_complete_system() {
     strategy.set_imbalance_threshold(0.3);
     
     int signal_count = 0;
-    strategy.set_signal_callback([&signal_count](const std::string& symbol, double price, 
+    strategy.set_signal_callback([&signal_count](SymbolId symbol, double price, 
                                                    uint64_t size, bool is_buy) {
         signal_count++;
         std::cout << "[SIGNAL #" << signal_count << "] " << symbol << " " 
@@ -74,6 +80,10 @@ void demo_complete_system() {
     const size_t total_messages = 50000;
     uint64_t timestamp = 1700000000000000000ULL;
     
+    // The strategy drains only every 1000 messages; it sees the latest
+    // snapshot of each symbol whose top moved in between, not a backlog.
+    ConflatingQueue<OrderBookSnapshot> strategy_updates(3);
+    
     auto start_time = std::chrono::high_resolution_clock::now();
     
     for (size_t i = 0; i < total_messages && g_running; ++i) {
@@ -114,17 +124,21 @@ void demo_complete_system() {
         if (msg) {
             auto book_start = perf::rdtsc_start();
             
-            std::string symbol = iex::symbol_to_string(msg->symbol);
+            SymbolId symbol = SymbolId::from_chars(msg->symbol);
             
+            uint8_t changes = BOOK_UNCHANGED;
             if (i % 5 == 0) {
-                book->add_order(i * 2, 'B', msg->bid_price, msg->bid_size, timestamp);
-                book->add_order(i * 2 + 1, 'S', msg->ask_price, msg->ask_size, timestamp);
+                changes |= book->add_order(i * 2, 'B', msg->bid_price, msg->bid_size, timestamp).changes;
+                changes |= book->add_order(i * 2 + 1, 'S', msg->ask_price, msg->ask_size, timestamp).changes;
             } else if (i % 7 == 0 && i > 0) {
-                book->execute_order((i - 1) * 2, msg->bid_size / 4, timestamp);
+                changes |= book->execute_order((i - 1) * 2, msg->bid_size / 4, timestamp).changes;
             } else if (i % 11 == 0 && i > 0) {
-                book->cancel_order((i - 1) * 2 + 1, msg->ask_size / 3, timestamp);
+                changes |= book->cancel_order((i - 1) * 2 + 1, msg->ask_size / 3, timestamp).changes;
             } else {
-                book->modify_order(i * 2, msg->bid_size + 100, timestamp);
+                changes |= book->modify_order(i * 2, msg->bid_size + 100, timestamp).changes;
+            }
+            if (changes & (BBO_PRICE_CHANGED | BBO_SIZE_CHANGED)) {
+                strategy_updates.publish(symbol_choice, book->snapshot());
             }
             
             auto book_end = perf::rdtsc_end();
@@ -135,8 +149,9 @@ void demo_complete_system() {
                                 msg->ask_price, msg->ask_size);
             
             if (i % 1000 == 0) {
-                auto snapshot = book->snapshot();
-                strategy.on_quote_update(snapshot);
+                strategy_updates.drain([&strategy](uint32_t, const OrderBookSnapshot& snapshot) {
+                    strategy.on_quote_update(snapshot);
+                });
             }
         }
         
@@ -213,6 +228,8 @@ void demo_complete_system() {
               << " (" << googl_snap.best_ask_size << ") | Spread: $" 
               << googl_snap.spread << " | Orders: " << googl_book.total_orders() << "\n\n";
     
+    std::cout << "Strategy Updates: " << strategy_updates.published() << " published, "
+              << strategy_updates.conflated() << " conflated\n";
     std::cout << "Trading Signals Generated: " << signal_count << "\n";
     std::cout << "Ticks Recorded: " << recorder.count() << "\n\n";
     
@@ -220,34 +237,98 @@ void demo_complete_system() {
     std::cout << "Data saved to: demo_ticks.dat\n";
 }
 
+template<typename T>
+static void append_itch(std::vector<uint8_t>& buffer, const T& msg) {
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(&msg);
+    buffer.insert(buffer.end(), ptr, ptr + sizeof(msg));
+}
+
 void demo_itch_processing() {
     std::cout << "\n=== NASDAQ ITCH 5.0 Processing Demo ===\n\n";
     
-    EnhancedOrderBook book("AAPL");
+    ItchBookBuilder builder;
+    
+    uint64_t executed_shares = 0;
+    builder.set_execution_callback([&executed_shares](uint16_t, int64_t, uint64_t shares, uint64_t) {
+        executed_shares += shares;
+    });
     
     std::cout << "Simulating ITCH message stream...\n\n";
     
     std::vector<uint8_t> itch_messages;
     
+    const char* stocks[] = {"AAPL    ", "MSFT    "};
     uint64_t order_id_counter = 1000000;
     uint64_t timestamp = 34200000000000ULL;
+    std::vector<uint64_t> live_orders[2];
+    
+    for (uint16_t locate = 1; locate <= 2; ++locate) {
+        itch::StockDirectory dir{};
+        dir.length = itch::swap_uint16(sizeof(itch::StockDirectory));
+        dir.type = 'R';
+        dir.stock_locate = itch::swap_uint16(locate);
+        dir.timestamp = itch::swap_uint64(timestamp);
+        std::memcpy(dir.stock, stocks[locate - 1], 8);
+        append_itch(itch_messages, dir);
+    }
     
     for (int i = 0; i < 100; ++i) {
-        if (i % 3 == 0) {
+        uint16_t locate = static_cast<uint16_t>(1 + i % 2);
+        auto& live = live_orders[locate - 1];
+        
+        if (i % 3 == 0 || live.empty()) {
             itch::AddOrder add{};
             add.length = itch::swap_uint16(sizeof(itch::AddOrder));
             add.type = 'A';
-            add.stock_locate = itch::swap_uint16(1);
+            add.stock_locate = itch::swap_uint16(locate);
             add.tracking_number = itch::swap_uint16(i);
             add.timestamp = itch::swap_uint64(timestamp);
+            live.push_back(order_id_counter);
             add.order_reference = itch::swap_uint64(order_id_counter++);
-            add.buy_sell = (i % 2 == 0) ? 'B' : 'S';
+            add.buy_sell = (i % 4 == 0) ? 'B' : 'S';
             add.shares = itch::swap_uint32(100 + i * 10);
-            std::memcpy(add.stock, "AAPL    ", 8);
-            add.price = itch::swap_uint32(1500000 + i * 100);
-            
-            const uint8_t* ptr = reinterpret_cast<const uint8_t*>(&add);
-            itch_messages.insert(itch_messages.end(), ptr, ptr + sizeof(add));
+            std::memcpy(add.stock, stocks[locate - 1], 8);
+            add.price = itch::swap_uint32(add.buy_sell == 'B' ? 1500000 - i * 100 : 1510000 + i * 100);
+            append_itch(itch_messages, add);
+        } else if (i % 3 == 1) {
+            itch::OrderExecuted exec{};
+            exec.length = itch::swap_uint16(sizeof(itch::OrderExecuted));
+            exec.type = 'E';
+            exec.stock_locate = itch::swap_uint16(locate);
+            exec.timestamp = itch::swap_uint64(timestamp);
+            exec.order_reference = itch::swap_uint64(live.front());
+            exec.executed_shares = itch::swap_uint32(50);
+            append_itch(itch_messages, exec);
+        } else if (i % 9 == 2) {
+            itch::OrderCancel cancel{};
+            cancel.length = itch::swap_uint16(sizeof(itch::OrderCancel));
+            cancel.type = 'X';
+            cancel.stock_locate = itch::swap_uint16(locate);
+            cancel.timestamp = itch::swap_uint64(timestamp);
+            cancel.order_reference = itch::swap_uint64(live.back());
+            cancel.cancelled_shares = itch::swap_uint32(25);
+            append_itch(itch_messages, cancel);
+        } else if (i % 9 == 5) {
+            itch::OrderReplace replace{};
+            replace.length = itch::swap_uint16(sizeof(itch::OrderReplace));
+            replace.type = 'U';
+            replace.stock_locate = itch::swap_uint16(locate);
+            replace.timestamp = itch::swap_uint64(timestamp);
+            replace.original_order_reference = itch::swap_uint64(live.back());
+            live.back() = order_id_counter;
+            replace.new_order_reference = itch::swap_uint64(order_id_counter++);
+            replace.shares = itch::swap_uint32(500);
+            replace.price = itch::swap_uint32(1505000);
+            append_itch(itch_messages, replace);
+        } else if (i % 9 == 8) {
+            itch::OrderDelete del{};
+            del.length = itch::swap_uint16(sizeof(itch::OrderDelete));
+            del.type = 'D';
+            del.stock_locate = itch::swap_uint16(locate);
+            del.timestamp = itch::swap_uint64(timestamp);
+            del.order_reference = itch::swap_uint64(live.front());
+            live.erase(live.begin());
+            append_itch(itch_messages, del);
         }
         
         timestamp += 1000000;
@@ -256,9 +337,15 @@ void demo_itch_processing() {
     itch::Parser parser(itch_messages.data(), itch_messages.size());
     
     perf::LatencyHistogram parse_hist;
+    perf::LatencyHistogram book_hist;
     size_t msg_count = 0;
+    CheckpointWriter checkpoint("itch_books.ckpt");
     
     while (parser.has_more()) {
+        if (msg_count == 50) {
+            checkpoint.write_now(builder, parser.position(), msg_count);
+        }
+        
         auto start = perf::rdtsc_start();
         auto msg = parser.parse_next();
         auto end = perf::rdtsc_end();
@@ -268,35 +355,71 @@ void demo_itch_processing() {
         if (msg) {
             msg_count++;
             
+            auto book_start = perf::rdtsc_start();
+            builder.process(*msg);
+            auto book_end = perf::rdtsc_end();
+            book_hist.record(book_end - book_start);
+            
             if (auto* add = std::get_if<itch::AddOrder>(&*msg)) {
-                std::string stock = itch::stock_to_string(add->stock);
-                char side = add->buy_sell;
-                int64_t price = add->price;
-                uint64_t shares = add->shares;
-                uint64_t order_ref = add->order_reference;
-                
-                book.add_order(order_ref, side, price, shares, add->timestamp);
-                
                 if (msg_count <= 10) {
-                    std::cout << "  [ADD] Order " << order_ref << " | " << stock << " | "
-                              << side << " | " << shares << " @ $" << std::fixed 
-                              << std::setprecision(2) << (price / 10000.0) << "\n";
+                    std::cout << "  [ADD] Order " << add->order_reference << " | "
+                              << itch::stock_to_string(add->stock) << " | "
+                              << add->buy_sell << " | " << add->shares << " @ $" << std::fixed 
+                              << std::setprecision(2) << (add->price / 10000.0) << "\n";
                 }
             }
         }
     }
     
+    const auto& stats = builder.stats();
     std::cout << "\nProcessed " << msg_count << " ITCH messages\n";
     std::cout << "Average parse latency: " << std::fixed << std::setprecision(1)
               << perf::cycles_to_ns(parse_hist.average(), 3.0) << " ns\n";
+    std::cout << "Average book update latency: " 
+              << perf::cycles_to_ns(book_hist.average(), 3.0) << " ns\n";
+    std::cout << "Executed shares: " << executed_shares 
+              << " | Unknown orders: " << stats.unknown_order
+              << " | Unknown locates: " << stats.unknown_locate << "\n";
+    
+    std::cout << "\nFinal Order Books:\n";
+    for (uint16_t locate : builder.locates()) {
+        const EnhancedOrderBook* book = builder.book(locate);
+        auto snapshot = book->snapshot();
+        std::cout << "  " << book->symbol() << ": Bid $" << std::fixed << std::setprecision(2) 
+                  << (snapshot.best_bid / 10000.0) << " (" << snapshot.best_bid_size << ")"
+                  << " | Ask $" << (snapshot.best_ask / 10000.0) 
+                  << " (" << snapshot.best_ask_size << ")"
+                  << " | Orders: " << book->total_orders() << "\n";
+    }
     
-    auto snapshot = book.snapshot();
-    std::cout << "\nFinal Order Book:\n";
-    std::cout << "  Best Bid: $" << std::fixed << std::setprecision(2) 
-              << (snapshot.best_bid / 10000.0) << " (" << snapshot.best_bid_size << ")\n";
-    std::cout << "  Best Ask: $" << (snapshot.best_ask / 10000.0) 
-              << " (" << snapshot.best_ask_size << ")\n";
-    std::cout << "  Total Orders: " << book.total_orders() << "\n";
+    std::cout << "\nRestart from checkpoint:\n";
+    try {
+        auto restore_start = std::chrono::steady_clock::now();
+        CheckpointReader reader(checkpoint.path());
+        ItchBookBuilder restored;
+        bool ok = reader.restore(restored);
+        
+        size_t offset = static_cast<size_t>(reader.feed_offset());
+        size_t replayed = restored.process_buffer(itch_messages.data() + offset, itch_messages.size() - offset);
+        auto restore_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - restore_start).count();
+        
+        bool matches = ok;
+        for (uint16_t locate : builder.locates()) {
+            const EnhancedOrderBook* book = restored.book(locate);
+            matches = matches && book && book->top().bid_price == builder.book(locate)->top().bid_price &&
+                      book->top().ask_price == builder.book(locate)->top().ask_price &&
+                      book->total_orders() == builder.book(locate)->total_orders();
+        }
+        
+        std::cout << "  Loaded " << reader.book_count() << " books / " << reader.order_count()
+                  << " orders (" << reader.size() << " bytes) at message " << reader.sequence()
+                  << ", replayed " << replayed << " messages in " << restore_us << " us"
+                  << " | Books " << (matches ? "match" : "DIFFER") << "\n";
+    } catch (const std::exception& e) {
+        std::cout << "  Checkpoint unavailable: " << e.what() << "\n";
+    }
+    std::remove(checkpoint.path().c_str());
 }
 
 void generate_sample_data(const std::string& filename) {
@@ -304,7 +427,10 @@ void generate_sample_data(const std::string& filename) {
     
     TickRecorder recorder(filename);
     
-    const char* symbols[] = {"AAPL", "MSFT", "GOOGL", "AMZN", "TSLA"};
+    const SymbolId symbols[] = {
+        SymbolId::from_cstr("AAPL"), SymbolId::from_cstr("MSFT"), SymbolId::from_cstr("GOOGL"),
+        SymbolId::from_cstr("AMZN"), SymbolId::from_cstr("TSLA")
+    };
     
     std::random_device rd;
     std::mt19937_64 gen(rd());
@@ -314,7 +440,7 @@ void generate_sample_data(const std::string& filename) {
     uint64_t timestamp = 1000000000000000;
     
     for (size_t i = 0; i < 10000; ++i) {
-        const char* symbol = symbols[i % 5];
+        SymbolId symbol = symbols[i % 5];
         
         int64_t bid_price = price_dist(gen);
         int64_t ask_price = bid_price + 10 + (gen() % 100);
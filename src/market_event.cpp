@@ -0,0 +1,157 @@
+#include "market_event.hpp"
+#include <cstring>
+
+template<typename T>
+static void fill_itch(const T& msg, EventType type, MarketEvent& out) {
+    out.type = type;
+    out.stock_locate = msg.stock_locate;
+    out.exchange_timestamp = msg.timestamp;
+}
+
+static void fill(const itch::SystemEvent& msg, MarketEvent& out) {
+    fill_itch(msg, EventType::SystemEvent, out);
+    out.side = static_cast<char>(msg.event_code);
+}
+
+static void fill(const itch::StockDirectory& msg, MarketEvent& out) {
+    fill_itch(msg, EventType::SymbolDirectory, out);
+    out.symbol = SymbolId::from_chars(msg.stock);
+    out.quantity = msg.round_lot_size;
+}
+
+static void fill(const itch::AddOrder& msg, MarketEvent& out) {
+    fill_itch(msg, EventType::AddOrder, out);
+    out.symbol = SymbolId::from_chars(msg.stock);
+    out.order_ref = msg.order_reference;
+    out.side = msg.buy_sell;
+    out.price = msg.price;
+    out.quantity = msg.shares;
+}
+
+static void fill(const itch::AddOrderMPID& msg, MarketEvent& out) {
+    fill_itch(msg, EventType::AddOrder, out);
+    out.symbol = SymbolId::from_chars(msg.stock);
+    out.order_ref = msg.order_reference;
+    out.side = msg.buy_sell;
+    out.price = msg.price;
+    out.quantity = msg.shares;
+    std::memcpy(out.attribution, msg.attribution, sizeof(out.attribution));
+    out.flags |= EVENT_ATTRIBUTED;
+}
+
+static void fill(const itch::OrderExecuted& msg, MarketEvent& out) {
+    fill_itch(msg, EventType::OrderExecuted, out);
+    out.order_ref = msg.order_reference;
+    out.quantity = msg.executed_shares;
+    out.match_number = msg.match_number;
+    out.flags |= EVENT_PRINTABLE;
+}
+
+static void fill(const itch::OrderExecutedWithPrice& msg, MarketEvent& out) {
+    fill_itch(msg, EventType::OrderExecuted, out);
+    out.order_ref = msg.order_reference;
+    out.quantity = msg.executed_shares;
+    out.match_number = msg.match_number;
+    out.price = msg.execution_price;
+    out.flags |= EVENT_PRICED;
+    if (msg.printable == 'Y') {
+        out.flags |= EVENT_PRINTABLE;
+    }
+}
+
+static void fill(const itch::OrderCancel& msg, MarketEvent& out) {
+    fill_itch(msg, EventType::OrderCancel, out);
+    out.order_ref = msg.order_reference;
+    out.quantity = msg.cancelled_shares;
+}
+
+static void fill(const itch::OrderDelete& msg, MarketEvent& out) {
+    fill_itch(msg, EventType::OrderDelete, out);
+    out.order_ref = msg.order_reference;
+}
+
+static void fill(const itch::OrderReplace& msg, MarketEvent& out) {
+    fill_itch(msg, EventType::OrderReplace, out);
+    out.order_ref = msg.original_order_reference;
+    out.new_order_ref = msg.new_order_reference;
+    out.price = msg.price;
+    out.quantity = msg.shares;
+}
+
+static void fill(const itch::Trade& msg, MarketEvent& out) {
+    fill_itch(msg, EventType::Trade, out);
+    out.symbol = SymbolId::from_chars(msg.stock);
+    out.order_ref = msg.order_reference;
+    out.side = msg.buy_sell;
+    out.price = msg.price;
+    out.quantity = msg.shares;
+    out.match_number = msg.match_number;
+    out.flags |= EVENT_PRICED | EVENT_PRINTABLE;
+}
+
+ItchEventAdapter::ItchEventAdapter(uint8_t venue)
+    : symbols_(65536)
+    , venue_(venue) {}
+
+bool ItchEventAdapter::normalize(const itch::Message& msg, uint64_t receive_timestamp, MarketEvent& out) {
+    out = MarketEvent();
+    std::visit([&out](const auto& m) { fill(m, out); }, msg);
+    
+    // Only directory, add and trade messages name the stock; the rest inherit it by locate.
+    if (out.symbol.empty()) {
+        out.symbol = symbols_[out.stock_locate];
+    } else {
+        symbols_[out.stock_locate] = out.symbol;
+    }
+    
+    out.venue = venue_;
+    out.receive_timestamp = receive_timestamp;
+    return true;
+}
+
+bool IexEventAdapter::normalize(const iex::Message& msg, uint64_t receive_timestamp, MarketEvent& out) const {
+    out = MarketEvent();
+    
+    if (auto* quote = std::get_if<iex::QuoteUpdate>(&msg)) {
+        out.type = EventType::Quote;
+        out.symbol = SymbolId::from_chars(quote->symbol);
+        out.exchange_timestamp = quote->header.timestamp;
+        out.price = quote->bid_price;
+        out.quantity = quote->bid_size;
+        out.ask_price = quote->ask_price;
+        out.ask_quantity = quote->ask_size;
+        out.flags = EVENT_PRICED;
+    } else if (auto* trade = std::get_if<iex::TradeReport>(&msg)) {
+        out.type = EventType::Trade;
+        out.symbol = SymbolId::from_chars(trade->symbol);
+        out.exchange_timestamp = trade->header.timestamp;
+        out.price = trade->price;
+        out.quantity = trade->size;
+        out.match_number = trade->trade_id;
+        out.flags = EVENT_PRICED | EVENT_PRINTABLE;
+    } else if (auto* level = std::get_if<iex::PriceLevelUpdate>(&msg)) {
+        // 0x38 is the buy-side price level message.
+        out.type = EventType::PriceLevel;
+        out.symbol = SymbolId::from_chars(level->symbol);
+        out.exchange_timestamp = level->header.timestamp;
+        out.side = 'B';
+        out.price = level->price;
+        out.quantity = level->size;
+        out.flags = EVENT_PRICED;
+    } else if (auto* directory = std::get_if<iex::SecurityDirectory>(&msg)) {
+        out.type = EventType::SymbolDirectory;
+        out.symbol = SymbolId::from_chars(directory->symbol);
+        out.exchange_timestamp = directory->header.timestamp;
+        out.quantity = directory->round_lot;
+    } else if (auto* event = std::get_if<iex::SystemEvent>(&msg)) {
+        out.type = EventType::SystemEvent;
+        out.exchange_timestamp = event->header.timestamp;
+        out.side = static_cast<char>(event->event);
+    } else {
+        return false;
+    }
+    
+    out.venue = venue_;
+    out.receive_timestamp = receive_timestamp;
+    return true;
+}
@@ -0,0 +1,186 @@
+#include "memory_provider.hpp"
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+static constexpr size_t SMALL_PAGE_SIZE = 4096;
+
+static size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+MemoryProvider::MemoryProvider(const Config& config)
+    : config_(config)
+    , stats_{}
+    , cursor_(nullptr)
+    , limit_(nullptr) {
+    
+    config_.region_size = round_up(config_.region_size ? config_.region_size : HUGE_PAGE_SIZE, HUGE_PAGE_SIZE);
+}
+
+MemoryProvider::~MemoryProvider() {
+    for (const Region& region : regions_) {
+        unmap(region);
+    }
+}
+
+void MemoryProvider::unmap(const Region& region) {
+#ifdef _WIN32
+    VirtualFree(region.base, 0, MEM_RELEASE);
+#else
+    munmap(region.base, region.size);
+#endif
+}
+
+bool MemoryProvider::map_region(size_t bytes) {
+    void* base = nullptr;
+    bool huge = false;
+    
+#ifdef _WIN32
+    if (config_.huge_pages) {
+        base = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        huge = base != nullptr;
+    }
+    if (!base && config_.numa_node >= 0) {
+        base = VirtualAllocExNuma(GetCurrentProcess(), nullptr, bytes, MEM_RESERVE | MEM_COMMIT,
+                                  PAGE_READWRITE, static_cast<DWORD>(config_.numa_node));
+        if (base) {
+            stats_.numa_bound_bytes += bytes;
+        }
+    }
+    if (!base) {
+        base = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+    if (!base) {
+        return false;
+    }
+#else
+#ifdef MAP_HUGETLB
+    if (config_.huge_pages) {
+        base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base == MAP_FAILED) {
+            base = nullptr;
+        } else {
+            huge = true;
+        }
+    }
+#endif
+    if (!base) {
+        base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            return false;
+        }
+#ifdef MADV_HUGEPAGE
+        // No reserved huge pages; ask khugepaged to back the region instead.
+        if (config_.huge_pages && madvise(base, bytes, MADV_HUGEPAGE) == 0) {
+            stats_.transparent_huge_bytes += bytes;
+        }
+#endif
+    }
+    
+#ifdef __linux__
+    // Bind before the first touch so prefaulting allocates on the right node.
+    if (config_.numa_node >= 0 && config_.numa_node < 64) {
+        const int MPOL_BIND = 2;
+        unsigned long mask = 1UL << config_.numa_node;
+        if (syscall(SYS_mbind, base, bytes, MPOL_BIND, &mask, sizeof(mask) * 8 + 1, 0) == 0) {
+            stats_.numa_bound_bytes += bytes;
+        }
+    }
+#endif
+#endif
+    
+    if (config_.prefault) {
+        volatile uint8_t* bytes_ptr = static_cast<uint8_t*>(base);
+        for (size_t offset = 0; offset < bytes; offset += SMALL_PAGE_SIZE) {
+            bytes_ptr[offset] = 0;
+        }
+    }
+    
+    if (config_.lock) {
+#ifdef _WIN32
+        bool locked = VirtualLock(base, bytes) != 0;
+#else
+        bool locked = mlock(base, bytes) == 0;
+#endif
+        if (locked) {
+            stats_.locked_bytes += bytes;
+        }
+    }
+    
+    regions_.push_back(Region{base, bytes, huge});
+    ++stats_.regions;
+    stats_.mapped_bytes += bytes;
+    if (huge) {
+        stats_.huge_page_bytes += bytes;
+    }
+    return true;
+}
+
+void* MemoryProvider::allocate(size_t bytes, size_t alignment) {
+    if (bytes == 0) {
+        return nullptr;
+    }
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment > SMALL_PAGE_SIZE) {
+        return nullptr;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    // Oversized blocks get a mapping of their own and leave the current region alone.
+    if (bytes > config_.region_size / 2) {
+        if (!map_region(round_up(bytes, HUGE_PAGE_SIZE))) {
+            return nullptr;
+        }
+        stats_.used_bytes += bytes;
+        return regions_.back().base;
+    }
+    
+    uintptr_t aligned = round_up(reinterpret_cast<uintptr_t>(cursor_), alignment);
+    if (!cursor_ || aligned + bytes > reinterpret_cast<uintptr_t>(limit_)) {
+        if (!map_region(config_.region_size)) {
+            return nullptr;
+        }
+        cursor_ = static_cast<uint8_t*>(regions_.back().base);
+        limit_ = cursor_ + config_.region_size;
+        aligned = reinterpret_cast<uintptr_t>(cursor_);
+    }
+    
+    cursor_ = reinterpret_cast<uint8_t*>(aligned + bytes);
+    stats_.used_bytes += bytes;
+    return reinterpret_cast<void*>(aligned);
+}
+
+MemoryProvider::Stats MemoryProvider::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+int MemoryProvider::node_of_cpu(int cpu) {
+    if (cpu < 0) return -1;
+#ifdef _WIN32
+    UCHAR node = 0;
+    if (cpu < 64 && GetNumaProcessorNode(static_cast<UCHAR>(cpu), &node) && node != 0xFF) {
+        return node;
+    }
+    return -1;
+#elif defined(__linux__)
+    std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/node";
+    for (int node = 0; node < 64; ++node) {
+        if (access((base + std::to_string(node)).c_str(), F_OK) == 0) {
+            return node;
+        }
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
@@ -0,0 +1,190 @@
+#include "nbbo_engine.hpp"
+
+NbboEngine::NbboEngine() : stats_{} {}
+
+uint32_t NbboEngine::symbol_index(SymbolId symbol) {
+    auto it = index_.find(symbol);
+    if (it != index_.end()) {
+        return it->second;
+    }
+    
+    uint32_t index = static_cast<uint32_t>(symbols_.size());
+    symbols_.emplace_back();
+    symbols_.back().symbol = symbol;
+    index_.emplace(symbol, index);
+    return index;
+}
+
+void NbboEngine::set_nbbo_callback(NbboCallback callback) {
+    nbbo_callback_ = callback;
+}
+
+uint8_t NbboEngine::update(uint8_t venue, uint32_t index, const VenueQuote& quote) {
+    if (venue >= MAX_VENUES || index >= symbols_.size()) {
+        return BOOK_UNCHANGED;
+    }
+    
+    Consolidated& entry = symbols_[index];
+    VenueQuote& slot = entry.venues[venue];
+    VenueQuote previous = slot;
+    slot = quote;
+    stats_.updates++;
+    
+    uint8_t changes = update_bid(entry, venue, previous.bid_size) |
+                      update_ask(entry, venue, previous.ask_size);
+    if (changes == BOOK_UNCHANGED) {
+        return changes;
+    }
+    
+    entry.nbbo.changes = changes;
+    entry.nbbo.venue = venue;
+    entry.nbbo.source_timestamp = quote.timestamp;
+    stats_.nbbo_changes++;
+    
+    if (nbbo_callback_) {
+        nbbo_callback_(index, entry.symbol, entry.nbbo);
+    }
+    return changes;
+}
+
+uint8_t NbboEngine::update(uint8_t venue, uint32_t index, const TopOfBook& top) {
+    VenueQuote quote;
+    quote.bid_price = top.bid_price;
+    quote.bid_size = top.bid_size;
+    quote.ask_price = top.ask_price;
+    quote.ask_size = top.ask_size;
+    quote.timestamp = top.timestamp;
+    return update(venue, index, quote);
+}
+
+uint8_t NbboEngine::on_quote(uint8_t venue, const iex::QuoteUpdate& msg) {
+    VenueQuote quote;
+    quote.bid_price = msg.bid_price;
+    quote.bid_size = msg.bid_size;
+    quote.ask_price = msg.ask_price;
+    quote.ask_size = msg.ask_size;
+    quote.timestamp = msg.header.timestamp;
+    return update(venue, symbol_index(SymbolId::from_chars(msg.symbol)), quote);
+}
+
+uint8_t NbboEngine::clear_venue(uint8_t venue, uint32_t index, uint64_t timestamp) {
+    VenueQuote quote;
+    quote.timestamp = timestamp;
+    return update(venue, index, quote);
+}
+
+uint8_t NbboEngine::update_bid(Consolidated& entry, uint8_t venue, uint64_t old_size) {
+    const VenueQuote& quote = entry.venues[venue];
+    Nbbo& nbbo = entry.nbbo;
+    uint32_t bit = 1u << venue;
+    bool was_best = (nbbo.bid_venues & bit) != 0;
+    bool quoting = quote.bid_size > 0;
+    
+    // A venue that was not at the best and does not improve on it cannot move the NBBO.
+    if (!was_best && (!quoting || (nbbo.bid_venues != 0 && quote.bid_price < nbbo.bid_price))) {
+        return BOOK_UNCHANGED;
+    }
+    
+    int64_t best_price = nbbo.bid_price;
+    uint64_t best_size = nbbo.bid_size;
+    
+    if (quoting && (nbbo.bid_venues == 0 || quote.bid_price > nbbo.bid_price)) {
+        nbbo.bid_price = quote.bid_price;
+        nbbo.bid_size = quote.bid_size;
+        nbbo.bid_venues = bit;
+    } else if (quoting && quote.bid_price == nbbo.bid_price) {
+        nbbo.bid_size = nbbo.bid_size - (was_best ? old_size : 0) + quote.bid_size;
+        nbbo.bid_venues |= bit;
+    } else {
+        // Only the last venue leaving the best price forces a walk over the others.
+        nbbo.bid_venues &= ~bit;
+        nbbo.bid_size -= old_size;
+        if (nbbo.bid_venues == 0) {
+            rescan_bid(entry);
+        }
+    }
+    
+    uint8_t changes = BOOK_UNCHANGED;
+    if (nbbo.bid_price != best_price) changes |= BBO_PRICE_CHANGED;
+    if (nbbo.bid_size != best_size) changes |= BBO_SIZE_CHANGED;
+    return changes;
+}
+
+uint8_t NbboEngine::update_ask(Consolidated& entry, uint8_t venue, uint64_t old_size) {
+    const VenueQuote& quote = entry.venues[venue];
+    Nbbo& nbbo = entry.nbbo;
+    uint32_t bit = 1u << venue;
+    bool was_best = (nbbo.ask_venues & bit) != 0;
+    bool quoting = quote.ask_size > 0;
+    
+    if (!was_best && (!quoting || (nbbo.ask_venues != 0 && quote.ask_price > nbbo.ask_price))) {
+        return BOOK_UNCHANGED;
+    }
+    
+    int64_t best_price = nbbo.ask_price;
+    uint64_t best_size = nbbo.ask_size;
+    
+    if (quoting && (nbbo.ask_venues == 0 || quote.ask_price < nbbo.ask_price)) {
+        nbbo.ask_price = quote.ask_price;
+        nbbo.ask_size = quote.ask_size;
+        nbbo.ask_venues = bit;
+    } else if (quoting && quote.ask_price == nbbo.ask_price) {
+        nbbo.ask_size = nbbo.ask_size - (was_best ? old_size : 0) + quote.ask_size;
+        nbbo.ask_venues |= bit;
+    } else {
+        nbbo.ask_venues &= ~bit;
+        nbbo.ask_size -= old_size;
+        if (nbbo.ask_venues == 0) {
+            rescan_ask(entry);
+        }
+    }
+    
+    uint8_t changes = BOOK_UNCHANGED;
+    if (nbbo.ask_price != best_price) changes |= BBO_PRICE_CHANGED;
+    if (nbbo.ask_size != best_size) changes |= BBO_SIZE_CHANGED;
+    return changes;
+}
+
+void NbboEngine::rescan_bid(Consolidated& entry) {
+    Nbbo& nbbo = entry.nbbo;
+    nbbo.bid_price = 0;
+    nbbo.bid_size = 0;
+    nbbo.bid_venues = 0;
+    stats_.rescans++;
+    
+    for (size_t venue = 0; venue < MAX_VENUES; ++venue) {
+        const VenueQuote& quote = entry.venues[venue];
+        if (quote.bid_size == 0) continue;
+        
+        if (nbbo.bid_venues == 0 || quote.bid_price > nbbo.bid_price) {
+            nbbo.bid_price = quote.bid_price;
+            nbbo.bid_size = quote.bid_size;
+            nbbo.bid_venues = 1u << venue;
+        } else if (quote.bid_price == nbbo.bid_price) {
+            nbbo.bid_size += quote.bid_size;
+            nbbo.bid_venues |= 1u << venue;
+        }
+    }
+}
+
+void NbboEngine::rescan_ask(Consolidated& entry) {
+    Nbbo& nbbo = entry.nbbo;
+    nbbo.ask_price = 0;
+    nbbo.ask_size = 0;
+    nbbo.ask_venues = 0;
+    stats_.rescans++;
+    
+    for (size_t venue = 0; venue < MAX_VENUES; ++venue) {
+        const VenueQuote& quote = entry.venues[venue];
+        if (quote.ask_size == 0) continue;
+        
+        if (nbbo.ask_venues == 0 || quote.ask_price < nbbo.ask_price) {
+            nbbo.ask_price = quote.ask_price;
+            nbbo.ask_size = quote.ask_size;
+            nbbo.ask_venues = 1u << venue;
+        } else if (quote.ask_price == nbbo.ask_price) {
+            nbbo.ask_size += quote.ask_size;
+            nbbo.ask_venues |= 1u << venue;
+        }
+    }
+}
@@ -2,30 +2,80 @@
 #include <algorithm>
 #include <cmath>
 
-OrderBook::OrderBook(const std::string& symbol)
+OrderBook::OrderBook(SymbolId symbol, MemoryProvider* provider)
     : symbol_(symbol)
+    , node_pool_(provider)
+    , bids_(LevelAllocator(&node_pool_))
+    , asks_(LevelAllocator(&node_pool_))
     , last_update_time_(0)
-    , message_count_(0) {}
+    , message_count_(0)
+    , snapshot_()
+    , snapshot_dirty_(true) {}
 
-void OrderBook::add_bid(int64_t price, uint64_t size, uint64_t timestamp) {
+OrderBook::OrderBook(const std::string& symbol, MemoryProvider* provider)
+    : OrderBook(SymbolId::from_string(symbol), provider) {}
+
+void OrderBook::touch(uint64_t timestamp) {
+    last_update_time_ = timestamp;
+    message_count_++;
+    snapshot_dirty_ = true;
+}
+
+uint8_t OrderBook::bid_changed(int64_t price, uint64_t timestamp) {
+    touch(timestamp);
+    if (top_.bid_size != 0 && price < top_.bid_price) return DEPTH_CHANGED;
+    
+    int64_t best = bids_.empty() ? 0 : bids_.begin()->first;
+    uint64_t size = bids_.empty() ? 0 : bids_.begin()->second.size;
+    
+    uint8_t changes = DEPTH_CHANGED;
+    if (best != top_.bid_price) changes |= BBO_PRICE_CHANGED;
+    if (size != top_.bid_size) changes |= BBO_SIZE_CHANGED;
+    if (changes != DEPTH_CHANGED) {
+        top_.bid_price = best;
+        top_.bid_size = size;
+        top_.timestamp = timestamp;
+        published_top_.store(top_);
+    }
+    return changes;
+}
+
+uint8_t OrderBook::ask_changed(int64_t price, uint64_t timestamp) {
+    touch(timestamp);
+    if (top_.ask_size != 0 && price > top_.ask_price) return DEPTH_CHANGED;
+    
+    int64_t best = asks_.empty() ? 0 : asks_.begin()->first;
+    uint64_t size = asks_.empty() ? 0 : asks_.begin()->second.size;
+    
+    uint8_t changes = DEPTH_CHANGED;
+    if (best != top_.ask_price) changes |= BBO_PRICE_CHANGED;
+    if (size != top_.ask_size) changes |= BBO_SIZE_CHANGED;
+    if (changes != DEPTH_CHANGED) {
+        top_.ask_price = best;
+        top_.ask_size = size;
+        top_.timestamp = timestamp;
+        published_top_.store(top_);
+    }
+    return changes;
+}
+
+uint8_t OrderBook::add_bid(int64_t price, uint64_t size, uint64_t timestamp) {
     auto& level = bids_[price];
     level.price = price;
     level.size += size;
     level.order_count++;
-    last_update_time_ = timestamp;
-    message_count_++;
+    return bid_changed(price, timestamp);
 }
 
-void OrderBook::add_ask(int64_t price, uint64_t size, uint64_t timestamp) {
+uint8_t OrderBook::add_ask(int64_t price, uint64_t size, uint64_t timestamp) {
     auto& level = asks_[price];
     level.price = price;
     level.size += size;
     level.order_count++;
-    last_update_time_ = timestamp;
-    message_count_++;
+    return ask_changed(price, timestamp);
 }
 
-void OrderBook::modify_bid(int64_t price, uint64_t size, uint64_t timestamp) {
+uint8_t OrderBook::modify_bid(int64_t price, uint64_t size, uint64_t timestamp) {
     auto it = bids_.find(price);
     if (it != bids_.end()) {
         it->second.size = size;
@@ -34,12 +84,14 @@ void OrderBook::modify_bid(int64_t price, uint64_t size, uint64_t timestamp) {
         }
     } else if (size > 0) {
         bids_[price] = PriceLevel(price, size);
+    } else {
+        touch(timestamp);
+        return BOOK_UNCHANGED;
     }
-    last_update_time_ = timestamp;
-    message_count_++;
+    return bid_changed(price, timestamp);
 }
 
-void OrderBook::modify_ask(int64_t price, uint64_t size, uint64_t timestamp) {
+uint8_t OrderBook::modify_ask(int64_t price, uint64_t size, uint64_t timestamp) {
     auto it = asks_.find(price);
     if (it != asks_.end()) {
         it->second.size = size;
@@ -48,47 +100,55 @@ void OrderBook::modify_ask(int64_t price, uint64_t size, uint64_t timestamp) {
         }
     } else if (size > 0) {
         asks_[price] = PriceLevel(price, size);
+    } else {
+        touch(timestamp);
+        return BOOK_UNCHANGED;
     }
-    last_update_time_ = timestamp;
-    message_count_++;
+    return ask_changed(price, timestamp);
 }
 
-void OrderBook::remove_bid(int64_t price, uint64_t timestamp) {
-    bids_.erase(price);
-    last_update_time_ = timestamp;
-    message_count_++;
+uint8_t OrderBook::remove_bid(int64_t price, uint64_t timestamp) {
+    if (bids_.erase(price) == 0) {
+        touch(timestamp);
+        return BOOK_UNCHANGED;
+    }
+    return bid_changed(price, timestamp);
 }
 
-void OrderBook::remove_ask(int64_t price, uint64_t timestamp) {
-    asks_.erase(price);
-    last_update_time_ = timestamp;
-    message_count_++;
+uint8_t OrderBook::remove_ask(int64_t price, uint64_t timestamp) {
+    if (asks_.erase(price) == 0) {
+        touch(timestamp);
+        return BOOK_UNCHANGED;
+    }
+    return ask_changed(price, timestamp);
 }
 
-void OrderBook::execute_bid(int64_t price, uint64_t size, uint64_t timestamp) {
+uint8_t OrderBook::execute_bid(int64_t price, uint64_t size, uint64_t timestamp) {
     auto it = bids_.find(price);
-    if (it != bids_.end()) {
-        if (it->second.size > size) {
-            it->second.size -= size;
-        } else {
-            bids_.erase(it);
-        }
+    if (it == bids_.end()) {
+        touch(timestamp);
+        return BOOK_UNCHANGED;
     }
-    last_update_time_ = timestamp;
-    message_count_++;
+    if (it->second.size > size) {
+        it->second.size -= size;
+    } else {
+        bids_.erase(it);
+    }
+    return bid_changed(price, timestamp);
 }
 
-void OrderBook::execute_ask(int64_t price, uint64_t size, uint64_t timestamp) {
+uint8_t OrderBook::execute_ask(int64_t price, uint64_t size, uint64_t timestamp) {
     auto it = asks_.find(price);
-    if (it != asks_.end()) {
-        if (it->second.size > size) {
-            it->second.size -= size;
-        } else {
-            asks_.erase(it);
-        }
+    if (it == asks_.end()) {
+        touch(timestamp);
+        return BOOK_UNCHANGED;
     }
-    last_update_time_ = timestamp;
-    message_count_++;
+    if (it->second.size > size) {
+        it->second.size -= size;
+    } else {
+        asks_.erase(it);
+    }
+    return ask_changed(price, timestamp);
 }
 
 std::optional<int64_t> OrderBook::best_bid() const {
@@ -132,26 +192,22 @@ double OrderBook::imbalance() const {
     return (static_cast<double>(*bid_size) - static_cast<double>(*ask_size)) / total;
 }
 
-OrderBookSnapshot OrderBook::snapshot() const {
-    OrderBookSnapshot snap;
-    snap.symbol = symbol_;
-    snap.timestamp = last_update_time_;
-    
-    auto bid = best_bid();
-    auto ask = best_ask();
-    auto bid_sz = best_bid_size();
-    auto ask_sz = best_ask_size();
+const OrderBookSnapshot& OrderBook::snapshot() const {
+    if (!snapshot_dirty_) return snapshot_;
     
-    snap.best_bid = bid.value_or(0);
-    snap.best_ask = ask.value_or(0);
-    snap.best_bid_size = bid_sz.value_or(0);
-    snap.best_ask_size = ask_sz.value_or(0);
-    snap.spread = spread();
-    snap.imbalance = imbalance();
-    snap.bid_levels = bids_.size();
-    snap.ask_levels = asks_.size();
+    snapshot_.symbol = symbol_;
+    snapshot_.timestamp = last_update_time_;
+    snapshot_.best_bid = top_.bid_price;
+    snapshot_.best_ask = top_.ask_price;
+    snapshot_.best_bid_size = top_.bid_size;
+    snapshot_.best_ask_size = top_.ask_size;
+    snapshot_.spread = spread();
+    snapshot_.imbalance = imbalance();
+    snapshot_.bid_levels = bids_.size();
+    snapshot_.ask_levels = asks_.size();
+    snapshot_dirty_ = false;
     
-    return snap;
+    return snapshot_;
 }
 
 void OrderBook::clear() {
@@ -159,35 +215,63 @@ void OrderBook::clear() {
     asks_.clear();
     last_update_time_ = 0;
     message_count_ = 0;
+    top_ = TopOfBook();
+    snapshot_dirty_ = true;
+    published_top_.store(top_);
 }
 
-OrderBook& OrderBookManager::get_or_create(const std::string& symbol) {
-    auto it = books_.find(symbol);
-    if (it == books_.end()) {
-        it = books_.emplace(symbol, OrderBook(symbol)).first;
+OrderBookManager::OrderBookManager(const PerfectHashIndex& universe)
+    : table_(universe) {
+    for (size_t i = 0; i < universe.size; ++i) {
+        books_.emplace_back(universe.symbols[i]);
     }
-    return it->second;
+}
+
+OrderBook& OrderBookManager::get_or_create(SymbolId symbol) {
+    uint32_t index = table_.intern(symbol);
+    if (index == books_.size()) {
+        books_.emplace_back(symbol);
+    }
+    return books_[index];
+}
+
+OrderBook* OrderBookManager::get(SymbolId symbol) {
+    uint32_t index = table_.find(symbol);
+    return index != SymbolTable::NOT_FOUND ? &books_[index] : nullptr;
+}
+
+const OrderBook* OrderBookManager::get(SymbolId symbol) const {
+    uint32_t index = table_.find(symbol);
+    return index != SymbolTable::NOT_FOUND ? &books_[index] : nullptr;
+}
+
+OrderBook& OrderBookManager::get_or_create(const std::string& symbol) {
+    return get_or_create(SymbolId::from_string(symbol));
 }
 
 OrderBook* OrderBookManager::get(const std::string& symbol) {
-    auto it = books_.find(symbol);
-    return it != books_.end() ? &it->second : nullptr;
+    return get(SymbolId::from_string(symbol));
 }
 
 const OrderBook* OrderBookManager::get(const std::string& symbol) const {
-    auto it = books_.find(symbol);
-    return it != books_.end() ? &it->second : nullptr;
+    return get(SymbolId::from_string(symbol));
 }
 
 std::vector<std::string> OrderBookManager::symbols() const {
     std::vector<std::string> result;
     result.reserve(books_.size());
-    for (const auto& [symbol, _] : books_) {
-        result.push_back(symbol);
+    for (SymbolId symbol : table_.symbols()) {
+        result.push_back(symbol.to_string());
     }
     return result;
 }
 
 void OrderBookManager::clear() {
-    books_.clear();
+    while (books_.size() > table_.universe_size()) {
+        books_.pop_back();
+    }
+    for (auto& book : books_) {
+        book.clear();
+    }
+    table_.clear();
 }
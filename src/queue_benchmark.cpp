@@ -0,0 +1,187 @@
+#include "lock_free_queue.hpp"
+#include "market_event.hpp"
+#include "memory_provider.hpp"
+#include "latency_tracker.hpp"
+#include "thread_affinity.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+// Spinning is the point on dedicated cores; with a single CPU the peer
+// thread cannot run until we give up the slice.
+static bool g_yield = false;
+
+static void relax() {
+    if (g_yield) {
+        std::this_thread::yield();
+    }
+}
+
+struct RunResult {
+    size_t footprint;
+    double messages_per_sec;
+    uint64_t rtt_p50;
+    uint64_t rtt_p99;
+};
+
+template<typename T>
+static void stamp(T& item, uint64_t value) { item = value; }
+
+static void stamp(MarketEvent& event, uint64_t value) { event.order_ref = value; }
+
+template<typename T>
+static uint64_t read_stamp(const T& item) { return item; }
+
+static uint64_t read_stamp(const MarketEvent& event) { return event.order_ref; }
+
+// Streams messages one way for throughput, then bounces single messages
+// through a second ring for round-trip latency.
+template<typename Queue, typename T>
+static RunResult run_pair(size_t capacity, uint64_t messages, int producer_cpu, int consumer_cpu) {
+    RunResult result{};
+    
+    {
+        Queue queue(capacity);
+        result.footprint = queue.footprint();
+        std::thread consumer([&]() {
+            pin_current_thread(consumer_cpu);
+            uint64_t expected = 0;
+            while (expected < messages) {
+                if (T* item = queue.peek()) {
+                    if (read_stamp(*item) != expected) {
+                        std::cerr << "out of order at " << expected << "\n";
+                        std::abort();
+                    }
+                    queue.release();
+                    ++expected;
+                } else {
+                    relax();
+                }
+            }
+        });
+        
+        pin_current_thread(producer_cpu);
+        auto start = steady_clock::now();
+        for (uint64_t i = 0; i < messages; ++i) {
+            T* slot;
+            while (!(slot = queue.claim())) {
+                relax();
+            }
+            stamp(*slot, i);
+            queue.commit();
+        }
+        consumer.join();
+        double seconds = duration<double>(steady_clock::now() - start).count();
+        result.messages_per_sec = messages / seconds;
+    }
+    
+    {
+        Queue ping(capacity);
+        Queue pong(capacity);
+        const uint64_t rounds = messages / 100 + 1;
+        std::thread echo([&]() {
+            pin_current_thread(consumer_cpu);
+            for (uint64_t i = 0; i < rounds; ++i) {
+                T* item;
+                while (!(item = ping.peek())) {
+                    relax();
+                }
+                T copy = *item;
+                ping.release();
+                while (!pong.try_push(copy)) {
+                    relax();
+                }
+            }
+        });
+        
+        // Cross-socket round trips can exceed the fixed histogram's range, so keep raw samples.
+        std::vector<uint64_t> rtt;
+        rtt.reserve(rounds);
+        T item{};
+        for (uint64_t i = 0; i < rounds; ++i) {
+            stamp(item, i);
+            uint64_t begin = perf::rdtsc_start();
+            while (!ping.try_push(item)) {
+                relax();
+            }
+            while (!pong.peek()) {
+                relax();
+            }
+            uint64_t end = perf::rdtsc_end();
+            pong.release();
+            rtt.push_back(end - begin);
+        }
+        echo.join();
+        std::sort(rtt.begin(), rtt.end());
+        result.rtt_p50 = rtt[rtt.size() / 2];
+        result.rtt_p99 = rtt[rtt.size() * 99 / 100];
+    }
+    
+    return result;
+}
+
+template<typename T>
+static void compare(const char* type_name, size_t capacity, uint64_t messages, int producer_cpu, int consumer_cpu) {
+    RunResult p = run_pair<SPSCQueue<T>, T>(capacity, messages, producer_cpu, consumer_cpu);
+    RunResult c = run_pair<CompactSPSCQueue<T>, T>(capacity, messages, producer_cpu, consumer_cpu);
+    
+    auto row = [&](const char* name, const RunResult& r) {
+        std::cout << "  " << std::left << std::setw(8) << name << std::setw(12) << type_name << std::right
+                  << std::setw(8) << r.footprint / 1024 << " KB"
+                  << std::fixed << std::setprecision(1) << std::setw(10) << r.messages_per_sec / 1e6 << " M/s"
+                  << "   rtt p50 " << r.rtt_p50 << " / p99 " << r.rtt_p99 << " cycles\n";
+    };
+    row("padded", p);
+    row("compact", c);
+}
+
+static int cpu_on_other_node(int cpu) {
+    int node = MemoryProvider::node_of_cpu(cpu);
+    if (node < 0) return -1;
+    for (unsigned other = 0; other < cpu_count(); ++other) {
+        int other_node = MemoryProvider::node_of_cpu(static_cast<int>(other));
+        if (other_node >= 0 && other_node != node) {
+            return static_cast<int>(other);
+        }
+    }
+    return -1;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    int producer_cpu = argc > 2 ? std::atoi(argv[2]) : 0;
+    int consumer_cpu = argc > 3 ? std::atoi(argv[3]) : (cpu_count() > 1 ? 1 : 0);
+    size_t capacity = 4096;
+    
+    std::cout << "SPSC Ring Layout Benchmark\n";
+    std::cout << "==========================\n";
+    std::cout << "Usage: queue_benchmark [messages] [producer_cpu] [consumer_cpu]\n";
+    
+    std::vector<std::pair<int, int>> pairs{{producer_cpu, consumer_cpu}};
+    int remote = cpu_on_other_node(producer_cpu);
+    if (argc <= 3 && remote >= 0) {
+        pairs.emplace_back(producer_cpu, remote);
+    }
+    if (cpu_count() == 1) {
+        g_yield = true;
+        std::cout << "Only one CPU: producer and consumer share it, so results show layout cost only\n";
+    }
+    
+    for (const auto& [producer, consumer] : pairs) {
+        std::cout << "\nProducer cpu " << producer << " (node " << MemoryProvider::node_of_cpu(producer)
+                  << "), consumer cpu " << consumer << " (node " << MemoryProvider::node_of_cpu(consumer)
+                  << "), " << capacity << " slots\n";
+        compare<uint64_t>("uint64_t", capacity, messages, producer, consumer);
+        compare<MarketEvent>("MarketEvent", capacity, messages, producer, consumer);
+    }
+    
+    return 0;
+}
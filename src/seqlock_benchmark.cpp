@@ -0,0 +1,154 @@
+#include "enhanced_order_book.hpp"
+#include "latency_tracker.hpp"
+#include "thread_affinity.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+struct ReaderStats {
+    uint64_t reads;
+    uint64_t retries;
+    uint64_t torn;
+    perf::LatencyHistogram latency;
+    
+    ReaderStats() : reads(0), retries(0), torn(0) {}
+};
+
+static void drive_book(EnhancedOrderBook& book, const std::atomic<bool>& running, uint64_t& updates) {
+    uint64_t order_id = 1;
+    uint64_t timestamp = 1;
+    
+    for (int i = 0; i < 20; ++i) {
+        book.add_order(order_id++, 'B', 1500000 - i * 100, 100, timestamp++);
+        book.add_order(order_id++, 'S', 1500100 + i * 100, 100, timestamp++);
+    }
+    
+    while (running.load(std::memory_order_relaxed)) {
+        uint64_t bid_id = order_id++;
+        uint64_t ask_id = order_id++;
+        int64_t offset = static_cast<int64_t>(timestamp % 3) * 10;
+        
+        uint64_t bid_quantity = 100 + timestamp % 50;
+        uint64_t bid_time = timestamp++;
+        book.add_order(bid_id, 'B', 1500000 + offset, bid_quantity, bid_time);
+        uint64_t ask_quantity = 100 + timestamp % 50;
+        uint64_t ask_time = timestamp++;
+        book.add_order(ask_id, 'S', 1500100 - offset, ask_quantity, ask_time);
+        book.execute_order(bid_id, 30, timestamp++);
+        book.delete_order(bid_id, timestamp++);
+        book.delete_order(ask_id, timestamp++);
+        updates += 5;
+    }
+}
+
+template<typename Slot, typename Check>
+static void read_slot(const Slot& slot, const std::atomic<bool>& running, ReaderStats& stats, Check check) {
+    while (running.load(std::memory_order_relaxed)) {
+        uint64_t start = perf::rdtsc_start();
+        auto value = slot.load(&stats.retries);
+        uint64_t end = perf::rdtsc_end();
+        
+        stats.latency.record(end - start);
+        stats.reads++;
+        if (!check(value)) {
+            stats.torn++;
+        }
+    }
+}
+
+template<typename Reader>
+static void run_phase(const char* name, EnhancedOrderBook& book, unsigned readers,
+                      int duration_ms, int first_cpu, Reader reader) {
+    std::cout << "\n=== " << name << " (" << readers << " readers) ===\n";
+    
+    std::atomic<bool> running{true};
+    std::vector<ReaderStats> stats(readers);
+    std::vector<std::thread> threads;
+    uint64_t updates = 0;
+    
+    for (unsigned r = 0; r < readers; ++r) {
+        int cpu = first_cpu >= 0 ? static_cast<int>((first_cpu + 1 + r) % cpu_count()) : -1;
+        threads.emplace_back([&, r, cpu]() {
+            pin_current_thread(cpu);
+            reader(running, stats[r]);
+        });
+    }
+    
+    std::thread writer([&]() {
+        pin_current_thread(first_cpu);
+        drive_book(book, running, updates);
+    });
+    
+    std::this_thread::sleep_for(milliseconds(duration_ms));
+    running.store(false);
+    
+    writer.join();
+    for (auto& t : threads) {
+        t.join();
+    }
+    
+    double seconds = duration_ms / 1000.0;
+    std::cout << "Writer updates: " << std::fixed << std::setprecision(0)
+              << updates / seconds << " /sec (top version " << book.published_top().version() << ")\n";
+    
+    for (unsigned r = 0; r < readers; ++r) {
+        const ReaderStats& s = stats[r];
+        double retry_rate = s.reads > 0 ? 100.0 * s.retries / s.reads : 0.0;
+        std::cout << "Reader " << r << ": "
+                  << std::setprecision(0) << s.reads / seconds << " reads/sec, "
+                  << std::setprecision(3) << retry_rate << "% retries, "
+                  << "p50 " << s.latency.percentile(0.50) << " / "
+                  << "p99 " << s.latency.percentile(0.99) << " / "
+                  << "max " << s.latency.max() << " cycles\n";
+        if (s.torn > 0) {
+            std::cout << "  Inconsistent copies: " << s.torn << "\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    unsigned readers = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 3;
+    int duration_ms = argc > 2 ? std::atoi(argv[2]) : 1000;
+    int writer_cpu = argc > 3 ? std::atoi(argv[3]) : -1;
+    
+    std::cout << "Seqlock Publication Benchmark\n";
+    std::cout << "=============================\n";
+    std::cout << "Usage: seqlock_benchmark [readers] [duration_ms] [writer_cpu]\n";
+    std::cout << "Readers are pinned to the cores after writer_cpu when it is given\n";
+    
+    {
+        EnhancedOrderBook book("AAPL");
+        run_phase("Top of book", book, readers, duration_ms, writer_cpu,
+                  [&book](const std::atomic<bool>& running, ReaderStats& stats) {
+            read_slot(book.published_top(), running, stats, [](const TopOfBook& top) {
+                return top.bid_size == 0 || top.ask_size == 0 || top.bid_price < top.ask_price;
+            });
+        });
+    }
+    
+    {
+        EnhancedOrderBook book("AAPL");
+        book.enable_depth_publishing();
+        run_phase("Top-N depth", book, readers, duration_ms, writer_cpu,
+                  [&book](const std::atomic<bool>& running, ReaderStats& stats) {
+            read_slot(*book.published_depth(), running, stats,
+                      [](const DepthSnapshot<EnhancedOrderBook::DEPTH_LEVELS>& depth) {
+                for (uint32_t i = 1; i < depth.bid_count; ++i) {
+                    if (depth.bids[i].price >= depth.bids[i - 1].price) return false;
+                }
+                for (uint32_t i = 1; i < depth.ask_count; ++i) {
+                    if (depth.asks[i].price <= depth.asks[i - 1].price) return false;
+                }
+                return true;
+            });
+        });
+    }
+    
+    return 0;
+}
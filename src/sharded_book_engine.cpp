@@ -0,0 +1,357 @@
+#include "sharded_book_engine.hpp"
+#include "thread_affinity.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std::chrono;
+
+ShardedBookEngine::ShardedBookEngine(const Config& config)
+    : config_(config)
+    , shard_of_(ItchBookBuilder::MAX_LOCATES)
+    , running_(false)
+    , next_sequence_(1)
+    , dispatched_(0)
+    , input_stalls_(0)
+    , locate_messages_(ItchBookBuilder::MAX_LOCATES, 0)
+    , since_rebalance_(0)
+    , migration_in_flight_(false)
+    , handoff_ready_(false)
+    , migrations_(0)
+    , handoff_wait_ns_(0)
+    , rebalances_(0)
+    , last_migrated_(0) {
+    
+    if (config.shards == 0) {
+        throw std::invalid_argument("shard count must be positive");
+    }
+    
+    for (size_t i = 0; i < config.shards; ++i) {
+        int cpu = i < config.cpus.size() ? config.cpus[i] : -1;
+        shards_.push_back(std::make_unique<Shard>(config.queue_capacity, cpu));
+    }
+    
+    for (size_t locate = 0; locate < shard_of_.size(); ++locate) {
+        shard_of_[locate] = static_cast<uint16_t>(locate % config.shards);
+    }
+}
+
+ShardedBookEngine::~ShardedBookEngine() {
+    stop();
+}
+
+void ShardedBookEngine::assign(uint16_t stock_locate, size_t shard) {
+    if (running_) {
+        throw std::runtime_error("cannot reassign locates while running");
+    }
+    if (shard >= shards_.size()) {
+        throw std::invalid_argument("shard index out of range");
+    }
+    shard_of_[stock_locate] = static_cast<uint16_t>(shard);
+}
+
+void ShardedBookEngine::start() {
+    if (running_) return;
+    
+    running_ = true;
+    started_ = steady_clock::now();
+    for (auto& shard : shards_) {
+        Shard* s = shard.get();
+        s->thread = std::thread([this, s]() { worker_loop(*s); });
+    }
+}
+
+void ShardedBookEngine::stop() {
+    if (!running_) return;
+    
+    running_ = false;
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+    stopped_ = steady_clock::now();
+}
+
+uint64_t ShardedBookEngine::dispatch(const itch::Message& msg) {
+    uint16_t locate = std::visit([](const auto& m) -> uint16_t { return m.stock_locate; }, msg);
+    uint64_t sequence = next_sequence_++;
+    push(*shards_[shard_of_[locate]], InputMessage{sequence, Command::Apply, locate, msg});
+    dispatched_++;
+    
+    if (locate_messages_[locate]++ == 0) {
+        hot_locates_.push_back(locate);
+    }
+    if (config_.rebalance_interval > 0 && ++since_rebalance_ >= config_.rebalance_interval) {
+        rebalance();
+    }
+    
+    return sequence;
+}
+
+void ShardedBookEngine::push(Shard& shard, InputMessage&& item) {
+    uint64_t sequence = item.sequence;
+    while (!shard.input.try_push(std::move(item))) {
+        input_stalls_++;
+        std::this_thread::yield();
+    }
+    shard.routed.store(sequence, std::memory_order_release);
+}
+
+size_t ShardedBookEngine::dispatch_buffer(const uint8_t* data, size_t size) {
+    itch::Parser parser(data, size);
+    size_t dispatched = 0;
+    
+    while (parser.has_more()) {
+        auto msg = parser.parse_next();
+        if (msg) {
+            dispatch(*msg);
+            dispatched++;
+        }
+    }
+    
+    return dispatched;
+}
+
+bool ShardedBookEngine::migrate(uint16_t stock_locate, size_t shard) {
+    if (shard >= shards_.size()) {
+        throw std::invalid_argument("shard index out of range");
+    }
+    
+    size_t from = shard_of_[stock_locate];
+    if (from == shard || migration_in_flight_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    
+    if (!running_) {
+        shards_[shard]->builder.adopt_book(stock_locate,
+                                           shards_[from]->builder.release_book(stock_locate));
+        shard_of_[stock_locate] = static_cast<uint16_t>(shard);
+        last_migrated_ = stock_locate;
+        migrations_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    
+    // The old owner releases the book after every event already routed to it;
+    // the new owner adopts it before any event routed after this point.
+    migration_in_flight_.store(true, std::memory_order_relaxed);
+    handoff_ready_.store(false, std::memory_order_relaxed);
+    push(*shards_[from], InputMessage{next_sequence_++, Command::Release, stock_locate, itch::Message()});
+    push(*shards_[shard], InputMessage{next_sequence_++, Command::Adopt, stock_locate, itch::Message()});
+    shard_of_[stock_locate] = static_cast<uint16_t>(shard);
+    last_migrated_ = stock_locate;
+    
+    return true;
+}
+
+bool ShardedBookEngine::rebalance() {
+    rebalances_++;
+    since_rebalance_ = 0;
+    
+    std::vector<uint64_t> load(shards_.size(), 0);
+    uint64_t total = 0;
+    for (uint16_t locate : hot_locates_) {
+        load[shard_of_[locate]] += locate_messages_[locate];
+        total += locate_messages_[locate];
+    }
+    
+    size_t hot = std::max_element(load.begin(), load.end()) - load.begin();
+    size_t cold = std::min_element(load.begin(), load.end()) - load.begin();
+    double average = static_cast<double>(total) / shards_.size();
+    
+    uint16_t candidate = 0;
+    bool found = false;
+    
+    if (total > 0 && load[hot] > average * config_.imbalance_threshold &&
+        !migration_in_flight_.load(std::memory_order_acquire)) {
+        // Moving c messages narrows the gap only when 0 < c < gap; c near gap / 2 flattens it most.
+        uint64_t gap = load[hot] - load[cold];
+        uint64_t best_distance = UINT64_MAX;
+        for (uint16_t locate : hot_locates_) {
+            uint64_t count = locate_messages_[locate];
+            if (shard_of_[locate] != hot || count >= gap) continue;
+            
+            uint64_t distance = static_cast<uint64_t>(std::llabs(static_cast<int64_t>(2 * count) -
+                                                                 static_cast<int64_t>(gap)));
+            if (distance < best_distance) {
+                best_distance = distance;
+                candidate = locate;
+                found = true;
+            }
+        }
+    }
+    
+    // Halve the window so rates track recent traffic.
+    size_t kept = 0;
+    for (uint16_t locate : hot_locates_) {
+        locate_messages_[locate] /= 2;
+        if (locate_messages_[locate] > 0) {
+            hot_locates_[kept++] = locate;
+        }
+    }
+    hot_locates_.resize(kept);
+    
+    return found && migrate(candidate, cold);
+}
+
+void ShardedBookEngine::worker_loop(Shard& shard) {
+    pin_current_thread(shard.cpu);
+    
+    bool busy = false;
+    steady_clock::time_point busy_since;
+    uint64_t handled = 0;
+    
+    while (true) {
+        // Handled in place; the slot goes back to the dispatcher on release().
+        InputMessage* item = shard.input.peek();
+        if (!item) {
+            if (busy) {
+                auto busy_for = duration_cast<nanoseconds>(steady_clock::now() - busy_since).count();
+                shard.busy_ns.fetch_add(busy_for, std::memory_order_relaxed);
+                busy = false;
+            }
+            // The dispatcher stops pushing before it clears running_, so an empty
+            // queue seen after that point is final.
+            if (!running_.load(std::memory_order_acquire) && shard.input.empty()) {
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        
+        if (!busy) {
+            busy_since = steady_clock::now();
+            busy = true;
+        } else if ((++handled & 1023) == 0) {
+            auto now = steady_clock::now();
+            shard.busy_ns.fetch_add(duration_cast<nanoseconds>(now - busy_since).count(),
+                                    std::memory_order_relaxed);
+            busy_since = now;
+        }
+        
+        handle(shard, *item);
+        uint64_t sequence = item->sequence;
+        shard.input.release();
+        
+        shard.messages.fetch_add(1, std::memory_order_relaxed);
+        shard.watermark.store(sequence, std::memory_order_release);
+    }
+}
+
+void ShardedBookEngine::handle(Shard& shard, InputMessage& item) {
+    if (item.command == Command::Release) {
+        handoff_ = shard.builder.release_book(item.stock_locate);
+        handoff_ready_.store(true, std::memory_order_release);
+        return;
+    }
+    
+    if (item.command == Command::Adopt) {
+        // Publishing progress before waiting lets the merge drain the releasing
+        // shard, which may otherwise be stalled on a full output queue.
+        shard.watermark.store(item.sequence, std::memory_order_release);
+        
+        auto wait_start = steady_clock::now();
+        while (!handoff_ready_.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        shard.builder.adopt_book(item.stock_locate, std::move(handoff_));
+        
+        auto waited = duration_cast<nanoseconds>(steady_clock::now() - wait_start).count();
+        handoff_wait_ns_.fetch_add(waited, std::memory_order_relaxed);
+        migrations_.fetch_add(1, std::memory_order_relaxed);
+        migration_in_flight_.store(false, std::memory_order_release);
+        return;
+    }
+    
+    BookUpdate update = shard.builder.process(item.message);
+    if (!update.top_changed()) {
+        return;
+    }
+    
+    BookUpdateEvent event{item.sequence, item.stock_locate, update.changes,
+                          shard.builder.book(item.stock_locate)->top()};
+    
+    while (!shard.output.try_push(event)) {
+        if (!running_.load(std::memory_order_relaxed)) {
+            shard.dropped_updates.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        shard.output_stalls.fetch_add(1, std::memory_order_relaxed);
+        std::this_thread::yield();
+    }
+    shard.updates.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool ShardedBookEngine::poll(BookUpdateEvent& event) {
+    // Events already buffered before the watermarks are sampled may be ordered
+    // against shards that look idle; events popped afterwards wait a round.
+    for (auto& shard : shards_) {
+        shard->pending_fresh = false;
+        if (!shard->pending) {
+            shard->pending = shard->output.try_pop();
+        }
+    }
+    
+    for (auto& shard : shards_) {
+        if (!shard->pending) {
+            shard->seen_routed = shard->routed.load(std::memory_order_acquire);
+            shard->seen_watermark = shard->watermark.load(std::memory_order_acquire);
+            shard->pending = shard->output.try_pop();
+            shard->pending_fresh = shard->pending.has_value();
+        }
+    }
+    
+    size_t best = shards_.size();
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        const auto& pending = shards_[i]->pending;
+        if (pending && (best == shards_.size() ||
+                        pending->sequence < shards_[best]->pending->sequence)) {
+            best = i;
+        }
+    }
+    
+    if (best == shards_.size() || shards_[best]->pending_fresh) {
+        return false;
+    }
+    
+    uint64_t sequence = shards_[best]->pending->sequence;
+    for (const auto& shard : shards_) {
+        if (shard->pending) continue;
+        
+        if (shard->seen_watermark < sequence && shard->seen_watermark != shard->seen_routed) {
+            return false;
+        }
+    }
+    
+    event = *shards_[best]->pending;
+    shards_[best]->pending.reset();
+    return true;
+}
+
+const EnhancedOrderBook* ShardedBookEngine::book(uint16_t stock_locate) const {
+    return shards_[shard_of_[stock_locate]]->builder.book(stock_locate);
+}
+
+ShardedBookEngine::ShardStats ShardedBookEngine::shard_stats(size_t shard) const {
+    const Shard& s = *shards_[shard];
+    ShardStats stats;
+    stats.messages = s.messages.load(std::memory_order_relaxed);
+    stats.updates = s.updates.load(std::memory_order_relaxed);
+    stats.output_stalls = s.output_stalls.load(std::memory_order_relaxed);
+    stats.dropped_updates = s.dropped_updates.load(std::memory_order_relaxed);
+    
+    auto end = running_ ? steady_clock::now() : stopped_;
+    auto elapsed = duration_cast<nanoseconds>(end - started_).count();
+    stats.utilization = elapsed > 0 ?
+        static_cast<double>(s.busy_ns.load(std::memory_order_relaxed)) / elapsed : 0.0;
+    return stats;
+}
+
+ShardedBookEngine::MigrationStats ShardedBookEngine::migration_stats() const {
+    MigrationStats stats;
+    stats.migrations = migrations_.load(std::memory_order_relaxed);
+    stats.rebalances = rebalances_;
+    stats.handoff_wait_ns = handoff_wait_ns_.load(std::memory_order_relaxed);
+    stats.last_locate = last_migrated_;
+    return stats;
+}
@@ -59,7 +59,7 @@ void TradingStrategy::on_quote_update(const OrderBookSnapshot& snapshot) {
     }
 }
 
-void TradingStrategy::on_trade(const std::string& symbol, int64_t price, uint64_t size) {
+void TradingStrategy::on_trade(SymbolId symbol, int64_t price, uint64_t size) {
     (void)symbol;
     (void)price;
     (void)size;
@@ -59,13 +59,11 @@ TickRecorder::~TickRecorder() {
     }
 }
 
-void TickRecorder::record_trade(uint64_t timestamp, const std::string& symbol,
+void TickRecorder::record_trade(uint64_t timestamp, SymbolId symbol,
                                 int64_t price, uint64_t size, uint8_t side) {
     TickRecord record{};
     record.timestamp = timestamp;
-    std::memset(record.symbol, 0, sizeof(record.symbol));
-    std::memcpy(record.symbol, symbol.c_str(), 
-                std::min(symbol.size(), sizeof(record.symbol)));
+    symbol.copy_to(record.symbol);
     record.price = price;
     record.size = size;
     record.side = side;
@@ -74,14 +72,12 @@ void TickRecorder::record_trade(uint64_t timestamp, const std::string& symbol,
     write_record(record);
 }
 
-void TickRecorder::record_quote(uint64_t timestamp, const std::string& symbol,
+void TickRecorder::record_quote(uint64_t timestamp, SymbolId symbol,
                                 int64_t bid_price, uint64_t bid_size,
                                 int64_t ask_price, uint64_t ask_size) {
     TickRecord bid_record{};
     bid_record.timestamp = timestamp;
-    std::memset(bid_record.symbol, 0, sizeof(bid_record.symbol));
-    std::memcpy(bid_record.symbol, symbol.c_str(),
-                std::min(symbol.size(), sizeof(bid_record.symbol)));
+    symbol.copy_to(bid_record.symbol);
     bid_record.price = bid_price;
     bid_record.size = bid_size;
     bid_record.side = 0;
@@ -1,4 +1,5 @@
 #include "websocket_server.hpp"
+#include "arena.hpp"
 #include <cstring>
 #include <sstream>
 #include <iomanip>
@@ -296,63 +297,47 @@ std::string WebSocketServer::generate_accept_key(const std::string& key) {
     return base64_encode(hash, 20);
 }
 
-void WebSocketServer::broadcast(const std::string& message) {
-    std::vector<uint8_t> frame;
-    frame.push_back(0x81);
-    
-    size_t len = message.size();
-    if (len <= 125) {
-        frame.push_back(static_cast<uint8_t>(len));
-    } else if (len <= 65535) {
-        frame.push_back(126);
-        frame.push_back((len >> 8) & 0xFF);
-        frame.push_back(len & 0xFF);
-    } else {
-        frame.push_back(127);
-        for (int i = 7; i >= 0; i--) {
-            frame.push_back((len >> (i * 8)) & 0xFF);
-        }
-    }
-    
-    for (char c : message) {
-        frame.push_back(static_cast<uint8_t>(c));
-    }
-    
-    for (auto& client : clients_) {
-        if (client.active && client.socket != INVALID_SOCKET) {
-            send(client.socket, reinterpret_cast<const char*>(frame.data()), 
-                 frame.size(), 0);
-        }
-    }
-}
-
-void WebSocketServer::broadcast_binary(const uint8_t* data, size_t size) {
-    std::vector<uint8_t> frame;
-    frame.push_back(0x82);
+// Frames are built in a scratch arena that rewinds after each send, so
+// steady-state publishing does no heap allocation. The arena is per thread,
+// so concurrent broadcasts never share a frame buffer.
+void WebSocketServer::send_frame(uint8_t opcode, const uint8_t* payload, size_t size) {
+    static thread_local Arena frame_arena;
+    ArenaScope scope(frame_arena);
+    uint8_t* frame = frame_arena.allocate_array<uint8_t>(size + 10);
+    size_t header = 0;
+    frame[header++] = opcode;
     
     if (size <= 125) {
-        frame.push_back(static_cast<uint8_t>(size));
+        frame[header++] = static_cast<uint8_t>(size);
     } else if (size <= 65535) {
-        frame.push_back(126);
-        frame.push_back((size >> 8) & 0xFF);
-        frame.push_back(size & 0xFF);
+        frame[header++] = 126;
+        frame[header++] = (size >> 8) & 0xFF;
+        frame[header++] = size & 0xFF;
     } else {
-        frame.push_back(127);
+        frame[header++] = 127;
         for (int i = 7; i >= 0; i--) {
-            frame.push_back((size >> (i * 8)) & 0xFF);
+            frame[header++] = (size >> (i * 8)) & 0xFF;
         }
     }
     
-    frame.insert(frame.end(), data, data + size);
+    std::memcpy(frame + header, payload, size);
     
     for (auto& client : clients_) {
         if (client.active && client.socket != INVALID_SOCKET) {
-            send(client.socket, reinterpret_cast<const char*>(frame.data()), 
-                 frame.size(), 0);
+            send(client.socket, reinterpret_cast<const char*>(frame), 
+                 header + size, 0);
         }
     }
 }
 
+void WebSocketServer::broadcast(const std::string& message) {
+    send_frame(0x81, reinterpret_cast<const uint8_t*>(message.data()), message.size());
+}
+
+void WebSocketServer::broadcast_binary(const uint8_t* data, size_t size) {
+    send_frame(0x82, data, size);
+}
+
 size_t WebSocketServer::client_count() const {
     size_t count = 0;
     for (const auto& client : clients_) {
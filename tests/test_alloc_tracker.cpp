@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "alloc_tracker.hpp"
+#include "book_snapshot.hpp"
+#include "enhanced_order_book.hpp"
+#include "lock_free_queue.hpp"
+#include "market_event.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class AllocTrackerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!AllocTracker::active()) {
+            GTEST_SKIP() << "built without ENABLE_ALLOC_TRACKING";
+        }
+    }
+    
+    static void expect_no_allocations(const AllocRegion& region) {
+        EXPECT_EQ(region.allocations(), 0u);
+        if (region.allocations() != 0) {
+            AllocTracker::dump_stacks(2);
+        }
+    }
+};
+
+TEST_F(AllocTrackerTest, CountsHeapAllocationsPerThread) {
+    AllocRegion region;
+    
+    auto value = std::make_unique<uint64_t>(42);
+    std::vector<int> values(100);
+    void* volatile raw = std::malloc(64);
+    std::free(raw);
+    
+    EXPECT_GE(region.allocations(), 3u);
+    EXPECT_GE(region.bytes(), 64u + 100 * sizeof(int));
+    EXPECT_GE(region.deallocations(), 1u);
+    
+    // Another thread's allocations do not show up here.
+    uint64_t before = region.allocations();
+    std::thread other([]() {
+        std::vector<int> scratch(1000);
+        EXPECT_EQ(scratch.size(), 1000u);
+    });
+    other.join();
+    EXPECT_LE(region.allocations() - before, 2u);
+}
+
+TEST_F(AllocTrackerTest, CapturesStacksInsideRegion) {
+    AllocRegion region(true);
+    auto value = std::make_unique<uint64_t>(1);
+    EXPECT_EQ(region.allocations(), 1u);
+    EXPECT_EQ(AllocTracker::captured_stacks(), 1u);
+}
+
+TEST_F(AllocTrackerTest, EnhancedOrderBookSteadyStateDoesNotAllocate) {
+    EnhancedOrderBook book("TEST");
+    
+    // Warm the order map's buckets and the node pools to the working size.
+    auto cycle = [&book](uint64_t base, uint64_t ts) {
+        for (uint64_t i = 0; i < 512; ++i) {
+            int64_t offset = static_cast<int64_t>(i % 32) * 100;
+            book.add_order(base + i, i % 2 ? 'B' : 'S', i % 2 ? 1000000 - offset : 1000100 + offset, 100, ts);
+        }
+        for (uint64_t i = 0; i < 512; i += 4) {
+            book.execute_order(base + i, 40, ts);
+            book.replace_order(base + i + 1, base + 512 + i, 200, 1000000 - 100 * static_cast<int64_t>(i % 16), ts);
+        }
+        for (uint64_t i = 0; i < 512; ++i) {
+            book.delete_order(base + i, ts);
+            book.delete_order(base + 512 + i, ts);
+        }
+    };
+    cycle(1, 1);
+    
+    AllocRegion region(true);
+    for (uint64_t round = 0; round < 10; ++round) {
+        cycle(10000 * (round + 1), round + 2);
+    }
+    expect_no_allocations(region);
+    EXPECT_EQ(book.total_orders(), 0u);
+}
+
+TEST_F(AllocTrackerTest, SPSCQueuePushPopDoesNotAllocate) {
+    SPSCQueue<MarketEvent> queue(1024);
+    MarketEvent event;
+    
+    AllocRegion region(true);
+    for (uint64_t i = 0; i < 10000; ++i) {
+        event.order_ref = i;
+        ASSERT_TRUE(queue.try_push(event));
+        auto popped = queue.try_pop();
+        ASSERT_TRUE(popped.has_value());
+    }
+    expect_no_allocations(region);
+}
+
+TEST_F(AllocTrackerTest, BoundedMPSCQueuePushPopDoesNotAllocate) {
+    BoundedMPSCQueue<MarketEvent> queue(1024);
+    MarketEvent event;
+    
+    AllocRegion region(true);
+    for (uint64_t i = 0; i < 10000; ++i) {
+        event.order_ref = i;
+        ASSERT_TRUE(queue.try_push(event));
+        auto popped = queue.try_pop();
+        ASSERT_TRUE(popped.has_value());
+    }
+    expect_no_allocations(region);
+}
+
+TEST_F(AllocTrackerTest, SnapshotCopiesDoNotAllocate) {
+    ItchBookBuilder builder;
+    BookSnapshotter snapshot(builder);
+    for (uint16_t locate = 1; locate <= 4; ++locate) {
+        itch::StockDirectory dir{};
+        dir.type = 'R';
+        dir.stock_locate = locate;
+        std::memcpy(dir.stock, "SYM     ", 8);
+        builder.process(dir);
+        for (uint32_t i = 0; i < 256; ++i) {
+            itch::AddOrder add{};
+            add.type = 'A';
+            add.stock_locate = locate;
+            add.order_reference = locate * 1000u + i;
+            add.buy_sell = i % 2 ? 'S' : 'B';
+            add.shares = 100;
+            add.price = i % 2 ? 1500100 + (i % 16) * 100 : 1500000 - (i % 16) * 100;
+            builder.process(add);
+        }
+    }
+    
+    // begin() sizes the copy buffers; the feed-side copies then fit in them.
+    ASSERT_TRUE(snapshot.begin(0, 0));
+    {
+        AllocRegion region(true);
+        snapshot.before_write(3);
+        while (snapshot.capture_next()) {}
+        expect_no_allocations(region);
+    }
+    
+    auto stats = snapshot.stats();
+    EXPECT_EQ(stats.feed_copies, 1u);
+    EXPECT_EQ(stats.sweep_copies, 3u);
+    std::vector<uint8_t> image;
+    EXPECT_GT(snapshot.write_image(image), 0u);
+}
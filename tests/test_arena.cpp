@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "arena.hpp"
+#include "enhanced_order_book.hpp"
+#include <cstdint>
+
+TEST(ArenaTest, ScopeRewindsAndReusesBlocks) {
+    Arena arena(1024);
+    
+    void* outer = arena.allocate(100);
+    void* first = nullptr;
+    {
+        ArenaScope scope(arena);
+        first = arena.allocate(64, 64);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % 64, 0u);
+        // Spills into a second block, which is kept after the rewind.
+        arena.allocate(2000);
+        EXPECT_EQ(arena.block_count(), 2u);
+    }
+    
+    EXPECT_EQ(arena.allocate(64, 64), first);
+    EXPECT_NE(outer, first);
+    
+    for (int batch = 0; batch < 100; ++batch) {
+        ArenaScope scope(arena);
+        arena.allocate(900);
+        arena.allocate(900);
+    }
+    EXPECT_EQ(arena.block_count(), 2u);
+    
+    arena.reset();
+    EXPECT_EQ(arena.allocate(100), outer);
+}
+
+TEST(ArenaTest, ContainersDrawFromArena) {
+    Arena arena(4096);
+    {
+        ArenaScope scope(arena);
+        ArenaVector<uint64_t> values{ArenaAllocator<uint64_t>(arena)};
+        for (uint64_t i = 0; i < 1000; ++i) {
+            values.push_back(i);
+        }
+        EXPECT_EQ(values[999], 999u);
+        
+        ArenaString text{ArenaAllocator<char>(arena)};
+        text.append("a fairly long string that does not fit the small buffer");
+        EXPECT_EQ(text.size(), 55u);
+    }
+    size_t blocks = arena.block_count();
+    
+    {
+        ArenaScope scope(arena);
+        ArenaVector<uint64_t> values{ArenaAllocator<uint64_t>(arena)};
+        values.resize(1000);
+    }
+    EXPECT_EQ(arena.block_count(), blocks);
+}
+
+TEST(ArenaTest, BookDepthIntoArena) {
+    EnhancedOrderBook book("TEST");
+    for (uint64_t i = 0; i < 40; ++i) {
+        book.add_order(i + 1, 'B', 1000000 - static_cast<int64_t>(i) * 100, 100 + i, i);
+        book.add_order(i + 100, 'S', 1000100 + static_cast<int64_t>(i) * 100, 200, i);
+    }
+    
+    Arena arena;
+    ArenaScope scope(arena);
+    for (size_t levels : {size_t(5), size_t(30), size_t(100)}) {
+        LevelSpan bids = book.get_bid_depth(levels, arena);
+        LevelSpan asks = book.get_ask_depth(levels, arena);
+        auto expected = book.get_bid_depth(levels);
+        
+        ASSERT_EQ(bids.size, expected.size());
+        EXPECT_EQ(asks.size, std::min<size_t>(levels, 40));
+        for (size_t i = 0; i < bids.size; ++i) {
+            EXPECT_EQ(bids[i].price, expected[i].price);
+            EXPECT_EQ(bids[i].size, expected[i].size);
+        }
+    }
+    
+    // The copy is independent of later book changes.
+    LevelSpan bids = book.get_bid_depth(3, arena);
+    book.delete_order(1, 100);
+    EXPECT_EQ(bids[0].price, 1000000);
+}
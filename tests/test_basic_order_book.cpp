@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include "basic_order_book.hpp"
+#include "enhanced_order_book.hpp"
+#include <random>
+#include <vector>
+
+template<typename Book>
+class BasicOrderBookTest : public ::testing::Test {};
+
+using BookPolicies = ::testing::Types<
+    BasicOrderBook<TreeLevels>,
+    BasicOrderBook<PooledTreeLevels, PooledHashOrderStore>,
+    BasicOrderBook<SortedVectorLevels, DenseOrderStore>,
+    BasicOrderBook<DenseLadderLevels<100>, DenseOrderStore, TrackSideTotals>,
+    BasicOrderBook<DenseLadderLevels<100, 256>, HashOrderStore, NoSideTotals, 5>,
+    BasicOrderBook<InlineLevels<8>, DenseOrderStore>,
+    BasicOrderBook<InlineLevels<16, DenseLadderLevels<100>>, HashOrderStore, TrackSideTotals, 20>
+>;
+TYPED_TEST_SUITE(BasicOrderBookTest, BookPolicies);
+
+TYPED_TEST(BasicOrderBookTest, MatchesEnhancedOrderBook) {
+    TypeParam book;
+    EnhancedOrderBook reference("TEST");
+    
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> live;
+    uint64_t next_id = 1;
+    
+    for (int step = 0; step < 20000; ++step) {
+        uint64_t ts = static_cast<uint64_t>(step);
+        int action = static_cast<int>(rng() % 10);
+        
+        if (live.empty() || action < 5) {
+            bool buy = rng() % 2 == 0;
+            int64_t offset = static_cast<int64_t>(rng() % 40) * 100;
+            int64_t price = buy ? 1000000 - offset : 1000100 + offset;
+            uint64_t quantity = 100 + rng() % 900;
+            uint64_t id = next_id++;
+            ASSERT_EQ(bool(book.add_order(id, buy ? 'B' : 'S', price, quantity, ts)),
+                      bool(reference.add_order(id, buy ? 'B' : 'S', price, quantity, ts)));
+            live.push_back(id);
+        } else {
+            size_t pick = rng() % live.size();
+            uint64_t id = live[pick];
+            const Order* order = reference.find_order(id);
+            ASSERT_NE(order, nullptr);
+            
+            if (action < 7) {
+                uint64_t quantity = 1 + rng() % order->quantity;
+                bool gone = quantity == order->quantity;
+                EXPECT_TRUE(book.execute_order(id, quantity, ts));
+                reference.execute_order(id, quantity, ts);
+                if (gone) {
+                    live[pick] = live.back();
+                    live.pop_back();
+                }
+            } else if (action < 9) {
+                EXPECT_TRUE(book.delete_order(id, ts));
+                reference.delete_order(id, ts);
+                live[pick] = live.back();
+                live.pop_back();
+            } else {
+                int64_t price = order->price + (order->side == 'B' ? -100 : 100);
+                uint64_t new_id = next_id++;
+                EXPECT_TRUE(book.replace_order(id, new_id, order->quantity + 10, price, ts));
+                reference.replace_order(id, new_id, order->quantity + 10, price, ts);
+                live[pick] = new_id;
+            }
+        }
+        
+        ASSERT_EQ(book.top().bid_price, reference.top().bid_price) << "step " << step;
+        ASSERT_EQ(book.top().bid_size, reference.top().bid_size) << "step " << step;
+        ASSERT_EQ(book.top().ask_price, reference.top().ask_price) << "step " << step;
+        ASSERT_EQ(book.top().ask_size, reference.top().ask_size) << "step " << step;
+    }
+    
+    EXPECT_EQ(book.total_orders(), reference.total_orders());
+    EXPECT_EQ(book.bid_levels(), reference.bid_levels());
+    EXPECT_EQ(book.ask_levels(), reference.ask_levels());
+    
+    DepthSnapshot<TypeParam::MAX_DEPTH> depth;
+    book.depth(depth);
+    auto bids = reference.get_bid_depth(TypeParam::MAX_DEPTH);
+    auto asks = reference.get_ask_depth(TypeParam::MAX_DEPTH);
+    ASSERT_EQ(depth.bid_count, bids.size());
+    ASSERT_EQ(depth.ask_count, asks.size());
+    for (size_t i = 0; i < bids.size(); ++i) {
+        EXPECT_EQ(depth.bids[i].price, bids[i].price);
+        EXPECT_EQ(depth.bids[i].size, bids[i].size);
+        EXPECT_EQ(depth.bids[i].order_count, bids[i].order_count);
+    }
+    for (size_t i = 0; i < asks.size(); ++i) {
+        EXPECT_EQ(depth.asks[i].price, asks[i].price);
+        EXPECT_EQ(depth.asks[i].size, asks[i].size);
+    }
+}
+
+TYPED_TEST(BasicOrderBookTest, ReportsTouchAndDepthChanges) {
+    TypeParam book;
+    
+    EXPECT_EQ(book.add_order(1, 'B', 1000000, 100, 1).changes, BBO_PRICE_CHANGED | BBO_SIZE_CHANGED);
+    EXPECT_EQ(book.add_order(2, 'B', 1000000, 50, 2).changes, BBO_SIZE_CHANGED);
+    EXPECT_EQ(book.add_order(3, 'B', 999900, 50, 3).changes, DEPTH_CHANGED);
+    EXPECT_FALSE(book.add_order(3, 'S', 1000100, 50, 4));
+    EXPECT_FALSE(book.delete_order(42, 5));
+    EXPECT_EQ(book.ask_levels(), 0u);
+    
+    EXPECT_EQ(book.delete_order(1, 6).changes, BBO_SIZE_CHANGED);
+    EXPECT_EQ(book.delete_order(2, 7).changes, BBO_PRICE_CHANGED);
+    EXPECT_EQ(book.top().bid_price, 999900);
+    EXPECT_EQ(book.bid_levels(), 1u);
+}
+
+TEST(DenseLadderLevelsTest, RecentresAndRejectsOffGrid) {
+    BasicOrderBook<DenseLadderLevels<100, 1024>, HashOrderStore, TrackSideTotals> book;
+    
+    ASSERT_TRUE(book.add_order(1, 'B', 1000000, 100, 1));
+    ASSERT_TRUE(book.add_order(2, 'B', 1040000, 100, 2));
+    ASSERT_TRUE(book.add_order(3, 'B', 960000, 100, 3));
+    EXPECT_EQ(book.top().bid_price, 1040000);
+    EXPECT_EQ(book.bid_levels(), 3u);
+    
+    EXPECT_FALSE(book.add_order(4, 'B', 1000050, 100, 4));
+    EXPECT_FALSE(book.add_order(5, 'B', 5000000, 100, 5));
+    EXPECT_EQ(book.total_orders(), 3u);
+    
+    ASSERT_TRUE(book.add_order(6, 'S', 1040100, 300, 6));
+    EXPECT_EQ(book.total_quantity(Side::Bid), 300u);
+    EXPECT_DOUBLE_EQ(book.imbalance(), 0.0);
+    
+    ASSERT_TRUE(book.delete_order(2, 7));
+    EXPECT_EQ(book.top().bid_price, 1000000);
+    
+    std::vector<int64_t> prices;
+    book.levels<Side::Bid>().for_each([&](const PriceLevel& level) { prices.push_back(level.price); });
+    EXPECT_EQ(prices, (std::vector<int64_t>{1000000, 960000}));
+}
+
+TEST(InlineLevelsTest, PromotesAndDemotesBestFirst) {
+    InlineLevels<4>::Store<Side::Ask> levels;
+    
+    for (int64_t price : {1000300, 1000100, 1000200, 1000000}) {
+        levels.insert(price)->size = 100;
+    }
+    EXPECT_FALSE(levels.promoted());
+    EXPECT_EQ(levels.best()->price, 1000000);
+    ASSERT_NE(levels.find(1000200), nullptr);
+    EXPECT_EQ(levels.find(1000250), nullptr);
+    
+    levels.insert(999900)->size = 100;
+    EXPECT_TRUE(levels.promoted());
+    EXPECT_EQ(levels.size(), 5u);
+    EXPECT_EQ(levels.best()->price, 999900);
+    
+    levels.erase(999900);
+    levels.erase(1000200);
+    EXPECT_TRUE(levels.promoted());
+    levels.erase(1000300);
+    EXPECT_FALSE(levels.promoted());
+    
+    std::vector<int64_t> prices;
+    levels.for_each([&](const PriceLevel& level) { prices.push_back(level.price); });
+    EXPECT_EQ(prices, (std::vector<int64_t>{1000000, 1000100}));
+    EXPECT_EQ(levels.find(1000100)->size, 100u);
+}
+
+TEST(InlineLevelsTest, RefusedPromotionKeepsInlineLevels) {
+    InlineLevels<4, DenseLadderLevels<100>>::Store<Side::Bid> levels;
+    
+    // Inline storage takes any price; the ladder only takes whole ticks.
+    for (int64_t price : {1000000, 999900, 999850, 999700}) {
+        levels.insert(price)->size = 100;
+    }
+    
+    EXPECT_EQ(levels.insert(999600), nullptr);
+    EXPECT_FALSE(levels.promoted());
+    EXPECT_EQ(levels.size(), 4u);
+    ASSERT_NE(levels.find(999850), nullptr);
+    EXPECT_EQ(levels.find(999850)->size, 100u);
+    EXPECT_EQ(levels.best()->price, 1000000);
+    
+    levels.erase(999850);
+    ASSERT_NE(levels.insert(999600), nullptr);
+    levels.find(999600)->size = 100;
+    levels.insert(999500)->size = 100;
+    EXPECT_TRUE(levels.promoted());
+    EXPECT_EQ(levels.size(), 5u);
+}
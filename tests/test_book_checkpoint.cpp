@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+#include "book_checkpoint.hpp"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+class BookCheckpointTest : public ::testing::Test {
+protected:
+    std::string path;
+    
+    void SetUp() override {
+        path = ::testing::TempDir() + "book_checkpoint_test.ckpt";
+        std::remove(path.c_str());
+    }
+    
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+    
+    static std::vector<itch::Message> make_stream(size_t rounds) {
+        std::vector<itch::Message> stream;
+        const char* names[] = {"AAPL    ", "MSFT    ", "GOOG    "};
+        
+        for (uint16_t locate = 1; locate <= 3; ++locate) {
+            itch::StockDirectory dir{};
+            dir.type = 'R';
+            dir.stock_locate = locate;
+            std::memcpy(dir.stock, names[locate - 1], 8);
+            stream.push_back(dir);
+        }
+        
+        uint64_t ref = 1;
+        for (size_t round = 0; round < rounds; ++round) {
+            for (uint16_t locate = 1; locate <= 3; ++locate) {
+                itch::AddOrder add{};
+                add.type = 'A';
+                add.stock_locate = locate;
+                add.order_reference = ref;
+                add.buy_sell = round % 2 ? 'S' : 'B';
+                add.shares = static_cast<uint32_t>(100 + round);
+                add.price = static_cast<uint32_t>(round % 2 ? 1500100 + (round % 7) * 100
+                                                            : 1500000 - (round % 5) * 100);
+                stream.push_back(add);
+                
+                if (round % 4 == 3) {
+                    itch::OrderDelete del{};
+                    del.type = 'D';
+                    del.stock_locate = locate;
+                    del.order_reference = ref - 6;
+                    stream.push_back(del);
+                } else if (round % 3 == 2) {
+                    itch::OrderExecuted exec{};
+                    exec.type = 'E';
+                    exec.stock_locate = locate;
+                    exec.order_reference = ref - 3;
+                    exec.executed_shares = 10;
+                    stream.push_back(exec);
+                }
+                ref++;
+            }
+        }
+        return stream;
+    }
+    
+    static void expect_same_books(const ItchBookBuilder& expected, const ItchBookBuilder& actual) {
+        ASSERT_EQ(expected.book_count(), actual.book_count());
+        
+        for (uint16_t locate : expected.locates()) {
+            const EnhancedOrderBook* a = expected.book(locate);
+            const EnhancedOrderBook* b = actual.book(locate);
+            ASSERT_NE(b, nullptr);
+            
+            EXPECT_EQ(a->symbol(), b->symbol());
+            EXPECT_EQ(a->total_orders(), b->total_orders());
+            EXPECT_EQ(a->message_count(), b->message_count());
+            EXPECT_EQ(a->top().bid_price, b->top().bid_price);
+            EXPECT_EQ(a->top().bid_size, b->top().bid_size);
+            EXPECT_EQ(a->top().ask_price, b->top().ask_price);
+            EXPECT_EQ(a->top().ask_size, b->top().ask_size);
+            EXPECT_DOUBLE_EQ(a->imbalance(), b->imbalance());
+            
+            auto bids_a = a->get_bid_depth(100);
+            auto bids_b = b->get_bid_depth(100);
+            ASSERT_EQ(bids_a.size(), bids_b.size());
+            for (size_t i = 0; i < bids_a.size(); ++i) {
+                EXPECT_EQ(bids_a[i].price, bids_b[i].price);
+                EXPECT_EQ(bids_a[i].size, bids_b[i].size);
+                EXPECT_EQ(bids_a[i].order_count, bids_b[i].order_count);
+            }
+            
+            auto asks_a = a->get_ask_depth(100);
+            auto asks_b = b->get_ask_depth(100);
+            ASSERT_EQ(asks_a.size(), asks_b.size());
+            for (size_t i = 0; i < asks_a.size(); ++i) {
+                EXPECT_EQ(asks_a[i].price, asks_b[i].price);
+                EXPECT_EQ(asks_a[i].size, asks_b[i].size);
+                EXPECT_EQ(asks_a[i].order_count, asks_b[i].order_count);
+            }
+        }
+    }
+};
+
+TEST_F(BookCheckpointTest, RoundTripRestoresBooks) {
+    ItchBookBuilder live;
+    for (const auto& msg : make_stream(40)) {
+        live.process(msg);
+    }
+    
+    CheckpointWriter writer(path);
+    ASSERT_TRUE(writer.write_now(live, 4096, 123));
+    
+    CheckpointReader reader(path);
+    EXPECT_EQ(reader.feed_offset(), 4096u);
+    EXPECT_EQ(reader.sequence(), 123u);
+    EXPECT_EQ(reader.book_count(), 3u);
+    
+    ItchBookBuilder restored;
+    ASSERT_TRUE(reader.restore(restored));
+    expect_same_books(live, restored);
+    
+    // Restored orders keep their queue priority.
+    const EnhancedOrderBook* book = live.book(1);
+    const Order* front = nullptr;
+    book->for_each_order([&front](const Order& order) {
+        if (order.side == 'B' && (!front || order.price > front->price ||
+                                  (order.price == front->price && order.priority < front->priority))) {
+            front = &order;
+        }
+    });
+    ASSERT_NE(front, nullptr);
+    
+    EnhancedOrderBook* copy = restored.book(1);
+    ASSERT_TRUE(copy->watch_order(front->order_id));
+    EXPECT_EQ(copy->queue_position(front->order_id)->orders_ahead, 0u);
+}
+
+TEST_F(BookCheckpointTest, ResumeFromStoredOffsetMatchesFullReplay) {
+    auto stream = make_stream(60);
+    size_t checkpoint_at = stream.size() / 2;
+    
+    ItchBookBuilder live;
+    CheckpointWriter writer(path);
+    for (size_t i = 0; i < stream.size(); ++i) {
+        if (i == checkpoint_at) {
+            ASSERT_TRUE(writer.write_now(live, i, i));
+        }
+        live.process(stream[i]);
+    }
+    
+    CheckpointReader reader(path);
+    ItchBookBuilder resumed;
+    ASSERT_TRUE(reader.restore(resumed));
+    for (size_t i = reader.feed_offset(); i < stream.size(); ++i) {
+        resumed.process(stream[i]);
+    }
+    
+    expect_same_books(live, resumed);
+    EXPECT_EQ(resumed.stats().unknown_order, live.stats().unknown_order);
+}
+
+TEST_F(BookCheckpointTest, BackgroundWriterKeepsLatestImage) {
+    ItchBookBuilder live;
+    auto stream = make_stream(20);
+    
+    CheckpointWriter writer(path, 10);
+    writer.start();
+    for (size_t i = 0; i < stream.size(); ++i) {
+        live.process(stream[i]);
+        if (writer.due(i + 1)) {
+            writer.submit(live, i + 1, i + 1);
+        }
+    }
+    writer.submit(live, stream.size(), stream.size());
+    writer.stop();
+    
+    auto stats = writer.stats();
+    EXPECT_GE(stats.written, 1u);
+    EXPECT_EQ(stats.failed, 0u);
+    EXPECT_EQ(stats.last_sequence, stream.size());
+    
+    CheckpointReader reader(path);
+    EXPECT_EQ(reader.sequence(), stream.size());
+    
+    ItchBookBuilder restored;
+    ASSERT_TRUE(reader.restore(restored));
+    expect_same_books(live, restored);
+}
+
+TEST_F(BookCheckpointTest, RejectsCorruptImage) {
+    ItchBookBuilder live;
+    for (const auto& msg : make_stream(10)) {
+        live.process(msg);
+    }
+    
+    std::vector<uint8_t> image;
+    serialize_checkpoint(live, 0, 0, image);
+    image[sizeof(CheckpointHeader) + sizeof(CheckpointBook) + 3] ^= 0x40;
+    ASSERT_TRUE(write_checkpoint_file(path, image.data(), image.size()));
+    EXPECT_THROW(CheckpointReader reader(path), std::runtime_error);
+    
+    ASSERT_TRUE(write_checkpoint_file(path, image.data(), sizeof(CheckpointHeader) / 2));
+    EXPECT_THROW(CheckpointReader reader(path), std::runtime_error);
+    
+    EXPECT_THROW(CheckpointReader reader(path + ".missing"), std::runtime_error);
+}
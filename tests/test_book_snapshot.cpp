@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include "book_snapshot.hpp"
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+class BookSnapshotTest : public ::testing::Test {
+protected:
+    static std::vector<itch::Message> make_stream(uint16_t locates, size_t rounds) {
+        std::vector<itch::Message> stream;
+        
+        for (uint16_t locate = 1; locate <= locates; ++locate) {
+            itch::StockDirectory dir{};
+            dir.type = 'R';
+            dir.stock_locate = locate;
+            std::memcpy(dir.stock, "SYM     ", 8);
+            stream.push_back(dir);
+        }
+        
+        uint64_t ref = 1;
+        for (size_t round = 0; round < rounds; ++round) {
+            for (uint16_t locate = 1; locate <= locates; ++locate) {
+                itch::AddOrder add{};
+                add.type = 'A';
+                add.stock_locate = locate;
+                add.order_reference = ref;
+                add.buy_sell = round % 2 ? 'S' : 'B';
+                add.shares = static_cast<uint32_t>(100 + round);
+                add.price = static_cast<uint32_t>(round % 2 ? 1500100 + (round % 7) * 100
+                                                            : 1500000 - (round % 5) * 100);
+                stream.push_back(add);
+                
+                if (round % 3 == 2) {
+                    itch::OrderExecuted exec{};
+                    exec.type = 'E';
+                    exec.stock_locate = locate;
+                    exec.order_reference = ref - locates;
+                    exec.executed_shares = 10;
+                    stream.push_back(exec);
+                }
+                ref++;
+            }
+        }
+        return stream;
+    }
+    
+    static void expect_same_book(const EnhancedOrderBook& expected, const EnhancedOrderBook& actual) {
+        EXPECT_EQ(expected.total_orders(), actual.total_orders());
+        EXPECT_EQ(expected.message_count(), actual.message_count());
+        EXPECT_EQ(expected.top().bid_price, actual.top().bid_price);
+        EXPECT_EQ(expected.top().bid_size, actual.top().bid_size);
+        EXPECT_EQ(expected.top().ask_price, actual.top().ask_price);
+        EXPECT_EQ(expected.top().ask_size, actual.top().ask_size);
+        EXPECT_EQ(expected.bid_levels(), actual.bid_levels());
+        EXPECT_EQ(expected.ask_levels(), actual.ask_levels());
+    }
+};
+
+TEST_F(BookSnapshotTest, ReaderSeesBooksAsOfBegin) {
+    auto stream = make_stream(8, 50);
+    size_t split = stream.size() / 2;
+    
+    ItchBookBuilder reference;
+    ItchBookBuilder live;
+    BookSnapshotter snapshot(live);
+    for (size_t i = 0; i < split; ++i) {
+        reference.process(stream[i]);
+        live.process(stream[i]);
+    }
+    
+    ASSERT_TRUE(snapshot.begin(split, split));
+    EXPECT_FALSE(snapshot.begin(split, split));
+    
+    // Only the first three locates change after the snapshot opens; the
+    // first write copies its own book and the next one the reader needs.
+    BookSnapshotter::Stats stats{};
+    for (size_t i = split; i < stream.size(); ++i) {
+        uint16_t locate = std::visit([](const auto& m) -> uint16_t { return m.stock_locate; }, stream[i]);
+        if (locate <= 3) {
+            live.process(stream[i]);
+            if (stats.snapshots == 0) {
+                stats = snapshot.stats();
+                EXPECT_EQ(stats.feed_copies, 1u);
+                EXPECT_EQ(stats.sweep_copies, 1u);
+            }
+        }
+    }
+    EXPECT_FALSE(snapshot.capture_next());
+    
+    size_t visited = 0;
+    snapshot.read([&](uint16_t locate, const EnhancedOrderBook& book) {
+        expect_same_book(*reference.book(locate), book);
+        visited++;
+    });
+    
+    EXPECT_EQ(visited, 8u);
+    EXPECT_FALSE(snapshot.active());
+    
+    stats = snapshot.stats();
+    EXPECT_EQ(stats.feed_copies + stats.sweep_copies, 8u);
+    EXPECT_LE(stats.max_feed_copy_ns, stats.feed_copy_ns);
+    
+    // Once the snapshot closes the feed writes without copying.
+    live.process(stream.back());
+    EXPECT_EQ(snapshot.stats().feed_copies, stats.feed_copies);
+    EXPECT_FALSE(snapshot.capture_next());
+}
+
+TEST_F(BookSnapshotTest, ImageMatchesBeginWhileFeedRuns) {
+    auto stream = make_stream(64, 200);
+    size_t split = stream.size() / 3;
+    
+    ItchBookBuilder reference;
+    for (size_t i = 0; i < split; ++i) {
+        reference.process(stream[i]);
+    }
+    
+    for (int attempt = 0; attempt < 5; ++attempt) {
+        ItchBookBuilder live;
+        BookSnapshotter snapshot(live);
+        for (size_t i = 0; i < split; ++i) {
+            live.process(stream[i]);
+        }
+        ASSERT_TRUE(snapshot.begin(split, split));
+        
+        std::vector<uint8_t> image;
+        std::thread reader([&snapshot, &image]() { snapshot.write_image(image); });
+        for (size_t i = split; i < stream.size(); ++i) {
+            live.process(stream[i]);
+        }
+        while (snapshot.capture_next()) {}
+        reader.join();
+        
+        const CheckpointHeader* header = reinterpret_cast<const CheckpointHeader*>(image.data());
+        EXPECT_EQ(header->sequence, split);
+        EXPECT_EQ(header->book_count, 64u);
+        
+        ItchBookBuilder restored;
+        std::vector<Order> scratch;
+        const uint8_t* cursor = image.data() + sizeof(CheckpointHeader);
+        for (uint32_t i = 0; i < header->book_count; ++i) {
+            cursor = restore_book_record(cursor, image.data() + image.size(), restored, scratch);
+            ASSERT_NE(cursor, nullptr);
+        }
+        
+        for (uint16_t locate : reference.locates()) {
+            ASSERT_NE(restored.book(locate), nullptr);
+            expect_same_book(*reference.book(locate), *restored.book(locate));
+        }
+        
+        auto stats = snapshot.stats();
+        EXPECT_EQ(stats.feed_copies + stats.sweep_copies, 64u);
+    }
+}
+
+TEST_F(BookSnapshotTest, CheckpointWriterReadsSnapshotInBackground) {
+    std::string path = ::testing::TempDir() + "book_snapshot_test.ckpt";
+    auto stream = make_stream(16, 100);
+    size_t split = stream.size() / 2;
+    
+    ItchBookBuilder reference;
+    ItchBookBuilder live;
+    BookSnapshotter snapshot(live);
+    CheckpointWriter writer(path);
+    
+    EXPECT_FALSE(writer.submit(snapshot, 0, 0));
+    writer.start();
+    
+    for (size_t i = 0; i < stream.size(); ++i) {
+        if (i == split) {
+            ASSERT_TRUE(writer.submit(snapshot, split, split));
+        }
+        if (i < split) {
+            reference.process(stream[i]);
+        }
+        live.process(stream[i]);
+    }
+    writer.stop();
+    
+    EXPECT_EQ(writer.stats().written, 1u);
+    
+    CheckpointReader reader(path);
+    EXPECT_EQ(reader.feed_offset(), split);
+    
+    ItchBookBuilder restored;
+    ASSERT_TRUE(reader.restore(restored));
+    for (uint16_t locate : reference.locates()) {
+        expect_same_book(*reference.book(locate), *restored.book(locate));
+    }
+    
+    std::remove(path.c_str());
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include "broadcast_ring.hpp"
+#include "market_event.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(BroadcastRingTest, EveryConsumerSeesEveryEvent) {
+    BroadcastRing<int> ring(8);
+    auto& first = ring.add_consumer();
+    auto& second = ring.add_consumer();
+    
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(ring.try_publish(i));
+    }
+    
+    std::vector<int> a, b;
+    EXPECT_EQ(first.poll([&](const int& v) { a.push_back(v); }), 5u);
+    EXPECT_EQ(second.poll([&](const int& v) { b.push_back(v); }, 2), 2u);
+    EXPECT_EQ(second.poll([&](const int& v) { b.push_back(v); }), 3u);
+    
+    EXPECT_EQ(a, (std::vector<int>{0, 1, 2, 3, 4}));
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(first.poll([](const int&) {}), 0u);
+}
+
+TEST(BroadcastRingTest, ProducerWaitsForSlowestConsumer) {
+    BroadcastRing<int> ring(4);
+    auto& fast = ring.add_consumer();
+    auto& slow = ring.add_consumer();
+    
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(ring.try_publish(i));
+    }
+    fast.poll([](const int&) {});
+    EXPECT_FALSE(ring.try_publish(4));
+    EXPECT_EQ(slow.backlog(), 4u);
+    
+    EXPECT_EQ(slow.poll([](const int&) {}, 1), 1u);
+    ASSERT_TRUE(ring.try_publish(4));
+    EXPECT_FALSE(ring.try_publish(5));
+    EXPECT_EQ(fast.lost(), 0u);
+}
+
+TEST(BroadcastRingTest, ClaimBuildsEventInPlace) {
+    BroadcastRing<MarketEvent> ring(4);
+    auto& consumer = ring.add_consumer();
+    
+    MarketEvent* slot = ring.claim();
+    ASSERT_NE(slot, nullptr);
+    EXPECT_EQ(ring.claim(), slot);
+    slot->order_ref = 99;
+    EXPECT_EQ(consumer.poll([](const MarketEvent&) {}), 0u);
+    ring.commit();
+    
+    uint64_t seen = 0;
+    EXPECT_EQ(consumer.poll([&](const MarketEvent& e) { seen = e.order_ref; }), 1u);
+    EXPECT_EQ(seen, 99u);
+}
+
+TEST(BroadcastRingTest, DependentConsumerTrailsItsDependency) {
+    BroadcastRing<int> ring(8);
+    auto& book = ring.add_consumer();
+    auto& recorder = ring.add_consumer({&book});
+    
+    BroadcastRing<int> other(8);
+    EXPECT_THROW(other.add_consumer({&book}), std::invalid_argument);
+    
+    for (int i = 0; i < 3; ++i) {
+        ring.try_publish(i);
+    }
+    EXPECT_EQ(recorder.poll([](const int&) {}), 0u);
+    EXPECT_EQ(book.poll([](const int&) {}, 2), 2u);
+    EXPECT_EQ(recorder.poll([](const int&) {}), 2u);
+    EXPECT_EQ(book.poll([](const int&) {}), 1u);
+    EXPECT_EQ(recorder.poll([](const int&) {}), 1u);
+}
+
+TEST(BroadcastRingTest, ConcurrentChainKeepsOrder) {
+    const uint64_t events = 100000;
+    BroadcastRing<uint64_t> ring(256);
+    auto& book = ring.add_consumer();
+    auto& strategy = ring.add_consumer();
+    auto& recorder = ring.add_consumer({&book, &strategy});
+    
+    auto run = [&](BroadcastRing<uint64_t>::Consumer& consumer, bool check_dependencies) {
+        uint64_t expected = 0;
+        bool ok = true;
+        while (expected < events) {
+            consumer.poll([&](const uint64_t& v) {
+                if (v != expected) ok = false;
+                if (check_dependencies && (book.sequence() <= v || strategy.sequence() <= v)) ok = false;
+                ++expected;
+            });
+            std::this_thread::yield();
+        }
+        return ok;
+    };
+    
+    bool book_ok = false, strategy_ok = false, recorder_ok = false;
+    std::thread t1([&]() { book_ok = run(book, false); });
+    std::thread t2([&]() { strategy_ok = run(strategy, false); });
+    std::thread t3([&]() { recorder_ok = run(recorder, true); });
+    
+    for (uint64_t i = 0; i < events; ++i) {
+        ring.publish(i);
+    }
+    t1.join();
+    t2.join();
+    t3.join();
+    
+    EXPECT_TRUE(book_ok);
+    EXPECT_TRUE(strategy_ok);
+    EXPECT_TRUE(recorder_ok);
+}
+
+TEST(LossyBroadcastRingTest, LappedConsumerReportsLoss) {
+    LossyBroadcastRing<uint64_t> ring(4);
+    auto& consumer = ring.add_consumer();
+    
+    for (uint64_t i = 0; i < 10; ++i) {
+        EXPECT_TRUE(ring.try_publish(i));
+    }
+    
+    std::vector<uint64_t> seen;
+    consumer.poll([&](const uint64_t& v) { seen.push_back(v); });
+    
+    // The slot being overwritten next is given up too, so three survive.
+    EXPECT_EQ(seen, (std::vector<uint64_t>{7, 8, 9}));
+    EXPECT_EQ(consumer.lost(), 7u);
+    EXPECT_EQ(consumer.backlog(), 0u);
+}
+
+TEST(LossyBroadcastRingTest, ProducerNeverBlocksAndReadsAreWhole) {
+    const uint64_t events = 200000;
+    LossyBroadcastRing<MarketEvent> ring(64);
+    auto& consumer = ring.add_consumer();
+    
+    std::atomic<bool> producing{true};
+    uint64_t received = 0;
+    bool ordered = true;
+    std::thread reader([&]() {
+        int64_t last = -1;
+        auto take = [&](const MarketEvent& e) {
+            if (static_cast<int64_t>(e.order_ref) <= last || e.quantity != static_cast<uint32_t>(e.order_ref)) {
+                ordered = false;
+            }
+            last = static_cast<int64_t>(e.order_ref);
+            ++received;
+        };
+        while (producing.load()) {
+            consumer.poll(take, 16);
+        }
+        consumer.poll(take);
+    });
+    
+    for (uint64_t i = 0; i < events; ++i) {
+        MarketEvent event{};
+        event.order_ref = i;
+        event.quantity = static_cast<uint32_t>(i);
+        ring.publish(event);
+    }
+    producing = false;
+    reader.join();
+    
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(received + consumer.lost(), events);
+}
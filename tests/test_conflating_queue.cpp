@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "conflating_queue.hpp"
+#include "order_book.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(ConflatingQueueTest, KeepsLatestValuePerKey) {
+    ConflatingQueue<uint64_t> queue(8);
+    
+    queue.publish(3, 10);
+    queue.publish(5, 20);
+    queue.publish(3, 11);
+    queue.publish(3, 12);
+    
+    EXPECT_EQ(queue.pending(), 2u);
+    EXPECT_EQ(queue.published(), 4u);
+    EXPECT_EQ(queue.conflated(), 2u);
+    
+    uint32_t key;
+    uint64_t value;
+    ASSERT_TRUE(queue.try_pop(key, value));
+    EXPECT_EQ(key, 3u);
+    EXPECT_EQ(value, 12u);
+    ASSERT_TRUE(queue.try_pop(key, value));
+    EXPECT_EQ(key, 5u);
+    EXPECT_EQ(value, 20u);
+    EXPECT_FALSE(queue.try_pop(key, value));
+}
+
+TEST(ConflatingQueueTest, RequeuesKeyAfterPop) {
+    ConflatingQueue<uint64_t> queue(4);
+    
+    queue.publish(1, 100);
+    uint32_t key;
+    uint64_t value;
+    ASSERT_TRUE(queue.try_pop(key, value));
+    
+    queue.publish(1, 101);
+    ASSERT_TRUE(queue.try_pop(key, value));
+    EXPECT_EQ(key, 1u);
+    EXPECT_EQ(value, 101u);
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.peek(1), 101u);
+}
+
+TEST(ConflatingQueueTest, BoundedByKeyCount) {
+    ConflatingQueue<TopOfBook> queue(5);
+    
+    for (int round = 0; round < 1000; ++round) {
+        for (uint32_t key = 0; key < 5; ++key) {
+            TopOfBook top;
+            top.bid_price = round;
+            top.timestamp = key;
+            queue.publish(key, top);
+        }
+    }
+    EXPECT_EQ(queue.pending(), 5u);
+    
+    size_t drained = queue.drain([](uint32_t key, const TopOfBook& top) {
+        EXPECT_EQ(top.bid_price, 999);
+        EXPECT_EQ(top.timestamp, key);
+    });
+    EXPECT_EQ(drained, 5u);
+}
+
+TEST(ConflatingQueueTest, SlowConsumerEndsOnLatestState) {
+    const uint32_t keys = 64;
+    const uint64_t rounds = 20000;
+    ConflatingQueue<TopOfBook> queue(keys);
+    
+    std::atomic<bool> producing{true};
+    std::vector<int64_t> last_seen(keys, -1);
+    bool ordered = true;
+    
+    std::thread consumer([&]() {
+        auto take = [&](uint32_t key, const TopOfBook& top) {
+            // Each key's values only move forward and the payload is never torn.
+            if (top.bid_price < last_seen[key] || top.ask_price != top.bid_price + 1) {
+                ordered = false;
+            }
+            last_seen[key] = top.bid_price;
+        };
+        while (producing.load()) {
+            queue.drain(take, 16);
+            std::this_thread::yield();
+        }
+        queue.drain(take);
+    });
+    
+    for (uint64_t round = 0; round < rounds; ++round) {
+        for (uint32_t key = 0; key < keys; ++key) {
+            TopOfBook top;
+            top.bid_price = static_cast<int64_t>(round);
+            top.ask_price = top.bid_price + 1;
+            queue.publish(key, top);
+        }
+    }
+    producing = false;
+    consumer.join();
+    
+    EXPECT_TRUE(ordered);
+    for (uint32_t key = 0; key < keys; ++key) {
+        EXPECT_EQ(last_seen[key], static_cast<int64_t>(rounds - 1));
+    }
+    EXPECT_GT(queue.conflated(), 0u);
+}
@@ -141,3 +141,224 @@ TEST_F(EnhancedOrderBookTest, StressTest) {
     
     EXPECT_LT(book.total_orders(), num_orders);
 }
+
+TEST_F(EnhancedOrderBookTest, QueuePositionFromMPID) {
+    book.watch_mpid("MINE");
+    
+    book.add_order(1, 'B', 1500000, 100, 1000);
+    book.add_order(2, 'B', 1500000, 200, 1001);
+    EXPECT_TRUE(book.add_attributed_order(3, 'B', 1500000, 50, 1002, "MINE"));
+    EXPECT_TRUE(book.add_attributed_order(4, 'B', 1500000, 70, 1003, "GSCO"));
+    
+    const QueuePosition* pos = book.queue_position(3);
+    ASSERT_NE(pos, nullptr);
+    EXPECT_EQ(pos->shares_ahead, 300);
+    EXPECT_EQ(pos->rank(), 2);
+    EXPECT_EQ(book.queue_position(4), nullptr);
+}
+
+TEST_F(EnhancedOrderBookTest, QueuePositionTracksExecutionsAndCancels) {
+    book.add_order(1, 'B', 1500000, 100, 1000);
+    book.add_order(2, 'B', 1500000, 200, 1001);
+    book.add_order(3, 'B', 1500000, 50, 1002);
+    book.add_order(4, 'B', 1500000, 80, 1003);
+    book.add_order(5, 'B', 1499900, 500, 1004);
+    
+    ASSERT_TRUE(book.watch_order(3));
+    EXPECT_EQ(book.queue_position(3)->shares_ahead, 300);
+    
+    book.execute_order(1, 40, 1005);
+    EXPECT_EQ(book.queue_position(3)->shares_ahead, 260);
+    EXPECT_EQ(book.queue_position(3)->rank(), 2);
+    
+    book.cancel_order(2, 200, 1006);
+    EXPECT_EQ(book.queue_position(3)->shares_ahead, 60);
+    EXPECT_EQ(book.queue_position(3)->rank(), 1);
+    
+    book.delete_order(4, 1007);
+    book.execute_order(5, 100, 1008);
+    EXPECT_EQ(book.queue_position(3)->shares_ahead, 60);
+    
+    book.execute_order(1, 60, 1009);
+    EXPECT_EQ(book.queue_position(3)->shares_ahead, 0);
+    EXPECT_EQ(book.queue_position(3)->rank(), 0);
+    
+    book.execute_order(3, 20, 1010);
+    EXPECT_EQ(book.queue_position(3)->quantity, 30);
+    
+    book.execute_order(3, 30, 1011);
+    EXPECT_EQ(book.queue_position(3), nullptr);
+    EXPECT_EQ(book.watched_orders(), 0);
+}
+
+TEST_F(EnhancedOrderBookTest, QueuePositionSizeIncreaseLosesPriority) {
+    book.add_order(1, 'S', 1500100, 100, 1000);
+    book.add_order(2, 'S', 1500100, 200, 1001);
+    book.add_order(3, 'S', 1500100, 300, 1002);
+    
+    ASSERT_TRUE(book.watch_order(2));
+    EXPECT_EQ(book.queue_position(2)->shares_ahead, 100);
+    
+    book.modify_order(1, 50, 1003);
+    EXPECT_EQ(book.queue_position(2)->shares_ahead, 50);
+    
+    book.modify_order(1, 500, 1004);
+    EXPECT_EQ(book.queue_position(2)->shares_ahead, 0);
+    
+    book.modify_order(2, 250, 1005);
+    EXPECT_EQ(book.queue_position(2)->shares_ahead, 800);
+    EXPECT_EQ(book.queue_position(2)->rank(), 2);
+}
+
+TEST_F(EnhancedOrderBookTest, QueuePositionTracksSeveralWatchedAtOneLevel) {
+    book.add_order(1, 'B', 1500000, 100, 1000);
+    book.add_order(2, 'B', 1500000, 200, 1001);
+    book.add_order(3, 'B', 1500000, 300, 1002);
+    ASSERT_TRUE(book.watch_order(2));
+    ASSERT_TRUE(book.watch_order(3));
+    
+    book.execute_order(2, 50, 1003);
+    EXPECT_EQ(book.queue_position(2)->quantity, 150);
+    EXPECT_EQ(book.queue_position(3)->shares_ahead, 250);
+    EXPECT_EQ(book.queue_position(3)->rank(), 2);
+    
+    book.cancel_order(2, 50, 1004);
+    EXPECT_EQ(book.queue_position(3)->shares_ahead, 200);
+    
+    // Upsizing the front order sends it behind the other one.
+    book.modify_order(2, 400, 1005);
+    EXPECT_EQ(book.queue_position(3)->shares_ahead, 100);
+    EXPECT_EQ(book.queue_position(3)->rank(), 1);
+    EXPECT_EQ(book.queue_position(2)->shares_ahead, 400);
+    EXPECT_EQ(book.queue_position(2)->rank(), 2);
+    
+    book.execute_order(3, 300, 1006);
+    EXPECT_EQ(book.queue_position(3), nullptr);
+    EXPECT_EQ(book.queue_position(2)->shares_ahead, 100);
+    EXPECT_EQ(book.queue_position(2)->rank(), 1);
+    
+    book.delete_order(1, 1007);
+    EXPECT_EQ(book.queue_position(2)->shares_ahead, 0);
+    EXPECT_EQ(book.queue_position(2)->rank(), 0);
+}
+
+TEST_F(EnhancedOrderBookTest, QueuePositionFollowsReplace) {
+    book.add_order(1, 'B', 1500000, 100, 1000);
+    book.add_order(2, 'B', 1500100, 100, 1001);
+    book.watch_order(1);
+    
+    EXPECT_TRUE(book.replace_order(1, 10, 100, 1500100, 1002));
+    EXPECT_EQ(book.queue_position(1), nullptr);
+    
+    const QueuePosition* pos = book.queue_position(10);
+    ASSERT_NE(pos, nullptr);
+    EXPECT_EQ(pos->price, 1500100);
+    EXPECT_EQ(pos->shares_ahead, 100);
+}
+
+TEST_F(EnhancedOrderBookTest, ChangeMask) {
+    BookUpdate update = book.add_order(1, 'B', 1500000, 100, 1000);
+    EXPECT_TRUE(update);
+    EXPECT_TRUE(update.top_changed());
+    
+    update = book.add_order(2, 'B', 1499900, 100, 1001);
+    EXPECT_EQ(update.changes, DEPTH_CHANGED);
+    
+    update = book.add_order(3, 'S', 1500100, 200, 1002);
+    EXPECT_EQ(update.changes, DEPTH_CHANGED | BBO_PRICE_CHANGED | BBO_SIZE_CHANGED);
+    
+    update = book.execute_order(1, 40, 1003);
+    EXPECT_EQ(update.changes, DEPTH_CHANGED | BBO_SIZE_CHANGED);
+    
+    update = book.cancel_order(2, 10, 1004);
+    EXPECT_FALSE(update.top_changed());
+    
+    update = book.delete_order(1, 1005);
+    EXPECT_EQ(update.changes, DEPTH_CHANGED | BBO_PRICE_CHANGED | BBO_SIZE_CHANGED);
+    EXPECT_EQ(book.top().bid_price, 1499900);
+    EXPECT_EQ(book.top().bid_size, 90);
+    
+    update = book.delete_order(99, 1006);
+    EXPECT_FALSE(update);
+    EXPECT_EQ(update.changes, BOOK_UNCHANGED);
+}
+
+TEST_F(EnhancedOrderBookTest, SnapshotTracksTop) {
+    book.add_order(1, 'B', 1500000, 100, 1000);
+    book.add_order(2, 'S', 1500100, 200, 1001);
+    
+    const auto& snap = book.snapshot();
+    EXPECT_EQ(snap.best_bid, 1500000);
+    EXPECT_EQ(snap.best_ask_size, 200);
+    
+    book.replace_order(1, 3, 50, 1500050, 1002);
+    EXPECT_EQ(book.snapshot().best_bid, 1500050);
+    EXPECT_EQ(book.snapshot().best_bid_size, 50);
+    EXPECT_EQ(book.snapshot().timestamp, 1002);
+}
+
+TEST_F(EnhancedOrderBookTest, DepthSpanRefillsFromBook) {
+    for (int i = 0; i < 15; ++i) {
+        book.add_order(i, 'B', 1500000 - i * 100, 100 + i, i);
+    }
+    
+    LevelSpan depth = book.bid_depth();
+    ASSERT_EQ(depth.size, EnhancedOrderBook::DEPTH_LEVELS);
+    EXPECT_EQ(depth[0].price, 1500000);
+    
+    book.delete_order(0, 100);
+    book.execute_order(3, 103, 101);
+    
+    depth = book.bid_depth();
+    ASSERT_EQ(depth.size, EnhancedOrderBook::DEPTH_LEVELS);
+    EXPECT_EQ(depth[0].price, 1499900);
+    EXPECT_EQ(depth[1].price, 1499800);
+    EXPECT_EQ(depth[2].price, 1499600);
+    EXPECT_EQ(depth[depth.size - 1].price, 1500000 - 11 * 100);
+    
+    book.add_order(100, 'B', 1500100, 10, 102);
+    depth = book.bid_depth();
+    EXPECT_EQ(depth[0].price, 1500100);
+    EXPECT_EQ(depth[depth.size - 1].price, 1500000 - 10 * 100);
+}
+
+TEST_F(EnhancedOrderBookTest, DepthSpanMatchesBook) {
+    uint64_t state = 12345;
+    auto next = [&state]() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state >> 33;
+    };
+    
+    std::vector<uint64_t> live;
+    for (uint64_t id = 1; id < 5000; ++id) {
+        if (!live.empty() && next() % 3 == 0) {
+            size_t pick = next() % live.size();
+            book.cancel_order(live[pick], 1 + next() % 200, id);
+            if (!book.find_order(live[pick])) {
+                live[pick] = live.back();
+                live.pop_back();
+            }
+        } else {
+            char side = next() % 2 ? 'B' : 'S';
+            int64_t price = 1500000 + (side == 'B' ? -1 : 1) * static_cast<int64_t>(next() % 40) * 100;
+            book.add_order(id, side, price, 1 + next() % 200, id);
+            live.push_back(id);
+        }
+        
+        auto bids = book.get_bid_depth(book.bid_levels());
+        auto asks = book.get_ask_depth(book.ask_levels());
+        LevelSpan bid_span = book.bid_depth();
+        LevelSpan ask_span = book.ask_depth();
+        
+        ASSERT_EQ(bid_span.size, std::min(bids.size(), EnhancedOrderBook::DEPTH_LEVELS));
+        ASSERT_EQ(ask_span.size, std::min(asks.size(), EnhancedOrderBook::DEPTH_LEVELS));
+        for (size_t i = 0; i < bid_span.size; ++i) {
+            ASSERT_EQ(bid_span[i].price, bids[i].price);
+            ASSERT_EQ(bid_span[i].size, bids[i].size);
+        }
+        for (size_t i = 0; i < ask_span.size; ++i) {
+            ASSERT_EQ(ask_span[i].price, asks[i].price);
+            ASSERT_EQ(ask_span[i].size, asks[i].size);
+        }
+    }
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include "itch_book_builder.hpp"
+#include <cstring>
+
+class ItchBookBuilderTest : public ::testing::Test {
+protected:
+    ItchBookBuilder builder;
+    
+    itch::StockDirectory directory(uint16_t locate, const char* stock) {
+        itch::StockDirectory msg{};
+        msg.type = 'R';
+        msg.stock_locate = locate;
+        std::memcpy(msg.stock, stock, 8);
+        return msg;
+    }
+    
+    itch::AddOrder add(uint16_t locate, uint64_t ref, char side, uint32_t shares, uint32_t price) {
+        itch::AddOrder msg{};
+        msg.type = 'A';
+        msg.stock_locate = locate;
+        msg.order_reference = ref;
+        msg.buy_sell = side;
+        msg.shares = shares;
+        msg.price = price;
+        return msg;
+    }
+};
+
+TEST_F(ItchBookBuilderTest, DirectoryCreatesBooks) {
+    builder.process(directory(7, "AAPL    "));
+    builder.process(directory(9, "MSFT    "));
+    
+    ASSERT_NE(builder.book(7), nullptr);
+    ASSERT_NE(builder.book(9), nullptr);
+    EXPECT_EQ(builder.book(7)->symbol().to_string(), "AAPL");
+    EXPECT_EQ(builder.book(9)->symbol().to_string(), "MSFT");
+    EXPECT_EQ(builder.book(8), nullptr);
+    EXPECT_EQ(builder.book_count(), 2);
+}
+
+TEST_F(ItchBookBuilderTest, RoutesByStockLocate) {
+    builder.process(directory(7, "AAPL    "));
+    builder.process(directory(9, "MSFT    "));
+    
+    builder.process(add(7, 1, 'B', 100, 1500000));
+    builder.process(add(9, 2, 'S', 200, 3000000));
+    
+    itch::OrderExecuted exec{};
+    exec.type = 'E';
+    exec.stock_locate = 7;
+    exec.order_reference = 1;
+    exec.executed_shares = 40;
+    EXPECT_TRUE(builder.process(exec));
+    
+    itch::OrderCancel cancel{};
+    cancel.type = 'X';
+    cancel.stock_locate = 9;
+    cancel.order_reference = 2;
+    cancel.cancelled_shares = 50;
+    EXPECT_TRUE(builder.process(cancel));
+    
+    EXPECT_EQ(*builder.book(7)->best_bid_size(), 60);
+    EXPECT_EQ(*builder.book(9)->best_ask_size(), 150);
+}
+
+TEST_F(ItchBookBuilderTest, ReplaceAcrossPriceKeepsSide) {
+    builder.process(directory(1, "AAPL    "));
+    builder.process(add(1, 10, 'S', 100, 1500100));
+    
+    itch::OrderReplace replace{};
+    replace.type = 'U';
+    replace.stock_locate = 1;
+    replace.original_order_reference = 10;
+    replace.new_order_reference = 11;
+    replace.shares = 300;
+    replace.price = 1500500;
+    EXPECT_TRUE(builder.process(replace));
+    
+    const EnhancedOrderBook* book = builder.book(1);
+    EXPECT_EQ(book->total_orders(), 1);
+    EXPECT_EQ(*book->best_ask(), 1500500);
+    EXPECT_EQ(*book->best_ask_size(), 300);
+    EXPECT_FALSE(book->best_bid().has_value());
+}
+
+TEST_F(ItchBookBuilderTest, ExecutionsReportPrices) {
+    std::vector<std::pair<int64_t, uint64_t>> prints;
+    builder.set_execution_callback([&prints](uint16_t, int64_t price, uint64_t shares, uint64_t) {
+        prints.emplace_back(price, shares);
+    });
+    
+    builder.process(directory(1, "AAPL    "));
+    builder.process(add(1, 10, 'B', 100, 1500000));
+    
+    itch::OrderExecuted exec{};
+    exec.type = 'E';
+    exec.stock_locate = 1;
+    exec.order_reference = 10;
+    exec.executed_shares = 30;
+    builder.process(exec);
+    
+    itch::OrderExecutedWithPrice exec_price{};
+    exec_price.type = 'C';
+    exec_price.stock_locate = 1;
+    exec_price.order_reference = 10;
+    exec_price.executed_shares = 70;
+    exec_price.printable = 'Y';
+    exec_price.execution_price = 1499900;
+    builder.process(exec_price);
+    
+    ASSERT_EQ(prints.size(), 2);
+    EXPECT_EQ(prints[0].first, 1500000);
+    EXPECT_EQ(prints[0].second, 30);
+    EXPECT_EQ(prints[1].first, 1499900);
+    EXPECT_EQ(prints[1].second, 70);
+    EXPECT_EQ(builder.book(1)->total_orders(), 0);
+}
+
+TEST_F(ItchBookBuilderTest, DeleteAndUnknownReferences) {
+    builder.process(directory(1, "AAPL    "));
+    builder.process(add(1, 10, 'B', 100, 1500000));
+    
+    itch::OrderDelete del{};
+    del.type = 'D';
+    del.stock_locate = 1;
+    del.order_reference = 10;
+    EXPECT_TRUE(builder.process(del));
+    EXPECT_FALSE(builder.process(del));
+    
+    del.stock_locate = 2;
+    EXPECT_FALSE(builder.process(del));
+    
+    EXPECT_EQ(builder.book(1)->total_orders(), 0);
+    EXPECT_EQ(builder.stats().unknown_order, 1);
+    EXPECT_EQ(builder.stats().unknown_locate, 1);
+}
+
+TEST_F(ItchBookBuilderTest, ProcessWireBuffer) {
+    itch::AddOrder msg = add(3, 42, 'B', 100, 1500000);
+    std::memcpy(msg.stock, "TSLA    ", 8);
+    msg.length = itch::swap_uint16(sizeof(itch::AddOrder));
+    msg.stock_locate = itch::swap_uint16(3);
+    msg.order_reference = itch::swap_uint64(42);
+    msg.shares = itch::swap_uint32(100);
+    msg.price = itch::swap_uint32(1500000);
+    
+    std::vector<uint8_t> buffer(sizeof(msg));
+    std::memcpy(buffer.data(), &msg, sizeof(msg));
+    
+    EXPECT_EQ(builder.process_buffer(buffer.data(), buffer.size()), 1);
+    ASSERT_NE(builder.book(3), nullptr);
+    EXPECT_EQ(builder.book(3)->symbol().to_string(), "TSLA");
+    EXPECT_EQ(*builder.book(3)->best_bid(), 1500000);
+}
+
+TEST_F(ItchBookBuilderTest, ReleaseAndAdoptBook) {
+    builder.process(directory(7, "AAPL    "));
+    builder.process(add(7, 1, 'B', 100, 1500000));
+    
+    auto book = builder.release_book(7);
+    ASSERT_NE(book, nullptr);
+    EXPECT_EQ(builder.book(7), nullptr);
+    EXPECT_EQ(builder.book_count(), 0);
+    EXPECT_EQ(builder.release_book(7), nullptr);
+    
+    ItchBookBuilder other;
+    other.adopt_book(7, std::move(book));
+    ASSERT_NE(other.book(7), nullptr);
+    EXPECT_EQ(other.book_count(), 1);
+    EXPECT_EQ(other.book(7)->total_orders(), 1);
+    
+    itch::OrderDelete del{};
+    del.type = 'D';
+    del.stock_locate = 7;
+    del.order_reference = 1;
+    EXPECT_TRUE(other.process(del));
+    EXPECT_EQ(other.book(7)->total_orders(), 0);
+}
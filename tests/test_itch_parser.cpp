@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "itch_parser.hpp"
+#include <cstring>
 
 class ITCHParserTest : public ::testing::Test {
 protected:
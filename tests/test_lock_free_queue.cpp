@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include "lock_free_queue.hpp"
+#include <algorithm>
+#include <memory>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -75,6 +78,139 @@ TEST(SPSCQueueTest, ConcurrentOperations) {
     EXPECT_TRUE(queue.empty());
 }
 
+TEST(SPSCQueueTest, BatchPushPopWrapsAround) {
+    SPSCQueue<int> queue(8);
+    int items[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    int out[10] = {};
+    
+    EXPECT_EQ(queue.try_push_n(items, 5), 5u);
+    EXPECT_EQ(queue.try_pop_n(out, 3), 3u);
+    // Seven usable slots, two still occupied.
+    EXPECT_EQ(queue.try_push_n(items + 5, 10), 5u);
+    EXPECT_EQ(queue.size(), 7u);
+    EXPECT_EQ(queue.try_push_n(items, 1), 0u);
+    
+    EXPECT_EQ(queue.try_pop_n(out, 10), 7u);
+    EXPECT_EQ(out[0], 3);
+    EXPECT_EQ(out[6], 9);
+    EXPECT_EQ(queue.try_pop_n(out, 10), 0u);
+}
+
+TEST(SPSCQueueTest, ClaimCommitPeekRelease) {
+    auto tracker = std::make_shared<int>(0);
+    {
+        SPSCQueue<std::shared_ptr<int>> queue(4);
+        
+        std::shared_ptr<int>* slot = queue.claim();
+        ASSERT_NE(slot, nullptr);
+        *slot = tracker;
+        EXPECT_EQ(queue.claim(), slot);
+        EXPECT_EQ(queue.peek(), nullptr);
+        queue.commit();
+        
+        std::shared_ptr<int>* front = queue.peek();
+        ASSERT_NE(front, nullptr);
+        EXPECT_EQ(front->get(), tracker.get());
+        EXPECT_EQ(tracker.use_count(), 2);
+        queue.release();
+        EXPECT_EQ(tracker.use_count(), 1);
+        EXPECT_TRUE(queue.empty());
+        
+        // Published and claimed-but-uncommitted slots are destroyed with the queue.
+        queue.try_push(tracker);
+        *queue.claim() = tracker;
+        EXPECT_EQ(tracker.use_count(), 3);
+    }
+    EXPECT_EQ(tracker.use_count(), 1);
+}
+
+TEST(SPSCQueueTest, ConcurrentBatchesInPlace) {
+    const size_t iterations = 100000;
+    SPSCQueue<std::string> queue(256);
+    
+    std::thread producer([&queue, iterations]() {
+        for (size_t i = 0; i < iterations; ++i) {
+            std::string* slot;
+            while (!(slot = queue.claim())) {
+                std::this_thread::yield();
+            }
+            *slot = std::to_string(i);
+            queue.commit();
+        }
+    });
+    
+    // Keep draining on a mismatch so the producer can finish and be joined.
+    size_t mismatches = 0;
+    std::vector<std::string> batch(32);
+    for (size_t received = 0; received < iterations;) {
+        size_t n = queue.try_pop_n(batch.data(), batch.size());
+        if (n == 0) {
+            if (std::string* front = queue.peek()) {
+                mismatches += *front != std::to_string(received);
+                queue.release();
+                ++received;
+            } else {
+                std::this_thread::yield();
+            }
+            continue;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            mismatches += batch[i] != std::to_string(received + i);
+        }
+        received += n;
+    }
+    
+    producer.join();
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(CompactSPSCQueueTest, DenseSlotsSameBehaviour) {
+    CompactSPSCQueue<uint64_t> compact(4096);
+    SPSCQueue<uint64_t> padded(4096);
+    EXPECT_EQ(compact.footprint(), 4096 * sizeof(uint64_t));
+    EXPECT_EQ(padded.footprint(), 4096 * 64u);
+    
+    CompactSPSCQueue<uint64_t> queue(4);
+    EXPECT_TRUE(queue.try_push(1));
+    EXPECT_TRUE(queue.try_push(2));
+    EXPECT_TRUE(queue.try_push(3));
+    EXPECT_FALSE(queue.try_push(4));
+    EXPECT_EQ(queue.try_pop().value(), 1u);
+    EXPECT_TRUE(queue.try_push(4));
+    
+    uint64_t out[4];
+    EXPECT_EQ(queue.try_pop_n(out, 4), 3u);
+    EXPECT_EQ(out[2], 4u);
+}
+
+TEST(CompactSPSCQueueTest, ConcurrentOperations) {
+    const size_t iterations = 100000;
+    CompactSPSCQueue<size_t> queue(64);
+    
+    std::thread producer([&queue, iterations]() {
+        for (size_t i = 0; i < iterations; ++i) {
+            while (!queue.try_push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    
+    size_t mismatches = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t* value;
+        while (!(value = queue.peek())) {
+            std::this_thread::yield();
+        }
+        mismatches += *value != i;
+        queue.release();
+    }
+    
+    producer.join();
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_TRUE(queue.empty());
+}
+
 TEST(MPSCQueueTest, BasicPushPop) {
     MPSCQueue<int> queue;
     
@@ -112,6 +248,114 @@ TEST(MPSCQueueTest, MultipleProducers) {
     EXPECT_EQ(received.size(), num_producers * items_per_producer);
 }
 
+TEST(BoundedMPSCQueueTest, BackpressureWhenFull) {
+    BoundedMPSCQueue<int> queue(4);
+    
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.try_push(i));
+    }
+    EXPECT_FALSE(queue.try_push(4));
+    EXPECT_EQ(queue.size(), 4u);
+    
+    EXPECT_EQ(queue.pop(), 0);
+    EXPECT_TRUE(queue.try_push(4));
+    
+    int out[8];
+    ASSERT_EQ(queue.try_pop_n(out, 8), 4u);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(out[i], i + 1);
+    }
+    EXPECT_FALSE(queue.try_pop().has_value());
+}
+
+TEST(BoundedMPSCQueueTest, SmallRingOfSmallItems) {
+    BoundedMPSCQueue<int> queue(2);
+    
+    EXPECT_TRUE(queue.try_push(1));
+    EXPECT_TRUE(queue.try_push(2));
+    EXPECT_FALSE(queue.try_push(3));
+    EXPECT_EQ(queue.pop(), 1);
+    EXPECT_EQ(queue.pop(), 2);
+}
+
+TEST(BoundedMPSCQueueTest, DestroysRemainingElements) {
+    auto tracked = std::make_shared<int>(7);
+    {
+        BoundedMPSCQueue<std::shared_ptr<int>> queue(8);
+        queue.push(tracked);
+        queue.push(tracked);
+        EXPECT_EQ(tracked.use_count(), 3);
+    }
+    EXPECT_EQ(tracked.use_count(), 1);
+}
+
+TEST(BoundedMPSCQueueTest, ProducersKeepTheirOrder) {
+    const size_t num_producers = 4;
+    const size_t items_per_producer = 20000;
+    BoundedMPSCQueue<size_t> queue(64);
+    
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&queue, p, items_per_producer]() {
+            for (size_t i = 0; i < items_per_producer; ++i) {
+                queue.push(p * items_per_producer + i);
+            }
+        });
+    }
+    
+    std::vector<size_t> next(num_producers, 0);
+    size_t out_of_order = 0;
+    for (size_t received = 0; received < num_producers * items_per_producer; ++received) {
+        size_t value = queue.pop();
+        size_t producer = value / items_per_producer;
+        out_of_order += value % items_per_producer != next[producer];
+        next[producer] = value % items_per_producer + 1;
+    }
+    
+    for (auto& t : producers) {
+        t.join();
+    }
+    EXPECT_EQ(out_of_order, 0u);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(BoundedMPMCQueueTest, ConsumersSeeEachItemOnce) {
+    const size_t num_threads = 3;
+    const size_t items_per_producer = 20000;
+    BoundedMPMCQueue<size_t> queue(128);
+    std::vector<std::vector<size_t>> seen(num_threads);
+    
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < num_threads; ++p) {
+        threads.emplace_back([&queue, p, items_per_producer]() {
+            for (size_t i = 0; i < items_per_producer; ++i) {
+                queue.push(p * items_per_producer + i);
+            }
+        });
+    }
+    for (size_t c = 0; c < num_threads; ++c) {
+        threads.emplace_back([&queue, &seen, c, items_per_producer]() {
+            for (size_t i = 0; i < items_per_producer; ++i) {
+                seen[c].push_back(queue.pop());
+            }
+        });
+    }
+    
+    for (auto& t : threads) {
+        t.join();
+    }
+    
+    std::vector<size_t> all;
+    for (const auto& values : seen) {
+        all.insert(all.end(), values.begin(), values.end());
+    }
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all.size(), num_threads * items_per_producer);
+    for (size_t i = 0; i < all.size(); ++i) {
+        ASSERT_EQ(all[i], i);
+    }
+}
+
 TEST(SPSCQueueTest, MoveSemantics) {
     struct MoveOnly {
         int value;
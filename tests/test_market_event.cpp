@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include "market_event.hpp"
+#include "itch_book_builder.hpp"
+#include "lock_free_queue.hpp"
+#include <cstring>
+#include <vector>
+
+class MarketEventTest : public ::testing::Test {
+protected:
+    static std::vector<itch::Message> make_stream() {
+        std::vector<itch::Message> stream;
+        
+        itch::StockDirectory dir{};
+        dir.stock_locate = 7;
+        dir.timestamp = 1;
+        std::memcpy(dir.stock, "MSFT    ", 8);
+        stream.push_back(dir);
+        
+        for (uint64_t ref = 1; ref <= 20; ++ref) {
+            itch::AddOrder add{};
+            add.stock_locate = 7;
+            add.timestamp = 10 + ref;
+            add.order_reference = ref;
+            add.buy_sell = ref % 2 ? 'B' : 'S';
+            add.shares = static_cast<uint32_t>(100 * ref);
+            add.price = static_cast<uint32_t>(ref % 2 ? 3000000 - ref * 100 : 3001000 + ref * 100);
+            std::memcpy(add.stock, "MSFT    ", 8);
+            stream.push_back(add);
+        }
+        
+        itch::AddOrderMPID mpid{};
+        mpid.stock_locate = 7;
+        mpid.order_reference = 21;
+        mpid.buy_sell = 'B';
+        mpid.shares = 500;
+        mpid.price = 3000000;
+        std::memcpy(mpid.stock, "MSFT    ", 8);
+        std::memcpy(mpid.attribution, "GSCO", 4);
+        stream.push_back(mpid);
+        
+        itch::OrderExecuted exec{};
+        exec.stock_locate = 7;
+        exec.order_reference = 1;
+        exec.executed_shares = 40;
+        stream.push_back(exec);
+        
+        itch::OrderExecutedWithPrice priced{};
+        priced.stock_locate = 7;
+        priced.order_reference = 3;
+        priced.executed_shares = 300;
+        priced.printable = 'Y';
+        priced.execution_price = 2999750;
+        stream.push_back(priced);
+        
+        itch::OrderCancel cancel{};
+        cancel.stock_locate = 7;
+        cancel.order_reference = 2;
+        cancel.cancelled_shares = 50;
+        stream.push_back(cancel);
+        
+        itch::OrderDelete del{};
+        del.stock_locate = 7;
+        del.order_reference = 4;
+        stream.push_back(del);
+        
+        itch::OrderReplace replace{};
+        replace.stock_locate = 7;
+        replace.original_order_reference = 5;
+        replace.new_order_reference = 99;
+        replace.shares = 700;
+        replace.price = 3000100;
+        stream.push_back(replace);
+        return stream;
+    }
+};
+
+TEST_F(MarketEventTest, FillsOneCacheLine) {
+    EXPECT_EQ(sizeof(MarketEvent), 64u);
+    EXPECT_EQ(alignof(MarketEvent), 64u);
+}
+
+TEST_F(MarketEventTest, ItchEventsInheritDirectorySymbol) {
+    auto stream = make_stream();
+    ItchEventAdapter adapter;
+    MarketEvent event;
+    
+    for (const auto& msg : stream) {
+        ASSERT_TRUE(adapter.normalize(msg, 42, event));
+    }
+    
+    // The last message is the replace, which names no stock.
+    EXPECT_EQ(event.type, EventType::OrderReplace);
+    EXPECT_EQ(event.symbol, SymbolId::from_cstr("MSFT"));
+    EXPECT_EQ(event.stock_locate, 7);
+    EXPECT_EQ(event.order_ref, 5u);
+    EXPECT_EQ(event.new_order_ref, 99u);
+    EXPECT_EQ(event.price, 3000100);
+    EXPECT_EQ(event.quantity, 700u);
+    EXPECT_EQ(event.venue, VENUE_NASDAQ);
+    EXPECT_EQ(event.receive_timestamp, 42u);
+    
+    ASSERT_TRUE(adapter.normalize(stream[21], 0, event));
+    EXPECT_TRUE(event.flags & EVENT_ATTRIBUTED);
+    EXPECT_EQ(std::memcmp(event.attribution, "GSCO", 4), 0);
+}
+
+TEST_F(MarketEventTest, BookFromEventsMatchesBookFromMessages) {
+    auto stream = make_stream();
+    
+    ItchBookBuilder direct;
+    ItchBookBuilder normalized;
+    ItchEventAdapter adapter;
+    
+    std::vector<int64_t> direct_prints;
+    std::vector<int64_t> normalized_prints;
+    direct.set_execution_callback([&](uint16_t, int64_t price, uint64_t, uint64_t) {
+        direct_prints.push_back(price);
+    });
+    normalized.set_execution_callback([&](uint16_t, int64_t price, uint64_t, uint64_t) {
+        normalized_prints.push_back(price);
+    });
+    
+    MarketEvent event;
+    for (const auto& msg : stream) {
+        direct.process(msg);
+        ASSERT_TRUE(adapter.normalize(msg, 0, event));
+        normalized.process(event);
+    }
+    
+    const EnhancedOrderBook* expected = direct.book(7);
+    const EnhancedOrderBook* actual = normalized.book(7);
+    ASSERT_NE(actual, nullptr);
+    EXPECT_EQ(actual->symbol(), SymbolId::from_cstr("MSFT"));
+    EXPECT_EQ(actual->total_orders(), expected->total_orders());
+    EXPECT_EQ(actual->top().bid_price, expected->top().bid_price);
+    EXPECT_EQ(actual->top().bid_size, expected->top().bid_size);
+    EXPECT_EQ(actual->top().ask_price, expected->top().ask_price);
+    EXPECT_EQ(actual->top().ask_size, expected->top().ask_size);
+    EXPECT_EQ(actual->bid_levels(), expected->bid_levels());
+    EXPECT_EQ(normalized_prints, direct_prints);
+    EXPECT_EQ(normalized.stats().unknown_order, 0u);
+}
+
+TEST_F(MarketEventTest, IexAdapterPublishesIntoRing) {
+    std::vector<uint8_t> buffer;
+    for (int i = 0; i < 10; ++i) {
+        iex::QuoteUpdate quote{};
+        quote.header.type = static_cast<uint8_t>(iex::MessageType::QuoteUpdate);
+        quote.header.timestamp = 1000 + i;
+        std::memcpy(quote.symbol, "AAPL    ", 8);
+        quote.bid_size = 100;
+        quote.bid_price = 1500000 + i;
+        quote.ask_size = 200;
+        quote.ask_price = 1500100 + i;
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&quote);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(quote));
+    }
+    // A truncated trailing message stops the adapter instead of spinning on it.
+    buffer.resize(buffer.size() - 5);
+    
+    SPSCQueue<MarketEvent> ring(16);
+    iex::Parser parser(buffer.data(), buffer.size());
+    IexEventAdapter adapter;
+    EXPECT_EQ(adapter.publish(parser, ring, 77), 9u);
+    
+    auto event = ring.try_pop();
+    ASSERT_TRUE(event.has_value());
+    EXPECT_EQ(event->type, EventType::Quote);
+    EXPECT_EQ(event->venue, VENUE_IEX);
+    EXPECT_EQ(event->symbol, SymbolId::from_cstr("AAPL"));
+    EXPECT_EQ(event->price, 1500000);
+    EXPECT_EQ(event->quantity, 100u);
+    EXPECT_EQ(event->ask_price, 1500100);
+    EXPECT_EQ(event->ask_quantity, 200u);
+    EXPECT_EQ(event->exchange_timestamp, 1000u);
+    EXPECT_EQ(event->receive_timestamp, 77u);
+    EXPECT_EQ(ring.size(), 8u);
+}
@@ -1,5 +1,12 @@
 #include <gtest/gtest.h>
 #include "memory_pool.hpp"
+#include "lock_free_queue.hpp"
+#include "market_event.hpp"
+#include "pool_allocator.hpp"
+#include "enhanced_order_book.hpp"
+#include <map>
+#include <thread>
+#include <unordered_map>
 
 TEST(MemoryPoolTest, BasicAllocation) {
     MemoryPool<int> pool;
@@ -91,3 +98,130 @@ TEST(MemoryPoolTest, NullptrDeallocate) {
     
     EXPECT_EQ(pool.allocated(), 0);
 }
+
+TEST(PoolAllocatorTest, MapNodesComeFromRebindPool) {
+    PoolResource resource;
+    using Allocator = PoolAllocator<std::pair<const int64_t, PriceLevel>>;
+    std::map<int64_t, PriceLevel, std::less<int64_t>, Allocator> levels{Allocator(&resource)};
+    
+    EXPECT_EQ(resource.pool_count(), 0u);
+    for (int64_t price = 0; price < 1000; ++price) {
+        levels[price].size = 100;
+    }
+    
+    // Only the rebound node type gets a pool, never the value_type.
+    EXPECT_EQ(resource.pool_count(), 1u);
+    EXPECT_EQ(resource.allocated(), 1000u);
+    
+    levels.erase(levels.begin(), levels.find(500));
+    EXPECT_EQ(resource.allocated(), 500u);
+    levels.clear();
+    EXPECT_EQ(resource.allocated(), 0u);
+}
+
+TEST(PoolAllocatorTest, HashNodesPooledBucketsNot) {
+    PoolResource resource;
+    using Allocator = PoolAllocator<std::pair<const uint64_t, Order>>;
+    std::unordered_map<uint64_t, Order, std::hash<uint64_t>, std::equal_to<uint64_t>, Allocator> orders{Allocator(&resource)};
+    
+    for (uint64_t id = 0; id < 5000; ++id) {
+        orders.emplace(id, Order());
+    }
+    EXPECT_EQ(resource.allocated(), 5000u);
+    
+    for (uint64_t id = 0; id < 5000; id += 2) {
+        orders.erase(id);
+    }
+    EXPECT_EQ(resource.allocated(), 2500u);
+}
+
+TEST(PoolAllocatorTest, EqualityFollowsResource) {
+    PoolResource first;
+    PoolResource second;
+    PoolAllocator<int> a(&first);
+    PoolAllocator<double> b(a);
+    PoolAllocator<int> c(&second);
+    
+    EXPECT_TRUE(a == b);
+    EXPECT_TRUE(a != c);
+    EXPECT_EQ(b.resource(), &first);
+    
+    // Without a resource the allocator falls back to operator new.
+    PoolAllocator<int> plain(nullptr);
+    int* value = plain.allocate(1);
+    plain.deallocate(value, 1);
+    EXPECT_EQ(first.pool_count(), 0u);
+}
+
+TEST(ConcurrentMemoryPoolTest, OwnerFreesStayLocal) {
+    ConcurrentMemoryPool<int> pool;
+    
+    int* first = pool.allocate(1);
+    pool.deallocate(first);
+    int* second = pool.allocate(2);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(pool.allocated(), 1u);
+    
+    pool.deallocate_remote(second);
+    EXPECT_EQ(pool.allocated(), 0u);
+}
+
+TEST(ConcurrentMemoryPoolTest, MagazineBatchesRemoteFrees) {
+    ConcurrentMemoryPool<int, 16> pool;
+    std::vector<int*> ptrs;
+    for (int i = 0; i < 16; ++i) {
+        ptrs.push_back(pool.allocate(i));
+    }
+    
+    {
+        ConcurrentMemoryPool<int, 16>::Magazine magazine(pool, 8);
+        for (int i = 0; i < 12; ++i) {
+            magazine.deallocate(ptrs[i]);
+        }
+        EXPECT_EQ(magazine.size(), 4u);
+        EXPECT_EQ(pool.allocated(), 8u);
+    }
+    EXPECT_EQ(pool.allocated(), 4u);
+    
+    // The owner drains the remote list before growing.
+    for (int i = 0; i < 12; ++i) {
+        pool.allocate(i);
+    }
+    EXPECT_EQ(pool.chunk_count(), 1u);
+    EXPECT_EQ(pool.allocated(), 16u);
+}
+
+TEST(ConcurrentMemoryPoolTest, EventsCrossQueueByPointer) {
+    ConcurrentMemoryPool<MarketEvent, 256> pool;
+    SPSCQueue<MarketEvent*> queue(64);
+    const uint64_t count = 100000;
+    uint64_t checksum = 0;
+    
+    std::thread consumer([&]() {
+        ConcurrentMemoryPool<MarketEvent, 256>::Magazine magazine(pool, 32);
+        for (uint64_t received = 0; received < count;) {
+            auto event = queue.try_pop();
+            if (!event) {
+                std::this_thread::yield();
+                continue;
+            }
+            checksum += (*event)->order_ref;
+            magazine.deallocate(*event);
+            ++received;
+        }
+    });
+    
+    for (uint64_t i = 0; i < count; ++i) {
+        MarketEvent* event = pool.allocate();
+        event->order_ref = i;
+        while (!queue.try_push(event)) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+    
+    EXPECT_EQ(checksum, count * (count - 1) / 2);
+    EXPECT_EQ(pool.allocated(), 0u);
+    // Recycled slots keep the footprint at queue depth plus magazine size.
+    EXPECT_LE(pool.chunk_count(), 2u);
+}
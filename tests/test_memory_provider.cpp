@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "memory_provider.hpp"
+#include "memory_pool.hpp"
+#include "lock_free_queue.hpp"
+#include "pool_allocator.hpp"
+#include "order_book.hpp"
+#include "itch_book_builder.hpp"
+#include "thread_affinity.hpp"
+#include <cstdint>
+#include <cstring>
+#include <map>
+
+TEST(MemoryProviderTest, CarvesAlignedBlocksFromRegions) {
+    MemoryProvider::Config config;
+    config.region_size = MemoryProvider::HUGE_PAGE_SIZE;
+    MemoryProvider provider(config);
+    
+    void* first = provider.allocate(100);
+    void* second = provider.allocate(10, 256);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % 64, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % 256, 0u);
+    EXPECT_GE(static_cast<uint8_t*>(second) - static_cast<uint8_t*>(first), 100);
+    EXPECT_EQ(provider.allocate(8, 48), nullptr);
+    
+    // Oversized requests get a dedicated mapping.
+    void* big = provider.allocate(3 * MemoryProvider::HUGE_PAGE_SIZE);
+    ASSERT_NE(big, nullptr);
+    
+    auto stats = provider.stats();
+    EXPECT_EQ(stats.regions, 2u);
+    EXPECT_EQ(stats.mapped_bytes, 4 * MemoryProvider::HUGE_PAGE_SIZE);
+    EXPECT_EQ(stats.used_bytes, 110 + 3 * MemoryProvider::HUGE_PAGE_SIZE);
+    EXPECT_EQ(stats.locked_bytes, 0u);
+}
+
+TEST(MemoryProviderTest, BacksPoolsQueuesAndContainers) {
+    MemoryProvider::Config config;
+    config.numa_node = MemoryProvider::node_of_cpu(0);
+    MemoryProvider provider(config);
+    
+    {
+        MemoryPool<uint64_t, 1024> pool(&provider);
+        std::vector<uint64_t*> values;
+        for (uint64_t i = 0; i < 5000; ++i) {
+            values.push_back(pool.allocate(i));
+        }
+        EXPECT_EQ(*values[4321], 4321u);
+        for (auto* value : values) {
+            pool.deallocate(value);
+        }
+        
+        SPSCQueue<uint64_t> queue(1024, &provider);
+        EXPECT_TRUE(queue.try_push(7));
+        EXPECT_EQ(queue.try_pop().value(), 7u);
+        
+        PoolResource resource(&provider);
+        std::map<int, int, std::less<int>, PoolAllocator<std::pair<const int, int>>> levels{
+            PoolAllocator<std::pair<const int, int>>(&resource)};
+        for (int i = 0; i < 100; ++i) {
+            levels[i] = i;
+        }
+        EXPECT_EQ(resource.allocated(), 100u);
+    }
+    
+    auto stats = provider.stats();
+    EXPECT_EQ(stats.regions, 1u);
+    EXPECT_GT(stats.used_bytes, 5000 * sizeof(uint64_t));
+}
+
+TEST(MemoryProviderTest, BacksBookNodes) {
+    MemoryProvider provider;
+    
+    OrderBook book("AAPL", &provider);
+    size_t before = provider.stats().used_bytes;
+    for (int64_t i = 0; i < 100; ++i) {
+        book.add_bid(1000000 - i, 100, 0);
+    }
+    EXPECT_GT(provider.stats().used_bytes, before);
+    
+    ItchBookBuilder builder(&provider);
+    itch::StockDirectory directory{};
+    directory.type = 'R';
+    directory.stock_locate = 1;
+    std::memcpy(directory.stock, "MSFT    ", 8);
+    builder.process(directory);
+    
+    before = provider.stats().used_bytes;
+    for (uint64_t ref = 1; ref <= 100; ++ref) {
+        itch::AddOrder add{};
+        add.type = 'A';
+        add.stock_locate = 1;
+        add.order_reference = ref;
+        add.buy_sell = 'S';
+        add.shares = 100;
+        add.price = static_cast<uint32_t>(2000000 + ref);
+        builder.process(add);
+    }
+    ASSERT_EQ(builder.book(1)->total_orders(), 100);
+    EXPECT_GT(provider.stats().used_bytes, before);
+}
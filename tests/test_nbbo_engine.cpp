@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include "nbbo_engine.hpp"
+#include <cstring>
+
+class NbboEngineTest : public ::testing::Test {
+protected:
+    static VenueQuote quote(int64_t bid, uint64_t bid_size, int64_t ask, uint64_t ask_size, uint64_t ts = 0) {
+        VenueQuote q;
+        q.bid_price = bid;
+        q.bid_size = bid_size;
+        q.ask_price = ask;
+        q.ask_size = ask_size;
+        q.timestamp = ts;
+        return q;
+    }
+};
+
+TEST_F(NbboEngineTest, AttributesBestVenue) {
+    NbboEngine engine;
+    uint32_t aapl = engine.symbol_index(SymbolId::from_cstr("AAPL"));
+    EXPECT_EQ(engine.symbol_index(SymbolId::from_cstr("AAPL")), aapl);
+    
+    EXPECT_EQ(engine.update(0, aapl, quote(1500000, 100, 1500500, 200, 10)),
+              BBO_PRICE_CHANGED | BBO_SIZE_CHANGED);
+    engine.update(1, aapl, quote(1500100, 300, 1500600, 100, 20));
+    
+    const Nbbo& nbbo = engine.nbbo(aapl);
+    EXPECT_EQ(nbbo.bid_price, 1500100);
+    EXPECT_EQ(nbbo.bid_size, 300u);
+    EXPECT_EQ(nbbo.bid_venues, 1u << 1);
+    EXPECT_EQ(nbbo.ask_price, 1500500);
+    EXPECT_EQ(nbbo.ask_venues, 1u << 0);
+    EXPECT_EQ(nbbo.venue, 1);
+    EXPECT_EQ(nbbo.source_timestamp, 20u);
+    
+    // Venue 2 quotes behind the best on both sides.
+    EXPECT_EQ(engine.update(2, aapl, quote(1499900, 500, 1500700, 500, 30)), BOOK_UNCHANGED);
+    EXPECT_EQ(engine.stats().updates, 3u);
+    EXPECT_EQ(engine.stats().nbbo_changes, 2u);
+    EXPECT_EQ(engine.stats().rescans, 0u);
+}
+
+TEST_F(NbboEngineTest, AggregatesSizeAtSamePrice) {
+    NbboEngine engine;
+    uint32_t index = engine.symbol_index(SymbolId::from_cstr("MSFT"));
+    
+    engine.update(0, index, quote(1000000, 100, 1000100, 100));
+    EXPECT_EQ(engine.update(3, index, quote(1000000, 250, 1000100, 50)), BBO_SIZE_CHANGED);
+    EXPECT_EQ(engine.nbbo(index).bid_size, 350u);
+    EXPECT_EQ(engine.nbbo(index).ask_size, 150u);
+    EXPECT_EQ(engine.nbbo(index).bid_venues, (1u << 0) | (1u << 3));
+    
+    // A size change at a venue already at the best replaces its contribution.
+    engine.update(3, index, quote(1000000, 200, 1000100, 50));
+    EXPECT_EQ(engine.nbbo(index).bid_size, 300u);
+    
+    // Leaving the price while another venue remains needs no rescan.
+    engine.update(0, index, quote(999900, 100, 1000100, 100));
+    EXPECT_EQ(engine.nbbo(index).bid_price, 1000000);
+    EXPECT_EQ(engine.nbbo(index).bid_size, 200u);
+    EXPECT_EQ(engine.nbbo(index).bid_venues, 1u << 3);
+    EXPECT_EQ(engine.stats().rescans, 0u);
+}
+
+TEST_F(NbboEngineTest, RescansWhenLastBestVenueLeaves) {
+    NbboEngine engine;
+    uint32_t index = engine.symbol_index(SymbolId::from_cstr("SPY"));
+    
+    engine.update(0, index, quote(4500000, 100, 4500200, 100));
+    engine.update(1, index, quote(4499900, 200, 4500300, 300));
+    engine.update(2, index, quote(4499900, 50, 4500300, 100));
+    
+    size_t callbacks = 0;
+    Nbbo last;
+    engine.set_nbbo_callback([&](uint32_t i, SymbolId symbol, const Nbbo& nbbo) {
+        EXPECT_EQ(i, index);
+        EXPECT_EQ(symbol, SymbolId::from_cstr("SPY"));
+        last = nbbo;
+        callbacks++;
+    });
+    
+    engine.clear_venue(0, index, 99);
+    EXPECT_EQ(callbacks, 1u);
+    EXPECT_EQ(last.bid_price, 4499900);
+    EXPECT_EQ(last.bid_size, 250u);
+    EXPECT_EQ(last.bid_venues, (1u << 1) | (1u << 2));
+    EXPECT_EQ(last.ask_price, 4500300);
+    EXPECT_EQ(last.ask_size, 400u);
+    EXPECT_EQ(last.venue, 0);
+    EXPECT_EQ(last.source_timestamp, 99u);
+    EXPECT_EQ(engine.stats().rescans, 2u);
+    
+    engine.clear_venue(1, index, 100);
+    engine.clear_venue(2, index, 101);
+    EXPECT_EQ(engine.nbbo(index).bid_size, 0u);
+    EXPECT_EQ(engine.nbbo(index).ask_venues, 0u);
+}
+
+TEST_F(NbboEngineTest, MergesIexAndItchQuotes) {
+    NbboEngine engine;
+    const uint8_t NASDAQ = 0;
+    const uint8_t IEX = 1;
+    
+    uint32_t index = engine.symbol_index(SymbolId::from_cstr("AAPL"));
+    TopOfBook top;
+    top.bid_price = 1500000;
+    top.bid_size = 100;
+    top.ask_price = 1500300;
+    top.ask_size = 100;
+    top.timestamp = 5;
+    engine.update(NASDAQ, index, top);
+    
+    iex::QuoteUpdate msg{};
+    msg.header.timestamp = 6;
+    std::memcpy(msg.symbol, "AAPL\0\0\0\0", 8);
+    msg.bid_price = 1500000;
+    msg.bid_size = 200;
+    msg.ask_price = 1500200;
+    msg.ask_size = 300;
+    
+    EXPECT_EQ(engine.on_quote(IEX, msg), BBO_PRICE_CHANGED | BBO_SIZE_CHANGED);
+    EXPECT_EQ(engine.symbol_count(), 1u);
+    
+    const Nbbo& nbbo = engine.nbbo(index);
+    EXPECT_EQ(nbbo.bid_size, 300u);
+    EXPECT_EQ(nbbo.ask_price, 1500200);
+    EXPECT_EQ(nbbo.ask_venues, 1u << IEX);
+    EXPECT_EQ(nbbo.source_timestamp, 6u);
+    EXPECT_FALSE(nbbo.crossed());
+    EXPECT_EQ(engine.venue_quote(IEX, index).ask_size, 300u);
+}
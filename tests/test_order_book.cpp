@@ -81,7 +81,7 @@ TEST_F(OrderBookTest, Snapshot) {
     
     auto snap = book.snapshot();
     
-    EXPECT_EQ(snap.symbol, "AAPL");
+    EXPECT_EQ(snap.symbol.to_string(), "AAPL");
     EXPECT_EQ(snap.best_bid, 1500000);
     EXPECT_EQ(snap.best_ask, 1500100);
     EXPECT_EQ(snap.best_bid_size, 100);
@@ -95,3 +95,29 @@ TEST_F(OrderBookTest, EmptyBook) {
     EXPECT_DOUBLE_EQ(book.spread(), 0.0);
     EXPECT_DOUBLE_EQ(book.imbalance(), 0.0);
 }
+
+TEST_F(OrderBookTest, ChangeMask) {
+    EXPECT_EQ(book.add_bid(1500000, 100, 1000), DEPTH_CHANGED | BBO_PRICE_CHANGED | BBO_SIZE_CHANGED);
+    EXPECT_EQ(book.add_bid(1499900, 100, 1001), DEPTH_CHANGED);
+    EXPECT_EQ(book.add_bid(1500000, 50, 1002), DEPTH_CHANGED | BBO_SIZE_CHANGED);
+    EXPECT_EQ(book.remove_bid(1499800, 1003), BOOK_UNCHANGED);
+    EXPECT_EQ(book.remove_bid(1500000, 1004), DEPTH_CHANGED | BBO_PRICE_CHANGED | BBO_SIZE_CHANGED);
+    
+    EXPECT_EQ(book.top().bid_price, 1499900);
+    EXPECT_EQ(book.top().bid_size, 100);
+    EXPECT_EQ(book.top().timestamp, 1004);
+}
+
+TEST_F(OrderBookTest, SnapshotCachedUntilChange) {
+    book.add_bid(1500000, 100, 1000);
+    book.add_ask(1500100, 200, 1001);
+    
+    const OrderBookSnapshot* first = &book.snapshot();
+    EXPECT_EQ(first, &book.snapshot());
+    
+    book.add_bid(1499900, 300, 1002);
+    const auto& snap = book.snapshot();
+    EXPECT_EQ(snap.timestamp, 1002);
+    EXPECT_EQ(snap.bid_levels, 2);
+    EXPECT_EQ(snap.best_bid_size, 100);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "seqlock.hpp"
+#include "enhanced_order_book.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+struct Quad {
+    uint64_t a;
+    uint64_t b;
+    uint64_t c;
+    uint64_t d;
+};
+
+TEST(SeqlockTest, StoreAndLoad) {
+    Seqlock<Quad> slot;
+    EXPECT_EQ(slot.version(), 0);
+    
+    slot.store(Quad{1, 2, 3, 4});
+    EXPECT_EQ(slot.version(), 1);
+    
+    Quad value;
+    ASSERT_TRUE(slot.try_load(value));
+    EXPECT_EQ(value.a, 1);
+    EXPECT_EQ(value.d, 4);
+    
+    uint64_t retries = 0;
+    EXPECT_EQ(slot.load(&retries).c, 3);
+    EXPECT_EQ(retries, 0);
+}
+
+TEST(SeqlockTest, ConcurrentReadersSeeWholeWrites) {
+    Seqlock<Quad> slot(Quad{0, 0, 0, 0});
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> torn{0};
+    
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&]() {
+            while (!done.load(std::memory_order_relaxed)) {
+                Quad q = slot.load();
+                if (q.a != q.b || q.b != q.c || q.c != q.d) {
+                    torn++;
+                }
+            }
+        });
+    }
+    
+    for (uint64_t i = 1; i <= 200000; ++i) {
+        slot.store(Quad{i, i, i, i});
+    }
+    done = true;
+    
+    for (auto& t : readers) {
+        t.join();
+    }
+    
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(slot.load().a, 200000);
+}
+
+TEST(SeqlockTest, BookPublishesTopOnChange) {
+    EnhancedOrderBook book("AAPL");
+    book.add_order(1, 'B', 1500000, 100, 1000);
+    book.add_order(2, 'S', 1500100, 200, 1001);
+    uint64_t version = book.published_top().version();
+    
+    book.add_order(3, 'B', 1499900, 100, 1002);
+    EXPECT_EQ(book.published_top().version(), version);
+    
+    book.execute_order(1, 40, 1003);
+    TopOfBook top = book.published_top().load();
+    EXPECT_EQ(top.bid_price, 1500000);
+    EXPECT_EQ(top.bid_size, 60);
+    EXPECT_EQ(top.ask_price, 1500100);
+    EXPECT_EQ(top.timestamp, 1003);
+}
+
+TEST(SeqlockTest, ReplacePublishesOnce) {
+    EnhancedOrderBook book("AAPL");
+    book.enable_depth_publishing();
+    book.add_order(1, 'B', 1500000, 100, 1000);
+    book.add_order(2, 'S', 1500200, 200, 1001);
+    uint64_t top_version = book.published_top().version();
+    uint64_t depth_version = book.published_depth()->version();
+    uint64_t messages = book.counters().message_count;
+    
+    EXPECT_TRUE(book.replace_order(1, 3, 150, 1500100, 1002));
+    
+    // One message, one publication: never an empty bid between the halves.
+    EXPECT_EQ(book.published_top().version(), top_version + 1);
+    EXPECT_EQ(book.published_depth()->version(), depth_version + 1);
+    EXPECT_EQ(book.counters().message_count, messages + 1);
+    
+    TopOfBook top = book.published_top().load();
+    EXPECT_EQ(top.bid_price, 1500100);
+    EXPECT_EQ(top.bid_size, 150);
+    EXPECT_EQ(top.timestamp, 1002);
+}
+
+TEST(SeqlockTest, BookPublishesDepthWhenEnabled) {
+    EnhancedOrderBook book("AAPL");
+    EXPECT_EQ(book.published_depth(), nullptr);
+    
+    book.add_order(1, 'B', 1500000, 100, 1000);
+    book.enable_depth_publishing();
+    book.add_order(2, 'B', 1499900, 200, 1001);
+    book.add_order(3, 'S', 1500100, 300, 1002);
+    
+    ASSERT_NE(book.published_depth(), nullptr);
+    auto depth = book.published_depth()->load();
+    EXPECT_EQ(depth.bid_count, 2);
+    EXPECT_EQ(depth.ask_count, 1);
+    EXPECT_EQ(depth.bids[1].price, 1499900);
+    EXPECT_EQ(depth.asks[0].size, 300);
+    EXPECT_EQ(depth.timestamp, 1002);
+}
@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+#include "sharded_book_engine.hpp"
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+class ShardedBookEngineTest : public ::testing::Test {
+protected:
+    static std::vector<itch::Message> make_stream(uint16_t locates, size_t rounds,
+                                                  uint16_t hot_locates = 0, size_t hot_weight = 1) {
+        std::vector<itch::Message> stream;
+        const char* names[] = {"AAPL    ", "MSFT    ", "GOOG    ", "AMZN    ", "TSLA    ", "META    "};
+        
+        for (uint16_t locate = 1; locate <= locates; ++locate) {
+            itch::StockDirectory dir{};
+            dir.type = 'R';
+            dir.stock_locate = locate;
+            std::memcpy(dir.stock, names[(locate - 1) % 6], 8);
+            stream.push_back(dir);
+        }
+        
+        uint64_t ref = 1;
+        for (size_t round = 0; round < rounds; ++round) {
+            for (uint16_t locate = 1; locate <= locates; ++locate) {
+                size_t weight = locate <= hot_locates ? hot_weight : 1;
+                for (size_t repeat = 0; repeat < weight; ++repeat) {
+                    itch::AddOrder add{};
+                    add.type = 'A';
+                    add.stock_locate = locate;
+                    add.order_reference = ref;
+                    add.buy_sell = round % 2 ? 'S' : 'B';
+                    add.shares = static_cast<uint32_t>(100 + round);
+                    add.price = static_cast<uint32_t>(round % 2 ? 1500100 + (round % 7) * 100
+                                                                : 1500000 - (round % 5) * 100);
+                    stream.push_back(add);
+                    
+                    if (round % 3 == 2) {
+                        itch::OrderExecuted exec{};
+                        exec.type = 'E';
+                        exec.stock_locate = locate;
+                        exec.order_reference = ref;
+                        exec.executed_shares = 10;
+                        stream.push_back(exec);
+                    }
+                    ref++;
+                }
+            }
+        }
+        return stream;
+    }
+    
+    template<typename OnDispatch>
+    static std::vector<BookUpdateEvent> run(ShardedBookEngine& engine,
+                                            const std::vector<itch::Message>& stream,
+                                            OnDispatch on_dispatch) {
+        std::vector<BookUpdateEvent> events;
+        std::atomic<bool> dispatching{true};
+        std::thread consumer([&]() {
+            BookUpdateEvent event;
+            while (dispatching) {
+                while (engine.poll(event)) {
+                    events.push_back(event);
+                }
+                std::this_thread::yield();
+            }
+            while (engine.poll(event)) {
+                events.push_back(event);
+            }
+        });
+        
+        engine.start();
+        for (size_t i = 0; i < stream.size(); ++i) {
+            engine.dispatch(stream[i]);
+            on_dispatch(i);
+        }
+        engine.stop();
+        dispatching = false;
+        consumer.join();
+        
+        return events;
+    }
+    
+    static void expect_matches(const ShardedBookEngine& engine, const std::vector<itch::Message>& stream,
+                               uint16_t locates) {
+        ItchBookBuilder reference;
+        for (const auto& msg : stream) {
+            reference.process(msg);
+        }
+        
+        for (uint16_t locate = 1; locate <= locates; ++locate) {
+            const EnhancedOrderBook* book = engine.book(locate);
+            const EnhancedOrderBook* expected = reference.book(locate);
+            ASSERT_NE(book, nullptr);
+            EXPECT_EQ(book->symbol(), expected->symbol());
+            EXPECT_EQ(book->total_orders(), expected->total_orders());
+            EXPECT_EQ(book->best_bid(), expected->best_bid());
+            EXPECT_EQ(book->best_ask_size(), expected->best_ask_size());
+        }
+    }
+    
+    static void expect_ordered(const std::vector<BookUpdateEvent>& events) {
+        for (size_t i = 1; i < events.size(); ++i) {
+            ASSERT_LT(events[i - 1].sequence, events[i].sequence);
+        }
+    }
+};
+
+TEST_F(ShardedBookEngineTest, MatchesSingleThreadedBuilder) {
+    auto stream = make_stream(6, 300);
+    
+    ShardedBookEngine::Config config;
+    config.shards = 3;
+    config.queue_capacity = 1024;
+    ShardedBookEngine engine(config);
+    
+    auto events = run(engine, stream, [](size_t) {});
+    
+    EXPECT_EQ(engine.dispatched(), stream.size());
+    
+    uint64_t messages = 0;
+    uint64_t updates = 0;
+    for (size_t shard = 0; shard < engine.shard_count(); ++shard) {
+        auto stats = engine.shard_stats(shard);
+        messages += stats.messages;
+        updates += stats.updates;
+        EXPECT_EQ(stats.dropped_updates, 0);
+        EXPECT_GE(stats.utilization, 0.0);
+        EXPECT_LE(stats.utilization, 1.0);
+    }
+    EXPECT_EQ(messages, stream.size());
+    EXPECT_EQ(updates, events.size());
+    
+    expect_ordered(events);
+    expect_matches(engine, stream, 6);
+}
+
+TEST_F(ShardedBookEngineTest, MigrationKeepsEventsAndOrder) {
+    auto stream = make_stream(4, 400);
+    
+    ShardedBookEngine::Config config;
+    config.shards = 3;
+    config.queue_capacity = 256;
+    ShardedBookEngine engine(config);
+    
+    size_t requested = 0;
+    auto events = run(engine, stream, [&](size_t i) {
+        if (i % 150 == 149) {
+            uint16_t locate = static_cast<uint16_t>(1 + (i / 150) % 4);
+            size_t target = (engine.shard_of(locate) + 1) % engine.shard_count();
+            if (engine.migrate(locate, target)) {
+                requested++;
+            }
+        }
+    });
+    
+    EXPECT_GT(requested, 0);
+    EXPECT_EQ(engine.migration_stats().migrations, requested);
+    EXPECT_FALSE(engine.migration_in_flight());
+    
+    expect_ordered(events);
+    expect_matches(engine, stream, 4);
+}
+
+TEST_F(ShardedBookEngineTest, RebalanceSpreadsHotLocates) {
+    auto stream = make_stream(4, 600, 2, 6);
+    
+    ShardedBookEngine::Config config;
+    config.shards = 2;
+    config.queue_capacity = 1024;
+    config.rebalance_interval = 500;
+    ShardedBookEngine engine(config);
+    engine.assign(1, 0);
+    engine.assign(2, 0);
+    engine.assign(3, 1);
+    engine.assign(4, 1);
+    
+    auto events = run(engine, stream, [](size_t) {});
+    
+    auto migration = engine.migration_stats();
+    EXPECT_GT(migration.rebalances, 0);
+    EXPECT_GE(migration.migrations, 1);
+    EXPECT_NE(engine.shard_of(1), engine.shard_of(2));
+    
+    expect_ordered(events);
+    expect_matches(engine, stream, 4);
+}
+
+TEST_F(ShardedBookEngineTest, EventsCarryLatestTop) {
+    ShardedBookEngine engine;
+    engine.assign(5, 1);
+    EXPECT_EQ(engine.shard_of(5), 1);
+    
+    engine.start();
+    for (const auto& msg : make_stream(1, 0)) {
+        engine.dispatch(msg);
+    }
+    
+    itch::AddOrder add{};
+    add.type = 'A';
+    add.stock_locate = 1;
+    add.order_reference = 42;
+    add.buy_sell = 'B';
+    add.shares = 300;
+    add.price = 1500000;
+    uint64_t sequence = engine.dispatch(add);
+    engine.stop();
+    
+    BookUpdateEvent event;
+    ASSERT_TRUE(engine.poll(event));
+    EXPECT_EQ(event.sequence, sequence);
+    EXPECT_EQ(event.stock_locate, 1);
+    EXPECT_EQ(event.top.bid_price, 1500000);
+    EXPECT_EQ(event.top.bid_size, 300);
+    EXPECT_TRUE(event.changes & BBO_PRICE_CHANGED);
+    EXPECT_FALSE(engine.poll(event));
+}
+
+TEST_F(ShardedBookEngineTest, RejectsReassignWhileRunning) {
+    ShardedBookEngine engine;
+    EXPECT_THROW(engine.assign(1, 7), std::invalid_argument);
+    
+    engine.start();
+    EXPECT_THROW(engine.assign(1, 0), std::runtime_error);
+    engine.stop();
+}
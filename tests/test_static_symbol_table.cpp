@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "static_symbol_table.hpp"
+#include "order_book.hpp"
+
+static constexpr auto TECH_SYMBOLS = symbol_universe(
+    "AAPL", "MSFT", "GOOGL", "GOOG", "AMZN", "META", "NVDA", "TSLA",
+    "AVGO", "ORCL", "ADBE", "CRM", "AMD", "INTC", "CSCO", "QCOM");
+
+static constexpr StaticSymbolTable<TECH_SYMBOLS.size()> TECH_TABLE(TECH_SYMBOLS);
+
+template<size_t N>
+static constexpr std::array<SymbolId, N> synthetic_universe() {
+    std::array<SymbolId, N> symbols{};
+    for (size_t i = 0; i < N; ++i) {
+        char name[5] = {'S', char('A' + (i / 676) % 26), char('A' + (i / 26) % 26),
+                        char('A' + i % 26), '\0'};
+        symbols[i] = SymbolId::from_cstr(name);
+    }
+    return symbols;
+}
+
+static constexpr StaticSymbolTable<2000> LARGE_TABLE(synthetic_universe<2000>());
+
+TEST(StaticSymbolTableTest, ResolvesAtCompileTime) {
+    static_assert(TECH_TABLE.find(SymbolId::from_cstr("AAPL")) == 0, "AAPL is first");
+    static_assert(TECH_TABLE.find(SymbolId::from_cstr("QCOM")) == 15, "QCOM is last");
+    static_assert(TECH_TABLE.find(SymbolId::from_cstr("IBM")) == PerfectHashIndex::NOT_FOUND,
+                  "IBM is not in the universe");
+    
+    for (size_t i = 0; i < TECH_SYMBOLS.size(); ++i) {
+        EXPECT_EQ(TECH_TABLE.find(TECH_SYMBOLS[i]), i);
+    }
+}
+
+TEST(StaticSymbolTableTest, LargeUniverseIsPerfect) {
+    auto symbols = synthetic_universe<2000>();
+    PerfectHashIndex index = LARGE_TABLE.index();
+    
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        EXPECT_EQ(LARGE_TABLE.find(symbols[i]), i);
+        EXPECT_EQ(index.find(symbols[i]), i);
+    }
+    EXPECT_EQ(index.find(SymbolId::from_cstr("AAPL")), PerfectHashIndex::NOT_FOUND);
+}
+
+TEST(StaticSymbolTableTest, SymbolTableFallsBackForUnknownSymbols) {
+    SymbolTable table(TECH_TABLE.index());
+    
+    EXPECT_EQ(table.size(), TECH_SYMBOLS.size());
+    EXPECT_EQ(table.find(SymbolId::from_cstr("NVDA")), 6u);
+    EXPECT_EQ(table.find(SymbolId::from_cstr("IBM")), SymbolTable::NOT_FOUND);
+    
+    uint32_t ibm = table.intern(SymbolId::from_cstr("IBM"));
+    EXPECT_EQ(ibm, TECH_SYMBOLS.size());
+    EXPECT_EQ(table.find(SymbolId::from_cstr("IBM")), ibm);
+    EXPECT_EQ(table.intern(SymbolId::from_cstr("NVDA")), 6u);
+    
+    table.clear();
+    EXPECT_EQ(table.size(), TECH_SYMBOLS.size());
+    EXPECT_EQ(table.find(SymbolId::from_cstr("IBM")), SymbolTable::NOT_FOUND);
+}
+
+TEST(StaticSymbolTableTest, OrderBookManagerPrecreatesUniverse) {
+    OrderBookManager manager(TECH_TABLE.index());
+    
+    EXPECT_EQ(manager.size(), TECH_SYMBOLS.size());
+    ASSERT_NE(manager.get(SymbolId::from_cstr("MSFT")), nullptr);
+    EXPECT_EQ(manager.get(SymbolId::from_cstr("MSFT"))->symbol(), SymbolId::from_cstr("MSFT"));
+    EXPECT_EQ(manager.get(SymbolId::from_cstr("IBM")), nullptr);
+    
+    manager.get_or_create(SymbolId::from_cstr("IBM")).add_bid(1500000, 100, 1);
+    EXPECT_EQ(manager.size(), TECH_SYMBOLS.size() + 1);
+    
+    manager.clear();
+    EXPECT_EQ(manager.size(), TECH_SYMBOLS.size());
+    EXPECT_EQ(manager.get(SymbolId::from_cstr("IBM")), nullptr);
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "symbol.hpp"
+#include "order_book.hpp"
+#include <sstream>
+
+TEST(SymbolIdTest, PackingIsPaddingAgnostic) {
+    char spaced[8] = {'A', 'A', 'P', 'L', ' ', ' ', ' ', ' '};
+    char nul_padded[8] = {'A', 'A', 'P', 'L', 0, 0, 0, 0};
+    
+    SymbolId a = SymbolId::from_chars(spaced);
+    SymbolId b = SymbolId::from_chars(nul_padded);
+    SymbolId c = SymbolId::from_string("AAPL");
+    constexpr SymbolId d = SymbolId::from_cstr("AAPL");
+    
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a, c);
+    EXPECT_EQ(a, d);
+    EXPECT_NE(a, SymbolId::from_cstr("AAPLX"));
+}
+
+TEST(SymbolIdTest, StringConversion) {
+    SymbolId symbol = SymbolId::from_cstr("GOOGL");
+    EXPECT_EQ(symbol.to_string(), "GOOGL");
+    EXPECT_EQ(symbol.length(), 5);
+    EXPECT_EQ(SymbolId::from_cstr("ABCDEFGH").to_string(), "ABCDEFGH");
+    EXPECT_TRUE(SymbolId().empty());
+    
+    std::ostringstream os;
+    os << symbol;
+    EXPECT_EQ(os.str(), "GOOGL");
+}
+
+TEST(SymbolTableTest, DenseInterning) {
+    SymbolTable table;
+    
+    EXPECT_EQ(table.intern(SymbolId::from_cstr("AAPL")), 0u);
+    EXPECT_EQ(table.intern(SymbolId::from_cstr("MSFT")), 1u);
+    EXPECT_EQ(table.intern(SymbolId::from_cstr("AAPL")), 0u);
+    
+    EXPECT_EQ(table.find(SymbolId::from_cstr("MSFT")), 1u);
+    EXPECT_EQ(table.find(SymbolId::from_cstr("TSLA")), SymbolTable::NOT_FOUND);
+    EXPECT_EQ(table.symbol(1), SymbolId::from_cstr("MSFT"));
+    EXPECT_EQ(table.size(), 2);
+}
+
+TEST(SymbolTableTest, OrderBookManagerKeysBySymbolId) {
+    OrderBookManager manager;
+    
+    OrderBook& aapl = manager.get_or_create(SymbolId::from_cstr("AAPL"));
+    aapl.add_bid(1500000, 100, 1);
+    manager.get_or_create("MSFT");
+    
+    ASSERT_NE(manager.get("AAPL"), nullptr);
+    EXPECT_EQ(manager.get(SymbolId::from_cstr("AAPL")), &aapl);
+    EXPECT_EQ(manager.get("TSLA"), nullptr);
+    EXPECT_EQ(manager.index_of(SymbolId::from_cstr("MSFT")), 1u);
+    EXPECT_EQ(manager.size(), 2);
+    EXPECT_EQ(manager.symbols()[1], "MSFT");
+}